@@ -0,0 +1,95 @@
+// Bounds.h
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCENE_BOUNDS_SSE 1
+#endif
+
+struct AABB {
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	bool valid() const { return min.x <= max.x; }
+
+	void expand(const glm::vec3& p) {
+		min = glm::min(min, p);
+		max = glm::max(max, p);
+	}
+
+	// Merging an empty box is a no-op, so unions need no special casing.
+	void merge(const AABB& o) {
+		min = glm::min(min, o.min);
+		max = glm::max(max, o.max);
+	}
+
+	bool overlaps(const AABB& o) const {
+		return min.x <= o.max.x && max.x >= o.min.x &&
+			min.y <= o.max.y && max.y >= o.min.y &&
+			min.z <= o.max.z && max.z >= o.min.z;
+	}
+
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	float radius() const { return glm::length(max - min) * 0.5f; }
+
+	// Squared gap to a point / another box; 0 when touching or overlapping.
+	float distance2(const glm::vec3& p) const {
+		glm::vec3 d = glm::max(glm::max(min - p, p - max), glm::vec3(0.0f));
+		return glm::dot(d, d);
+	}
+	float distance2(const AABB& o) const {
+		glm::vec3 d = glm::max(glm::max(min - o.max, o.min - max), glm::vec3(0.0f));
+		return glm::dot(d, d);
+	}
+};
+
+// Min/max reduction over vertex positions. `stride` is the byte distance
+// between consecutive positions (>= 3 floats). The SSE path loads a whole
+// point per instruction and ignores the 4th lane; the last point goes
+// through the scalar path so tightly packed vec3 arrays are never overread.
+static inline AABB reduceBounds(const float* first, size_t count, size_t stride) {
+	AABB b;
+	if (count == 0) return b;
+	const char* base = reinterpret_cast<const char*>(first);
+
+#ifdef SCENE_BOUNDS_SSE
+	__m128 mn0 = _mm_set1_ps(FLT_MAX), mx0 = _mm_set1_ps(-FLT_MAX);
+	__m128 mn1 = mn0, mx1 = mx0;
+	const size_t simdCount = count - 1;
+	size_t i = 0;
+	// Two independent accumulators hide the min/max latency
+	for (; i + 1 < simdCount; i += 2) {
+		__m128 p0 = _mm_loadu_ps(reinterpret_cast<const float*>(base + i * stride));
+		__m128 p1 = _mm_loadu_ps(reinterpret_cast<const float*>(base + (i + 1) * stride));
+		mn0 = _mm_min_ps(mn0, p0); mx0 = _mm_max_ps(mx0, p0);
+		mn1 = _mm_min_ps(mn1, p1); mx1 = _mm_max_ps(mx1, p1);
+	}
+	if (i < simdCount) {
+		__m128 p = _mm_loadu_ps(reinterpret_cast<const float*>(base + i * stride));
+		mn0 = _mm_min_ps(mn0, p); mx0 = _mm_max_ps(mx0, p);
+	}
+	mn0 = _mm_min_ps(mn0, mn1);
+	mx0 = _mm_max_ps(mx0, mx1);
+
+	alignas(16) float lo[4], hi[4];
+	_mm_store_ps(lo, mn0);
+	_mm_store_ps(hi, mx0);
+	b.min = glm::vec3(lo[0], lo[1], lo[2]);
+	b.max = glm::vec3(hi[0], hi[1], hi[2]);
+	const float* last = reinterpret_cast<const float*>(base + simdCount * stride);
+	b.expand(glm::vec3(last[0], last[1], last[2]));
+#else
+	for (size_t i = 0; i < count; ++i) {
+		const float* p = reinterpret_cast<const float*>(base + i * stride);
+		b.expand(glm::vec3(p[0], p[1], p[2]));
+	}
+#endif
+	return b;
+}
+
+#endif // BOUNDS_H
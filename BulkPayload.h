@@ -0,0 +1,80 @@
+// BulkPayload.h
+#ifndef BULK_PAYLOAD_H
+#define BULK_PAYLOAD_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Payloads of the bulk draw commands: either a bracketed number list
+// "[1.5, 2, -3e-2, ...]" or "b64:" followed by the base64 of the raw
+// little-endian values (float32 coordinates, uint32 indices).
+namespace bulk {
+
+static inline int base64Value(unsigned char c) {
+	if (c >= 'A' && c <= 'Z') return c - 'A';
+	if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+	if (c >= '0' && c <= '9') return c - '0' + 52;
+	if (c == '+' || c == '-') return 62;   // standard and URL-safe alphabets
+	if (c == '/' || c == '_') return 63;
+	return -1;
+}
+
+// Decodes up to the first character outside the alphabet; '=' padding is skipped.
+static inline const char* base64Decode(const char* p, const char* end, std::vector<uint8_t>& out) {
+	out.clear();
+	uint32_t acc = 0;
+	int bits = 0;
+	for (; p < end; ++p) {
+		const int v = base64Value((unsigned char)*p);
+		if (v < 0) break;
+		acc = (acc << 6) | (uint32_t)v;
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			out.push_back(uint8_t(acc >> bits));
+		}
+	}
+	while (p < end && *p == '=') ++p;
+	return p;
+}
+
+// Reads one payload starting at `p` (leading whitespace allowed) into `out`
+// and returns the position after it. Unparsable characters inside a list are skipped.
+template <class T>
+static inline const char* parseList(const char* p, const char* end, std::vector<T>& out) {
+	out.clear();
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+
+	if (end - p >= 4 && std::memcmp(p, "b64:", 4) == 0) {
+		static thread_local std::vector<uint8_t> bytes;
+		p = base64Decode(p + 4, end, bytes);
+		out.resize(bytes.size() / sizeof(T));
+		if (!out.empty()) std::memcpy(out.data(), bytes.data(), out.size() * sizeof(T));
+		return p;
+	}
+
+	if (p == end || *p != '[') return p;
+	++p;
+	while (p < end && *p != ']') {
+		if (*p == ',' || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == '+') {
+			++p;
+			continue;
+		}
+		T v;
+		auto r = std::from_chars(p, end, v);
+		if (r.ec != std::errc()) {
+			++p;
+			continue;
+		}
+		out.push_back(v);
+		p = r.ptr;
+	}
+	if (p < end) ++p; // skip ']'
+	return p;
+}
+
+} // namespace bulk
+
+#endif // BULK_PAYLOAD_H
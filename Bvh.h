@@ -0,0 +1,167 @@
+// Bvh.h
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+// Bounding volume hierarchy over triangles, median split on the widest
+// centroid axis. Triangles are copied in leaf order so a traversal touches
+// contiguous memory; id(slot) maps a slot back to the caller's index.
+class TriangleBvh {
+public:
+	struct Node {
+		AABB box;
+		uint32_t first;   // leaf: first slot; interior: left child (right child is first + 1)
+		uint32_t count;   // 0 for interior nodes
+	};
+
+	// `vertices` holds 3 consecutive positions per triangle.
+	void build(const glm::vec3* vertices, size_t triangleCount) {
+		nodes.clear();
+		tris.clear();
+		ids.clear();
+		if (triangleCount == 0) return;
+
+		std::vector<AABB> boxes(triangleCount);
+		std::vector<glm::vec3> centroids(triangleCount);
+		std::vector<uint32_t> order(triangleCount);
+		for (size_t i = 0; i < triangleCount; ++i) {
+			const glm::vec3* t = vertices + 3 * i;
+			boxes[i].expand(t[0]); boxes[i].expand(t[1]); boxes[i].expand(t[2]);
+			centroids[i] = boxes[i].center();
+			order[i] = (uint32_t)i;
+		}
+
+		nodes.reserve(2 * triangleCount / LeafSize + 1);
+		struct Task { uint32_t node, begin, end; };
+		std::vector<Task> stack;
+		nodes.push_back(Node());
+		stack.push_back({ 0, 0, (uint32_t)triangleCount });
+
+		while (!stack.empty()) {
+			Task task = stack.back();
+			stack.pop_back();
+
+			AABB box, centroidBox;
+			for (uint32_t i = task.begin; i < task.end; ++i) {
+				box.merge(boxes[order[i]]);
+				centroidBox.expand(centroids[order[i]]);
+			}
+			nodes[task.node].box = box;
+
+			const uint32_t n = task.end - task.begin;
+			glm::vec3 extent = centroidBox.max - centroidBox.min;
+			int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+			if (n <= LeafSize || extent[axis] <= 0.0f) {
+				nodes[task.node].first = task.begin;
+				nodes[task.node].count = n;
+				continue;
+			}
+
+			const uint32_t mid = task.begin + n / 2;
+			std::nth_element(order.begin() + task.begin, order.begin() + mid, order.begin() + task.end,
+				[&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+			// Children are allocated as a pair
+			const uint32_t left = (uint32_t)nodes.size();
+			nodes.push_back(Node());
+			nodes.push_back(Node());
+			nodes[task.node].first = left;
+			nodes[task.node].count = 0;
+			stack.push_back({ left + 1, mid, task.end });
+			stack.push_back({ left, task.begin, mid });
+		}
+
+		tris.resize(3 * triangleCount);
+		ids.resize(triangleCount);
+		for (size_t slot = 0; slot < triangleCount; ++slot) {
+			const glm::vec3* t = vertices + 3 * order[slot];
+			tris[3 * slot] = t[0];
+			tris[3 * slot + 1] = t[1];
+			tris[3 * slot + 2] = t[2];
+			ids[slot] = order[slot];
+		}
+	}
+
+	bool empty() const { return nodes.empty(); }
+	size_t size() const { return ids.size(); }
+	const glm::vec3* triangle(uint32_t slot) const { return &tris[3 * slot]; }
+	uint32_t id(uint32_t slot) const { return ids[slot]; }
+	AABB bounds() const { return nodes.empty() ? AABB() : nodes[0].box; }
+
+	// Calls fn(slot) for every triangle whose box overlaps `box`.
+	template <class Fn>
+	void overlapping(const AABB& box, Fn&& fn) const {
+		if (nodes.empty()) return;
+		uint32_t stack[64];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0) {
+			const Node& node = nodes[stack[--top]];
+			if (!node.box.overlaps(box)) continue;
+			if (node.count > 0) {
+				for (uint32_t s = node.first; s < node.first + node.count; ++s) {
+					const glm::vec3* t = triangle(s);
+					AABB tb;
+					tb.expand(t[0]); tb.expand(t[1]); tb.expand(t[2]);
+					if (tb.overlaps(box)) fn(s);
+				}
+			}
+			else {
+				stack[top++] = node.first + 1;
+				stack[top++] = node.first;
+			}
+		}
+	}
+
+	// Branch-and-bound nearest search. lowerBound(box) must never exceed the
+	// squared distance to anything inside `box`; exact(slot) returns the squared
+	// distance to one triangle. Only hits closer than bestDist2 are accepted;
+	// returns the winning slot or UINT32_MAX.
+	template <class LowerBound, class Exact>
+	uint32_t nearest(LowerBound&& lowerBound, Exact&& exact, float& bestDist2) const {
+		uint32_t best = UINT32_MAX;
+		if (nodes.empty()) return best;
+
+		struct Item { uint32_t node; float bound; };
+		Item stack[128];
+		int top = 0;
+		stack[top++] = { 0, lowerBound(nodes[0].box) };
+		while (top > 0) {
+			const Item item = stack[--top];
+			if (item.bound >= bestDist2) continue;
+			const Node& node = nodes[item.node];
+			if (node.count > 0) {
+				for (uint32_t s = node.first; s < node.first + node.count; ++s) {
+					float d2 = exact(s);
+					if (d2 < bestDist2) {
+						bestDist2 = d2;
+						best = s;
+					}
+				}
+				continue;
+			}
+			// Visit the closer child first (pushed last)
+			Item l = { node.first, lowerBound(nodes[node.first].box) };
+			Item r = { node.first + 1, lowerBound(nodes[node.first + 1].box) };
+			if (l.bound < r.bound) std::swap(l, r);
+			if (l.bound < bestDist2) stack[top++] = l;
+			if (r.bound < bestDist2) stack[top++] = r;
+		}
+		return best;
+	}
+
+private:
+	static constexpr uint32_t LeafSize = 4;
+
+	std::vector<Node> nodes;
+	std::vector<glm::vec3> tris;
+	std::vector<uint32_t> ids;
+};
+
+#endif // BVH_H
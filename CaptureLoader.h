@@ -0,0 +1,266 @@
+// CaptureLoader.h
+#ifndef CAPTURE_LOADER_H
+#define CAPTURE_LOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(SCENE_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(SCENE_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+enum class CaptureCompression { None, Gzip, Zstd };
+
+static inline const char* compressionName(CaptureCompression c) {
+	switch (c) {
+	case CaptureCompression::Gzip: return "gzip";
+	case CaptureCompression::Zstd: return "zstd";
+	default: return "plain";
+	}
+}
+
+// Detected from the magic bytes, not the file name.
+static inline CaptureCompression detectCompression(const uint8_t* head, size_t n) {
+	if (n >= 2 && head[0] == 0x1f && head[1] == 0x8b) return CaptureCompression::Gzip;
+	if (n >= 4 && head[0] == 0x28 && head[1] == 0xb5 && head[2] == 0x2f && head[3] == 0xfd) return CaptureCompression::Zstd;
+	return CaptureCompression::None;
+}
+
+// Fixed-capacity FIFO between one producer and one consumer thread.
+template <class T>
+class BoundedQueue {
+public:
+	explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+	// Blocks while full; false once the queue was closed.
+	bool push(T value) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+		if (closed) return false;
+		items.push_back(std::move(value));
+		notEmpty.notify_one();
+		return true;
+	}
+
+	// Blocks while empty; false once closed and drained.
+	bool pop(T& out) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+		if (items.empty()) return false;
+		out = std::move(items.front());
+		items.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+	void close() {
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		notFull.notify_all();
+		notEmpty.notify_all();
+	}
+
+private:
+	const size_t capacity;
+	std::mutex mutex;
+	std::condition_variable notFull, notEmpty;
+	std::deque<T> items;
+	bool closed = false;
+};
+
+// A capture log decoded on a worker thread while the caller parses earlier
+// chunks. Plain, gzip (also concatenated members) and, when built with
+// zstd, zstd files are accepted. At most `depth` chunks are in flight, so
+// memory stays bounded whatever the file size.
+class CaptureStream {
+public:
+	static constexpr size_t kChunkSize = size_t(4) << 20;
+
+	explicit CaptureStream(size_t depth = 4) : queue(depth) {}
+	~CaptureStream() { close(); }
+
+	bool open(const std::string& path, std::string& error) {
+		file = std::fopen(path.c_str(), "rb");
+		if (!file) {
+			error = "cannot open " + path;
+			return false;
+		}
+		uint8_t head[4] = {};
+		const size_t n = std::fread(head, 1, sizeof(head), file);
+		std::rewind(file);
+		kind = detectCompression(head, n);
+#if !defined(SCENE_HAVE_ZLIB)
+		if (kind == CaptureCompression::Gzip) {
+			error = "gzip input needs a build with zlib";
+			close();
+			return false;
+		}
+#endif
+#if !defined(SCENE_HAVE_ZSTD)
+		if (kind == CaptureCompression::Zstd) {
+			error = "zstd input needs a build with zstd";
+			close();
+			return false;
+		}
+#endif
+		worker = std::thread([this] { run(); });
+		return true;
+	}
+
+	// Next decoded chunk; false at the end of the stream (see error()).
+	bool next(std::string& chunk) { return queue.pop(chunk); }
+
+	// Stops the decoder early; safe to call twice.
+	void close() {
+		queue.close();
+		if (worker.joinable()) worker.join();
+		if (file) {
+			std::fclose(file);
+			file = nullptr;
+		}
+	}
+
+	// Valid once next() returned false.
+	const std::string& error() const { return failure; }
+	CaptureCompression compression() const { return kind; }
+	uint64_t fileBytes() const { return readBytes.load(); }
+	uint64_t decodedBytes() const { return producedBytes.load(); }
+
+private:
+	void run() {
+		switch (kind) {
+		case CaptureCompression::Gzip: runGzip(); break;
+		case CaptureCompression::Zstd: runZstd(); break;
+		default: runPlain(); break;
+		}
+		queue.close();
+	}
+
+	size_t readInput(std::vector<uint8_t>& in) {
+		const size_t n = std::fread(in.data(), 1, in.size(), file);
+		readBytes += n;
+		if (n == 0 && std::ferror(file)) failure = "read error";
+		return n;
+	}
+
+	// False when the consumer closed the stream.
+	bool emit(std::string& out) {
+		producedBytes += out.size();
+		std::string chunk;
+		chunk.swap(out);
+		out.reserve(kChunkSize);
+		return queue.push(std::move(chunk));
+	}
+
+	void runPlain() {
+		std::vector<uint8_t> in(kChunkSize);
+		std::string out;
+		while (size_t n = readInput(in)) {
+			out.assign(reinterpret_cast<const char*>(in.data()), n);
+			if (!emit(out)) return;
+		}
+	}
+
+	void runGzip() {
+#if defined(SCENE_HAVE_ZLIB)
+		z_stream zs{};
+		if (inflateInit2(&zs, 15 + 32) != Z_OK) {   // +32: accept gzip and zlib headers
+			failure = "inflateInit failed";
+			return;
+		}
+		std::vector<uint8_t> in(size_t(1) << 20);
+		std::string out(kChunkSize, '\0');
+		size_t used = 0;
+		bool ok = true;
+		bool ended = false;   // the last member is complete
+		while (ok) {
+			zs.avail_in = (uInt)readInput(in);
+			zs.next_in = in.data();
+			if (zs.avail_in == 0) break;
+			// A full `out` may leave output pending inside inflate, so drain it even without input
+			while (zs.avail_in > 0 || zs.avail_out == 0) {
+				zs.next_out = reinterpret_cast<Bytef*>(&out[used]);
+				zs.avail_out = (uInt)(out.size() - used);
+				const int r = inflate(&zs, Z_NO_FLUSH);
+				used = out.size() - zs.avail_out;
+				if (r != Z_BUF_ERROR) ended = r == Z_STREAM_END;   // Z_BUF_ERROR: no progress, state unchanged
+				if (r == Z_STREAM_END) {
+					inflateReset(&zs);   // next gzip member, if any
+				}
+				else if (r != Z_OK && r != Z_BUF_ERROR) {
+					failure = std::string("corrupt gzip data: ") + (zs.msg ? zs.msg : "inflate error");
+					ok = false;
+					break;
+				}
+				if (used == out.size()) {
+					out.resize(used);
+					if (!emit(out)) { ok = false; break; }
+					out.assign(kChunkSize, '\0');
+					used = 0;
+				}
+			}
+		}
+		inflateEnd(&zs);
+		if (ok && !ended && failure.empty()) failure = "truncated gzip data";   // frames decoded so far are kept
+		out.resize(used);
+		if (ok && !out.empty()) emit(out);
+#endif
+	}
+
+	void runZstd() {
+#if defined(SCENE_HAVE_ZSTD)
+		ZSTD_DStream* ds = ZSTD_createDStream();
+		ZSTD_initDStream(ds);
+		std::vector<uint8_t> in(ZSTD_DStreamInSize());
+		std::string out(kChunkSize, '\0');
+		size_t used = 0;
+		bool ok = true;
+		size_t hint = 1;   // last ZSTD_decompressStream result; 0 once a frame is complete
+		while (ok) {
+			ZSTD_inBuffer input = { in.data(), readInput(in), 0 };
+			if (input.size == 0) break;
+			// A full `out` may leave output pending inside the decoder, so drain it even without input
+			bool full = false;
+			while (input.pos < input.size || full) {
+				ZSTD_outBuffer output = { &out[0], out.size(), used };
+				hint = ZSTD_decompressStream(ds, &output, &input);
+				used = output.pos;
+				if (ZSTD_isError(hint)) {
+					failure = std::string("corrupt zstd data: ") + ZSTD_getErrorName(hint);
+					ok = false;
+					break;
+				}
+				full = used == out.size();
+				if (full) {
+					if (!emit(out)) { ok = false; break; }
+					out.assign(kChunkSize, '\0');
+					used = 0;
+				}
+			}
+		}
+		ZSTD_freeDStream(ds);
+		if (ok && hint != 0 && failure.empty()) failure = "truncated zstd data";   // frames decoded so far are kept
+		out.resize(used);
+		if (ok && !out.empty()) emit(out);
+#endif
+	}
+
+	BoundedQueue<std::string> queue;
+	std::FILE* file = nullptr;
+	CaptureCompression kind = CaptureCompression::None;
+	std::thread worker;
+	std::string failure;
+	std::atomic<uint64_t> readBytes{ 0 }, producedBytes{ 0 };
+};
+
+#endif // CAPTURE_LOADER_H
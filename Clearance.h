@@ -0,0 +1,154 @@
+// Clearance.h
+#ifndef CLEARANCE_H
+#define CLEARANCE_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Scene.h"
+#include "Bvh.h"
+#include "Geometry.h"
+#include "ThreadPool.h"
+
+struct ClearanceResult {
+	bool valid = false;
+	float distance = 0.0f;
+	glm::vec3 onPrimitive = glm::vec3(0.0f);
+	glm::vec3 onMesh = glm::vec3(0.0f);
+	uint32_t meshTriangle = 0;   // overlay triangle index, as numbered by buildMeshBvh()
+};
+
+struct ClearanceReport {
+	size_t frame = 0;
+	std::vector<float> distance;   // per primitive; FLT_MAX when it has no geometry
+	float minDistance = FLT_MAX;
+	float maxDistance = 0.0f;      // largest finite clearance
+	int closest = -1;
+	double seconds = 0.0;
+};
+
+namespace clearance_detail {
+
+// Keeps the best of several feature queries against the same mesh.
+struct Search {
+	const TriangleBvh& mesh;
+	float best2 = FLT_MAX;
+	ClearanceResult result;
+
+	explicit Search(const TriangleBvh& mesh) : mesh(mesh) {}
+
+	void point(const glm::vec3& p) {
+		glm::vec3 onMesh;
+		uint32_t slot = mesh.nearest(
+			[&](const AABB& box) { return box.distance2(p); },
+			[&](uint32_t s) {
+				const glm::vec3* t = mesh.triangle(s);
+				glm::vec3 c = geom::closestPointOnTriangle(p, t[0], t[1], t[2]);
+				float d2 = glm::dot(c - p, c - p);
+				if (d2 < best2) onMesh = c;
+				return d2;
+			}, best2);
+		if (slot != UINT32_MAX) accept(slot, p, onMesh);
+	}
+
+	void segment(const glm::vec3& a, const glm::vec3& b) {
+		AABB box;
+		box.expand(a); box.expand(b);
+		glm::vec3 onQuery, onMesh;
+		uint32_t slot = mesh.nearest(
+			[&](const AABB& node) { return node.distance2(box); },
+			[&](uint32_t s) {
+				glm::vec3 q, m;
+				float d2 = geom::closestPointsSegmentTriangle(a, b, mesh.triangle(s), q, m);
+				if (d2 < best2) { onQuery = q; onMesh = m; }
+				return d2;
+			}, best2);
+		if (slot != UINT32_MAX) accept(slot, onQuery, onMesh);
+	}
+
+	void triangle(const glm::vec3* tri) {
+		AABB box;
+		box.expand(tri[0]); box.expand(tri[1]); box.expand(tri[2]);
+		glm::vec3 onQuery, onMesh;
+		uint32_t slot = mesh.nearest(
+			[&](const AABB& node) { return node.distance2(box); },
+			[&](uint32_t s) {
+				glm::vec3 q, m;
+				float d2 = geom::closestPointsTriangleTriangle(tri, mesh.triangle(s), q, m);
+				if (d2 < best2) { onQuery = q; onMesh = m; }
+				return d2;
+			}, best2);
+		if (slot != UINT32_MAX) accept(slot, onQuery, onMesh);
+	}
+
+	void accept(uint32_t slot, const glm::vec3& onQuery, const glm::vec3& onMesh) {
+		result.valid = true;
+		result.distance = std::sqrt(best2);
+		result.onPrimitive = onQuery;
+		result.onMesh = onMesh;
+		result.meshTriangle = mesh.id(slot);
+	}
+};
+
+} // namespace clearance_detail
+
+// Closest points between primitive i of `frame` and the mesh. Points are
+// queried as points, lines and box edges as segments, triangles as triangles.
+static inline ClearanceResult primitiveClearance(const Frame& frame, size_t i, const TriangleBvh& mesh) {
+	clearance_detail::Search search(mesh);
+	if (mesh.empty()) return search.result;
+
+	const glm::vec3* p = frame.positions(i);
+	switch (frame.type(i)) {
+	case PrimType::Triangle:
+		search.triangle(p);
+		break;
+	case PrimType::Line:
+		search.segment(p[0], p[1]);
+		break;
+	case PrimType::Point:
+		search.point(p[0]);
+		break;
+	case PrimType::Box: {
+		glm::vec3 edges[24];
+		boxEdges(p[0], p[1], edges);
+		for (int k = 0; k < 24; k += 2) search.segment(edges[k], edges[k + 1]);
+		break;
+	}
+	default:
+		break;
+	}
+	return search.result;
+}
+
+// Clearance of every primitive of `frame`, split over `pool`.
+static inline ClearanceReport frameClearance(const Frame& frame, const TriangleBvh& mesh, ThreadPool& pool) {
+	auto t0 = std::chrono::steady_clock::now();
+	ClearanceReport report;
+	report.distance.assign(frame.size(), FLT_MAX);
+
+	pool.parallelFor(frame.size(), 256, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			ClearanceResult r = primitiveClearance(frame, i, mesh);
+			if (r.valid) report.distance[i] = r.distance;
+		}
+	});
+
+	for (size_t i = 0; i < report.distance.size(); ++i) {
+		const float d = report.distance[i];
+		if (d == FLT_MAX) continue;
+		if (d < report.minDistance) {
+			report.minDistance = d;
+			report.closest = (int)i;
+		}
+		report.maxDistance = std::max(report.maxDistance, d);
+	}
+	report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	return report;
+}
+
+#endif // CLEARANCE_H
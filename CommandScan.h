@@ -0,0 +1,60 @@
+// CommandScan.h
+#ifndef COMMAND_SCAN_H
+#define COMMAND_SCAN_H
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCENE_SCAN_SSE2 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// Skips log noise between input commands. Every command keyword starts
+// with "dr" (draw*), "fr" (framestart/frameend), "pe" (persist) or "re"
+// (remove), so only positions holding one of those pairs need the full
+// keyword compare; 16 positions are tested per step with SSE2.
+namespace cmdscan {
+
+static inline bool isCandidate(const char* p) {
+	const char a = p[0], b = p[1];
+	return ((a == 'd' || a == 'f') && b == 'r') || ((a == 'p' || a == 'r') && b == 'e');
+}
+
+#if defined(SCENE_SCAN_SSE2)
+static inline int lowestBit(uint32_t mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// First candidate keyword start in [p, end), or end.
+static inline const char* nextCandidate(const char* p, const char* end) {
+#if defined(SCENE_SCAN_SSE2)
+	const __m128i d = _mm_set1_epi8('d'), f = _mm_set1_epi8('f'), pc = _mm_set1_epi8('p');
+	const __m128i r = _mm_set1_epi8('r'), e = _mm_set1_epi8('e');
+	while (end - p >= 17) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+		const __m128i toR = _mm_and_si128(_mm_or_si128(_mm_cmpeq_epi8(a, d), _mm_cmpeq_epi8(a, f)), _mm_cmpeq_epi8(b, r));
+		const __m128i toE = _mm_and_si128(_mm_or_si128(_mm_cmpeq_epi8(a, pc), _mm_cmpeq_epi8(a, r)), _mm_cmpeq_epi8(b, e));
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(toR, toE));
+		if (mask) return p + lowestBit(mask);
+		p += 16;
+	}
+#endif
+	for (; end - p >= 2; ++p)
+		if (isCandidate(p)) return p;
+	return end;   // a single trailing byte cannot start a keyword
+}
+
+} // namespace cmdscan
+
+#endif // COMMAND_SCAN_H
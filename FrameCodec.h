@@ -0,0 +1,242 @@
+// FrameCodec.h
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Scene.h"
+
+#if defined(SCENE_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+// Compact serialized form of a Frame:
+//  - positions keep their float bits (kLosslessBits, the default) or are
+//    quantized to `positionBits` per axis over the frame AABB,
+//  - per type, positions, name ids and colors are delta coded as zigzag varints,
+//  - the primitive order is stored as 2-bit types (slots follow from it),
+//  - the stream is then deflated at the fastest level when zlib is available.
+// Quantization is the only loss: an error of at most half a step, extent / 2^bits.
+namespace framecodec {
+
+static constexpr int kLosslessBits = 32; // positions stored exactly
+
+enum Codec : uint8_t { Raw = 0, Deflate = 1 };
+
+static constexpr uint32_t kMagic = 0x31464453; // "SDF1"
+static constexpr size_t kHeaderSize = 4 + 1 + 4;
+
+static inline void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+	while (v >= 0x80) {
+		out.push_back(uint8_t(v) | 0x80);
+		v >>= 7;
+	}
+	out.push_back(uint8_t(v));
+}
+
+// Returns 0 past the end; callers check `p <= end` once per section.
+static inline uint64_t getVarint(const uint8_t*& p, const uint8_t* end) {
+	uint64_t v = 0;
+	for (int shift = 0; p < end && shift < 64; shift += 7) {
+		const uint8_t b = *p++;
+		v |= uint64_t(b & 0x7f) << shift;
+		if (!(b & 0x80)) break;
+	}
+	return v;
+}
+
+static inline uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+static inline int64_t unzigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+static inline void putU32(std::vector<uint8_t>& out, uint32_t v) {
+	for (int k = 0; k < 4; ++k) out.push_back(uint8_t(v >> (8 * k)));
+}
+
+static inline uint32_t getU32(const uint8_t* p) {
+	return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static inline void putFloat(std::vector<uint8_t>& out, float f) {
+	uint32_t v;
+	std::memcpy(&v, &f, 4);
+	putU32(out, v);
+}
+
+static inline float getFloat(const uint8_t*& p, const uint8_t* end) {
+	if (end - p < 4) { p = end + 1; return 0.0f; }
+	uint32_t v = getU32(p);
+	p += 4;
+	float f;
+	std::memcpy(&f, &v, 4);
+	return f;
+}
+
+// Step per axis; zero on flat axes and for empty frames.
+static inline glm::vec3 quantumOf(const AABB& b, int bits) {
+	if (!b.valid()) return glm::vec3(0.0f);
+	const float levels = float((1ull << bits) - 1);
+	return (b.max - b.min) / levels;
+}
+
+// Appends the uncompressed varint stream.
+static inline void encodeStream(const Frame& frame, int bits, std::vector<uint8_t>& out) {
+	putVarint(out, (uint64_t)bits);
+	putVarint(out, frame.size());
+	for (int t = 0; t < (int)PrimType::Count; ++t) putVarint(out, frame.byType[t].size());
+	putFloat(out, frame.bounds.min.x); putFloat(out, frame.bounds.min.y); putFloat(out, frame.bounds.min.z);
+	putFloat(out, frame.bounds.max.x); putFloat(out, frame.bounds.max.y); putFloat(out, frame.bounds.max.z);
+
+	// Primitive order, four types per byte
+	for (size_t i = 0; i < frame.size(); i += 4) {
+		uint8_t packed = 0;
+		for (size_t k = 0; k < 4 && i + k < frame.size(); ++k) packed |= uint8_t(frame.refs[i + k] & 3) << (2 * k);
+		out.push_back(packed);
+	}
+
+	const bool lossless = bits >= kLosslessBits;
+	const glm::vec3 step = lossless ? glm::vec3(0.0f) : quantumOf(frame.bounds, bits);
+	const int64_t maxLevel = int64_t((1ull << bits) - 1);
+	auto quantize = [&](float v, float lo, float s) -> int64_t {
+		if (lossless) {
+			uint32_t u;
+			std::memcpy(&u, &v, 4);
+			return u;
+		}
+		if (!(s > 0.0f)) return 0;
+		const int64_t q = (int64_t)std::llround((v - lo) / s);
+		return q < 0 ? 0 : (q > maxLevel ? maxLevel : q);
+	};
+
+	for (const auto& a : frame.byType) {
+		int64_t prevName = 0;
+		for (uint32_t id : a.nameIds) {
+			putVarint(out, zigzag((int64_t)id - prevName));
+			prevName = id;
+		}
+		uint32_t prevColor = 0;
+		for (uint32_t c : a.colors) {
+			putVarint(out, c ^ prevColor);
+			prevColor = c;
+		}
+		int64_t prev[3] = { 0, 0, 0 };
+		for (const glm::vec3& p : a.positions) {
+			const int64_t q[3] = {
+				quantize(p.x, frame.bounds.min.x, step.x),
+				quantize(p.y, frame.bounds.min.y, step.y),
+				quantize(p.z, frame.bounds.min.z, step.z),
+			};
+			for (int k = 0; k < 3; ++k) {
+				putVarint(out, zigzag(q[k] - prev[k]));
+				prev[k] = q[k];
+			}
+		}
+	}
+}
+
+static inline bool decodeStream(const uint8_t* p, const uint8_t* end, Frame& frame) {
+	frame.clear();
+	const int bits = (int)getVarint(p, end);
+	const size_t count = (size_t)getVarint(p, end);
+	size_t typeCount[(int)PrimType::Count];
+	for (auto& n : typeCount) n = (size_t)getVarint(p, end);
+	frame.bounds.min.x = getFloat(p, end); frame.bounds.min.y = getFloat(p, end); frame.bounds.min.z = getFloat(p, end);
+	frame.bounds.max.x = getFloat(p, end); frame.bounds.max.y = getFloat(p, end); frame.bounds.max.z = getFloat(p, end);
+	if (p > end || bits < 1 || bits > kLosslessBits || (size_t)(end - p) < (count + 3) / 4) return false;
+
+	frame.refs.resize(count);
+	uint32_t nextSlot[(int)PrimType::Count] = {};
+	for (size_t i = 0; i < count; ++i) {
+		const uint32_t t = (p[i / 4] >> (2 * (i % 4))) & 3;
+		frame.refs[i] = (nextSlot[t]++ << 2) | t;
+	}
+	p += (count + 3) / 4;
+
+	const bool lossless = bits >= kLosslessBits;
+	const glm::vec3 step = lossless ? glm::vec3(0.0f) : quantumOf(frame.bounds, bits);
+	for (int t = 0; t < (int)PrimType::Count; ++t) {
+		if (nextSlot[t] != typeCount[t]) return false;
+		auto& a = frame.byType[t];
+		const size_t n = typeCount[t];
+		a.nameIds.resize(n);
+		a.colors.resize(n);
+		a.primitives.resize(n);
+		a.positions.resize(n * kPrimVertexCount[t]);
+
+		int64_t prevName = 0;
+		for (auto& id : a.nameIds) id = uint32_t(prevName += unzigzag(getVarint(p, end)));
+		uint32_t prevColor = 0;
+		for (auto& c : a.colors) c = prevColor ^= (uint32_t)getVarint(p, end);
+		int64_t q[3] = { 0, 0, 0 };
+		for (glm::vec3& v : a.positions) {
+			for (int k = 0; k < 3; ++k) q[k] += unzigzag(getVarint(p, end));
+			if (lossless) {
+				for (int k = 0; k < 3; ++k) {
+					const uint32_t u = (uint32_t)q[k];
+					std::memcpy(&v[k], &u, 4);
+				}
+			}
+			else {
+				v = frame.bounds.min + glm::vec3((float)q[0], (float)q[1], (float)q[2]) * step;
+			}
+		}
+		if (p > end) return false;
+	}
+	for (uint32_t i = 0; i < count; ++i) frame.byType[frame.refs[i] & 3].primitives[frame.refs[i] >> 2] = i;
+	return true;
+}
+
+// Serializes `frame` into `out` (replacing its contents). `scratch` is reused between calls.
+static inline void encode(const Frame& frame, int positionBits, std::vector<uint8_t>& out, std::vector<uint8_t>& scratch) {
+	scratch.clear();
+	encodeStream(frame, positionBits, scratch);
+
+	out.clear();
+	putU32(out, kMagic);
+#if defined(SCENE_HAVE_ZLIB)
+	uLongf packedSize = compressBound((uLong)scratch.size());
+	out.resize(kHeaderSize + packedSize);
+	if (compress2(out.data() + kHeaderSize, &packedSize, scratch.data(), (uLong)scratch.size(), Z_BEST_SPEED) == Z_OK &&
+		packedSize < scratch.size()) {
+		out[4] = Deflate;
+		const uint32_t rawSize = (uint32_t)scratch.size();
+		for (int k = 0; k < 4; ++k) out[5 + k] = uint8_t(rawSize >> (8 * k));
+		out.resize(kHeaderSize + packedSize);
+		return;
+	}
+	out.resize(4);
+#endif
+	out.push_back(Raw);
+	putU32(out, (uint32_t)scratch.size());
+	out.insert(out.end(), scratch.begin(), scratch.end());
+}
+
+// False on a corrupt blob or one using a codec this build lacks.
+static inline bool decode(const uint8_t* data, size_t size, Frame& frame, std::vector<uint8_t>& scratch) {
+	if (size < kHeaderSize || getU32(data) != kMagic) return false;
+	const uint8_t codec = data[4];
+	const uint32_t rawSize = getU32(data + 5);
+	const uint8_t* body = data + kHeaderSize;
+	const size_t bodySize = size - kHeaderSize;
+
+	if (codec == Raw) {
+		if (bodySize != rawSize) return false;
+		return decodeStream(body, body + bodySize, frame);
+	}
+#if defined(SCENE_HAVE_ZLIB)
+	if (codec == Deflate) {
+		scratch.resize(rawSize);
+		uLongf outSize = rawSize;
+		if (uncompress(scratch.data(), &outSize, body, (uLong)bodySize) != Z_OK || outSize != rawSize) return false;
+		return decodeStream(scratch.data(), scratch.data() + rawSize, frame);
+	}
+#endif
+	(void)scratch;
+	return false;
+}
+
+} // namespace framecodec
+
+#endif // FRAME_CODEC_H
@@ -0,0 +1,203 @@
+// FrameDiff.h
+#ifndef FRAME_DIFF_H
+#define FRAME_DIFF_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Scene.h"
+#include "FrameStore.h"
+#include "ThreadPool.h"
+
+enum class DiffState : uint8_t { Unchanged, Moved, Added, Removed, Count };
+
+struct FrameDiffResult {
+	std::vector<DiffState> state;   // per primitive of the newer frame
+	std::vector<uint32_t> removed;  // primitives of the older frame without a counterpart
+	size_t counts[(int)DiffState::Count] = {};
+};
+
+static inline uint64_t mix64(uint64_t x) {
+	// splitmix64 finalizer
+	x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+	x ^= x >> 27; x *= 0x94d049bb133111ebull;
+	x ^= x >> 31;
+	return x;
+}
+
+// Name + type: which primitive this is. Interned ids make this collision free.
+static inline uint64_t primitiveIdentityHash(const Frame& frame, size_t i) {
+	return ((uint64_t)frame.nameId(i) << 8) | (uint64_t)frame.type(i);
+}
+
+// Positions snapped to a `quantum` grid: where it is.
+static inline uint64_t primitiveContentHash(const Frame& frame, size_t i, float quantum) {
+	const double inv = 1.0 / quantum;
+	const glm::vec3* p = frame.positions(i);
+	uint64_t h = mix64(frame.vertexCount(i));
+	for (uint32_t k = 0; k < frame.vertexCount(i); ++k)
+		for (int axis = 0; axis < 3; ++axis)
+			h = mix64(h ^ (uint64_t)std::llround(p[k][axis] * inv));
+	return h;
+}
+
+// Matches primitives by identity (name, type and rank among same-named
+// primitives) and compares quantized vertices of each matched pair.
+static inline FrameDiffResult diffFrames(const Frame* older, const Frame& newer, float quantum) {
+	struct Entry {
+		uint64_t id;
+		uint32_t index;
+		bool operator<(const Entry& o) const { return id != o.id ? id < o.id : index < o.index; }
+	};
+	auto entries = [](const Frame& frame) {
+		std::vector<Entry> out(frame.size());
+		for (size_t i = 0; i < out.size(); ++i)
+			out[i] = { primitiveIdentityHash(frame, i), (uint32_t)i };
+		std::sort(out.begin(), out.end());
+		return out;
+	};
+
+	FrameDiffResult r;
+	r.state.assign(newer.size(), DiffState::Added);
+	std::vector<Entry> b = entries(newer);
+	std::vector<Entry> a = older ? entries(*older) : std::vector<Entry>();
+
+	size_t i = 0, j = 0;
+	while (i < a.size() || j < b.size()) {
+		if (j == b.size() || (i < a.size() && a[i].id < b[j].id)) {
+			r.removed.push_back(a[i++].index);
+		}
+		else if (i == a.size() || b[j].id < a[i].id) {
+			++j; // stays Added
+		}
+		else {
+			// Same identity: entries are sorted by index inside the run, so ranks line up
+			r.state[b[j].index] = primitiveContentHash(*older, a[i].index, quantum) == primitiveContentHash(newer, b[j].index, quantum)
+				? DiffState::Unchanged : DiffState::Moved;
+			++i; ++j;
+		}
+	}
+
+	std::sort(r.removed.begin(), r.removed.end());
+	for (DiffState s : r.state) ++r.counts[(int)s];
+	r.counts[(int)DiffState::Removed] = r.removed.size();
+	return r;
+}
+
+// Diffs of frame f against f-1, computed on the shared pool and kept in a
+// small LRU. Jobs for frames the user has scrubbed away from are dropped
+// before they start, so the queue never lags behind the slider.
+// The frames passed to get() must not change until reset() returns.
+class FrameDiffCache {
+public:
+	explicit FrameDiffCache(ThreadPool& pool, size_t capacity = 64, int prefetchRadius = 2)
+		: pool(pool), capacity(capacity), prefetchRadius(prefetchRadius) {
+	}
+
+	~FrameDiffCache() { reset(); }
+
+	// nullptr while the diff is still being computed. Also queues the neighbours.
+	std::shared_ptr<const FrameDiffResult> get(const FrameStore& frames, size_t f, float quantum) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (quantum != cachedQuantum) {
+			++generation;
+			cache.clear();
+			cachedQuantum = quantum;
+		}
+		wanted.store(f);
+
+		std::shared_ptr<const FrameDiffResult> result;
+		for (int d = 0; d <= 2 * prefetchRadius; ++d) {
+			// 0, +1, -1, +2, -2, ...
+			const long long g = (long long)f + ((d & 1) ? (d + 1) / 2 : -(d / 2));
+			if (g < 0 || g >= (long long)frames.size()) continue;
+			auto it = cache.find((size_t)g);
+			if (it == cache.end()) {
+				cache[(size_t)g] = Entry{ nullptr, ++clock };
+				++inFlight;
+				enqueue(frames, (size_t)g, quantum, generation);
+			}
+			else if (d == 0) {
+				it->second.lastUse = ++clock;
+				result = it->second.result;
+			}
+		}
+		return result;
+	}
+
+	// Drops everything and waits for running jobs.
+	void reset() {
+		std::unique_lock<std::mutex> lock(mutex);
+		++generation;
+		cache.clear();
+		idle.wait(lock, [this] { return inFlight == 0; });
+	}
+
+private:
+	struct Entry {
+		std::shared_ptr<const FrameDiffResult> result; // null while pending
+		uint64_t lastUse;
+	};
+
+	void enqueue(const FrameStore& frames, size_t f, float quantum, uint64_t gen) {
+		pool.submit([this, &frames, f, quantum, gen] {
+			std::shared_ptr<const FrameDiffResult> r;
+			const size_t w = wanted.load();
+			const bool stale = gen != currentGeneration() ||
+				(f + prefetchRadius < w || f > w + prefetchRadius);
+			if (!stale) {
+				const auto previous = f > 0 ? frames[f - 1] : nullptr;
+				r = std::make_shared<FrameDiffResult>(diffFrames(previous.get(), *frames[f], quantum));
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (gen == generation) {
+				if (r) {
+					cache[f].result = std::move(r);
+					evict();
+				}
+				else {
+					cache.erase(f); // let a later get() queue it again
+				}
+			}
+			if (--inFlight == 0) idle.notify_all();
+		});
+	}
+
+	uint64_t currentGeneration() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return generation;
+	}
+
+	void evict() {
+		while (cache.size() > capacity) {
+			auto victim = cache.end();
+			for (auto it = cache.begin(); it != cache.end(); ++it)
+				if (it->second.result && (victim == cache.end() || it->second.lastUse < victim->second.lastUse))
+					victim = it;
+			if (victim == cache.end()) return;
+			cache.erase(victim);
+		}
+	}
+
+	ThreadPool& pool;
+	const size_t capacity;
+	const int prefetchRadius;
+
+	std::mutex mutex;
+	std::condition_variable idle;
+	std::unordered_map<size_t, Entry> cache;
+	std::atomic<size_t> wanted{ 0 };
+	size_t inFlight = 0;
+	uint64_t generation = 0;
+	uint64_t clock = 0;
+	float cachedQuantum = 0.0f;
+};
+
+#endif // FRAME_DIFF_H
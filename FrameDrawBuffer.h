@@ -0,0 +1,591 @@
+// FrameDrawBuffer.h
+#ifndef FRAME_DRAW_BUFFER_H
+#define FRAME_DRAW_BUFFER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Scene.h"
+#include "Shader.h"
+#include "Profiler.h"
+
+// GPU copy of one frame's positions and colors. Per-type arrays are
+// uploaded back to back (boxes expanded to their 12 edges), so drawing a
+// primitive is one glDrawArrays at a computed offset. Frames decoded from a
+// FrameStore are made of shared blocks: each block is uploaded once into a
+// range of a large shared page (one VBO and VAO) and reused by every frame
+// (and every FrameDrawBuffer) that contains it. Drawing the whole frame in
+// its own colors is one glMultiDrawArrays per page and type (drawAll), so
+// the draw count does not grow with the number of blocks. Analysis views
+// bind a recolored private copy instead (bindColored).
+class FrameDrawBuffer {
+public:
+	// Drops the held frame; call when the capture is released.
+	void invalidate() {
+		releaseSpans();
+		source.reset();
+	}
+
+	// Deletes the shared block buffers; every FrameDrawBuffer must be invalidated first.
+	static void releaseBlocks() {
+		for (Page& page : pages()) destroy(page);
+		pages().clear();
+		blockCache().clear();
+		blockLru().clear();
+		blockBytes() = 0;
+	}
+
+	static size_t sharedBlockCount() { return blockCache().size(); }
+	static size_t sharedPageCount() {
+		return (size_t)std::count_if(pages().begin(), pages().end(), [](const Page& page) { return page.vao != 0; });
+	}
+	static size_t sharedPageBytes() {
+		size_t bytes = 0;
+		for (const Page& page : pages()) bytes += (size_t)page.capacity * sizeof(Vertex);
+		return bytes;
+	}
+	static uint32_t blockEnd(const Frame& frame, size_t b) {
+		return b + 1 < frame.blockIds.size() ? frame.blockStart[b + 1] : (uint32_t)frame.size();
+	}
+
+	// Interleaved vertex: position (attribute 0), packed color (attribute 2)
+	struct Vertex {
+		glm::vec3 position;
+		uint32_t color;
+	};
+
+	// Vertices of primitives [first, end), grouped by type in slot order;
+	// base[t] receives the first vertex of type t.
+	static void buildVertices(const Frame& frame, uint32_t first, uint32_t end, GLint* base, std::vector<Vertex>& data) {
+		data.clear();
+		for (int t = 0; t < (int)PrimType::Count; ++t) {
+			base[t] = (GLint)data.size();
+			for (uint32_t i = first; i < end; ++i) {
+				if ((int)frame.type(i) != t) continue;
+				appendPrimitive(PrimType(t), frame.positions(i), frame.byType[t].colors[frame.slot(i)], data);
+			}
+		}
+	}
+
+	// Vertex data of one shared block, built ahead of time off the GL thread
+	// (see Playback.h) and handed to uploadBlock() later.
+	struct BlockData {
+		uint32_t block = UINT32_MAX;
+		GLint base[(int)PrimType::Count] = {};
+		std::vector<Vertex> vertices;
+	};
+
+	// Needs no GL context; the frame must come from a FrameStore.
+	static void buildBlock(const Frame& frame, size_t b, BlockData& out) {
+		out.block = frame.blockIds[b];
+		buildVertices(frame, frame.blockStart[b], blockEnd(frame, b), out.base, out.vertices);
+	}
+
+	// Marks a block as just used, so it is evicted last; false if it is not on the GPU.
+	static bool touchBlock(uint32_t id) {
+		auto it = blockCache().find(id);
+		if (it == blockCache().end() || it->second.vao == 0) return false;
+		touch(it->first, it->second);
+		return true;
+	}
+
+	// Uploads a prepared block unless it is already resident; returns the bytes uploaded.
+	static size_t uploadBlock(const BlockData& data) {
+		Gpu& gpu = blockCache()[data.block];
+		if (gpu.vao != 0) return 0;
+		std::copy(data.base, data.base + (int)PrimType::Count, gpu.base);
+		storeShared(gpu, data.vertices);
+		const size_t bytes = gpu.bytes;
+		blockBytes() += bytes;
+		touch(data.block, gpu);
+		evictBlocks();
+		return bytes;
+	}
+
+	static size_t sharedBlockBytes() { return blockBytes(); }
+
+	// Holds on to the frame, so a decoded copy cannot be freed and its address reused while bound.
+	void bind(const std::shared_ptr<const Frame>& frame) {
+		boundVao = 0;
+		if (source == frame && !withoutPoints && !colored) return;
+		releaseSpans();
+		source = frame;
+		withoutPoints = false;
+		colored = false;
+		lastSpan = 0;
+
+		if (frame->blockIds.empty()) {
+			// Not assembled from blocks (parse buffers): one private buffer
+			std::vector<Vertex> data;
+			buildVertices(*frame, 0, (uint32_t)frame->size(), own.base, data);
+			store(own, data);
+			Span span;
+			span.gpu = &own;
+			spans.push_back(span);
+			buildBatches();
+			return;
+		}
+
+		uint32_t typeSlot[(int)PrimType::Count] = {};
+		for (size_t b = 0; b < frame->blockIds.size(); ++b) {
+			const uint32_t first = frame->blockStart[b];
+			const uint32_t end = blockEnd(*frame, b);
+			Gpu& gpu = blockCache()[frame->blockIds[b]];
+			if (gpu.vao == 0) {
+				std::vector<Vertex> data;
+				buildVertices(*frame, first, end, gpu.base, data);
+				storeShared(gpu, data);
+				blockBytes() += gpu.bytes;
+			}
+			++gpu.users;
+			touch(frame->blockIds[b], gpu);
+
+			Span span;
+			span.gpu = &gpu;
+			span.block = frame->blockIds[b];
+			span.first = first;
+			std::copy(typeSlot, typeSlot + (int)PrimType::Count, span.typeSlot);
+			spans.push_back(span);
+			for (uint32_t i = first; i < end; ++i) ++typeSlot[frame->refs[i] & 3];
+		}
+		evictBlocks();
+		buildBatches();
+	}
+
+	// Binds `frame` through a private buffer that leaves its points out (a
+	// point cloud drawn by PointCloudRenderer), so they never reach the shared
+	// block cache. draw() must not be called for the frame's points.
+	void bindWithoutPoints(const std::shared_ptr<const Frame>& frame) {
+		boundVao = 0;
+		if (source == frame && withoutPoints) return;
+		releaseSpans();
+		source = frame;
+		withoutPoints = true;
+		colored = false;
+		lastSpan = 0;
+
+		std::vector<Vertex> data;
+		for (int t = 0; t < (int)PrimType::Count; ++t) {
+			own.base[t] = (GLint)data.size();
+			const Frame::TypeArrays& a = frame->arrays(PrimType(t));
+			if (PrimType(t) == PrimType::Point) continue;
+			for (size_t slot = 0; slot < a.size(); ++slot)
+				appendPrimitive(PrimType(t), &a.positions[slot * kPrimVertexCount[t]], a.colors[slot], data);
+		}
+		store(own, data);
+		Span span;
+		span.gpu = &own;
+		spans.push_back(span);
+		buildBatches();
+	}
+
+	// Binds `frame` through a private buffer holding only the primitives for
+	// which `colorOf(i, packedColor)` returns true, in the color it writes
+	// (analysis results: diff states, clearance, intersections). The buffer
+	// is rebuilt only when the frame or `key` (the caller's version of the
+	// coloring) changes. Draw it with drawAll(shader, -1); draw() is not
+	// available for it.
+	template <class ColorOf>
+	void bindColored(const std::shared_ptr<const Frame>& frame, uint64_t key, ColorOf colorOf) {
+		boundVao = 0;
+		if (source == frame && colored && coloredKey == key) return;
+		releaseSpans();
+		source = frame;
+		withoutPoints = false;
+		colored = true;
+		coloredKey = key;
+		lastSpan = 0;
+
+		std::vector<Vertex> data;
+		for (int t = 0; t < (int)PrimType::Count; ++t) {
+			own.base[t] = (GLint)data.size();
+			const Frame::TypeArrays& a = frame->arrays(PrimType(t));
+			for (size_t slot = 0; slot < a.size(); ++slot) {
+				uint32_t color = 0;
+				if (colorOf(a.primitives[slot], color))
+					appendPrimitive(PrimType(t), &a.positions[slot * kPrimVertexCount[t]], color, data);
+			}
+		}
+		store(own, data);
+		Span span;
+		span.gpu = &own;
+		spans.push_back(span);
+		buildBatches();
+	}
+
+	// Primitive i of the bound frame with an explicit base color.
+	void draw(Shader& shaderProgram, size_t i, const glm::vec4& color, bool isSelected) const {
+		const PrimType type = source->type(i);
+		const Span& span = spanOf((uint32_t)i);
+		if (span.gpu->vao != boundVao) {
+			boundVao = span.gpu->vao;
+			glBindVertexArray(boundVao);
+		}
+		const GLint first = span.gpu->first + span.gpu->base[(int)type] + (GLint)((source->slot(i) - span.typeSlot[(int)type]) * drawCount(type));
+
+		shaderProgram.setBool("useLighting", false);
+
+		// Compute draw color (boost/saturate when selected)
+		auto boosted = [&](const glm::vec4& c) -> glm::vec4 {
+			// mix toward yellowish for visibility, clamp to 1
+			glm::vec3 target(1.0f, 1.0f, 0.2f);
+			glm::vec3 rgb = glm::mix(glm::vec3(c), target, 0.5f);
+			return glm::vec4(glm::min(rgb * 1.1f, glm::vec3(1.0f)), 1.0f);
+			};
+		glm::vec4 drawColor = isSelected ? boosted(color) : color;
+		shaderProgram.setVec4("primitiveColor", drawColor);
+
+		if (type == PrimType::Triangle) {
+			// filled
+			glDrawArrays(GL_TRIANGLES, first, 3);
+			profiler::countDraw();
+
+			if (isSelected) {
+				// quick outline for clarity
+				glLineWidth(2.5f);
+				shaderProgram.setVec4("primitiveColor", glm::vec4(1.0f, 1.0f, 0.2f, 1.0f));
+				glDrawArrays(GL_LINE_LOOP, first, 3);
+				profiler::countDraw();
+				glLineWidth(1.0f);
+			}
+		}
+		else if (type == PrimType::Line || type == PrimType::Box) {
+			if (isSelected) glLineWidth(3.0f);
+			glDrawArrays(GL_LINES, first, drawCount(type));
+			profiler::countDraw();
+			if (isSelected) glLineWidth(1.0f);
+		}
+		else if (type == PrimType::Point) {
+			if (isSelected) glPointSize(9.0f); else glPointSize(5.0f);
+			glDrawArrays(GL_POINTS, first, 1);
+			profiler::countDraw();
+			glPointSize(1.0f); // restore default
+		}
+	}
+
+	// Every primitive of the bound frame in its own color, one multi-draw per
+	// page and type, then `selected` (or -1) highlighted on top. The points of a
+	// frame bound without them are left out, the selected one included.
+	void drawAll(Shader& shaderProgram, int selected) const {
+		shaderProgram.setBool("useLighting", false);
+		shaderProgram.setBool("useVertexColor", true);
+		glPointSize(5.0f);
+		drawSpans();
+		glPointSize(1.0f);
+		shaderProgram.setBool("useVertexColor", false);
+
+		if (selected < 0 || selected >= (int)source->size() || colored) return;
+		if (withoutPoints && source->type(selected) == PrimType::Point) return;
+		glDepthFunc(GL_LEQUAL);
+		draw(shaderProgram, selected, source->color(selected), true);
+		glDepthFunc(GL_LESS);
+	}
+
+	// Every primitive of the bound frame in one color (onion skin ghosts), one
+	// multi-draw per page and type; blending and point size are up to the caller.
+	void drawTinted(Shader& shaderProgram, const glm::vec4& color) const {
+		shaderProgram.setBool("useLighting", false);
+		shaderProgram.setVec4("primitiveColor", color);
+		drawSpans();
+	}
+
+	// Deletes the unused block buffers with ids from `firstId` on (blocks of a
+	// store that was cleared; see FrameStore::setBlockIdBase).
+	static void releaseBlocksFrom(uint32_t firstId) {
+		auto& cache = blockCache();
+		for (auto it = cache.begin(); it != cache.end();) {
+			if (it->first < firstId || it->second.users > 0) {
+				++it;
+				continue;
+			}
+			it = dropBlock(it);
+		}
+	}
+
+private:
+	static constexpr size_t kBlockBudget = size_t(256) << 20;   // block vertices kept on the GPU
+	static constexpr GLint kPageVertices = 1 << 21;              // 32 MB pages
+
+	// A shared VBO (and its VAO) that blocks are sub-allocated from
+	struct Page {
+		GLuint vao = 0, vbo = 0;
+		GLint capacity = 0;
+		GLint used = 0;
+		std::vector<std::pair<GLint, GLint>> holes;   // free (first, count) ranges, sorted by first
+	};
+
+	struct Gpu {
+		GLuint vao = 0;
+		GLuint vbo = 0;            // private buffers only; blocks live in a page
+		int page = -1;
+		GLint first = 0;           // first vertex in the page
+		GLint reserved = 0;        // length of the page range (at least one vertex)
+		GLint base[(int)PrimType::Count] = {};
+		GLint vertices = 0;
+		size_t bytes = 0;
+		uint32_t users = 0;        // FrameDrawBuffers bound to a frame that uses it
+		bool listed = false;       // in blockLru()
+		std::list<uint32_t>::iterator pos;
+	};
+
+	// A run of the bound frame's primitives drawn from one buffer
+	struct Span {
+		Gpu* gpu = nullptr;
+		uint32_t block = UINT32_MAX;
+		uint32_t first = 0;                               // first primitive
+		uint32_t typeSlot[(int)PrimType::Count] = {};     // frame slot of the span's first primitive per type
+	};
+
+	// The bound frame's vertex ranges in one VAO, drawn with one glMultiDrawArrays per type
+	struct Batch {
+		GLuint vao = 0;
+		std::vector<GLint> first[(int)PrimType::Count];
+		std::vector<GLsizei> count[(int)PrimType::Count];
+	};
+
+	static GLsizei drawCount(PrimType type) {
+		return type == PrimType::Box ? 24 : (GLsizei)kPrimVertexCount[(int)type];
+	}
+
+	static void appendPrimitive(PrimType type, const glm::vec3* p, uint32_t color, std::vector<Vertex>& data) {
+		const size_t start = data.size();
+		data.resize(start + drawCount(type));
+		if (type == PrimType::Box) {
+			glm::vec3 edges[24];
+			boxEdges(p[0], p[1], edges);
+			for (int k = 0; k < 24; ++k) data[start + k].position = edges[k];
+		}
+		else {
+			for (uint32_t k = 0; k < kPrimVertexCount[(int)type]; ++k) data[start + k].position = p[k];
+		}
+		for (size_t k = start; k < data.size(); ++k) data[k].color = color;
+	}
+
+	static std::unordered_map<uint32_t, Gpu>& blockCache() {
+		static std::unordered_map<uint32_t, Gpu> cache;
+		return cache;
+	}
+	static std::vector<Page>& pages() {
+		static std::vector<Page> list;
+		return list;
+	}
+	static size_t& blockBytes() {
+		static size_t bytes = 0;
+		return bytes;
+	}
+	// Resident block ids, most recently used first
+	static std::list<uint32_t>& blockLru() {
+		static std::list<uint32_t> lru;
+		return lru;
+	}
+
+	static void touch(uint32_t id, Gpu& gpu) {
+		auto& lru = blockLru();
+		if (gpu.listed) {
+			lru.splice(lru.begin(), lru, gpu.pos);
+			return;
+		}
+		lru.push_front(id);
+		gpu.pos = lru.begin();
+		gpu.listed = true;
+	}
+
+	// Interleaved layout of the currently bound GL_ARRAY_BUFFER into the bound VAO
+	static void setLayout() {
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+		glEnableVertexAttribArray(2);
+	}
+
+	static void destroy(Page& page) {
+		glDeleteBuffers(1, &page.vbo);
+		glDeleteVertexArrays(1, &page.vao);
+		page = Page();
+	}
+
+	// First fit over the pages' free ranges; opens a page when none has room.
+	static void allocate(Gpu& gpu, GLint count) {
+		auto& list = pages();
+		for (size_t p = 0; p < list.size(); ++p) {
+			auto& holes = list[p].holes;
+			for (size_t h = 0; h < holes.size(); ++h) {
+				if (holes[h].second < count) continue;
+				gpu.page = (int)p;
+				gpu.first = holes[h].first;
+				holes[h].first += count;
+				holes[h].second -= count;
+				if (holes[h].second == 0) holes.erase(holes.begin() + h);
+				list[p].used += count;
+				gpu.vao = list[p].vao;
+				return;
+			}
+		}
+		size_t p = 0;
+		while (p < list.size() && list[p].vao != 0) ++p;
+		if (p == list.size()) list.emplace_back();
+		Page& page = list[p];
+		page.capacity = std::max(kPageVertices, count);
+		glGenVertexArrays(1, &page.vao);
+		glGenBuffers(1, &page.vbo);
+		glBindVertexArray(page.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, page.vbo);
+		glBufferData(GL_ARRAY_BUFFER, (size_t)page.capacity * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+		setLayout();
+		glBindVertexArray(0);
+		if (count < page.capacity) page.holes.push_back({ count, page.capacity - count });
+		page.used = count;
+		gpu.page = (int)p;
+		gpu.first = 0;
+		gpu.vao = page.vao;
+	}
+
+	// Returns a block's range to its page, merging it with free neighbours; an empty page is deleted.
+	static void release(Gpu& gpu) {
+		Page& page = pages()[gpu.page];
+		auto& holes = page.holes;
+		auto it = std::lower_bound(holes.begin(), holes.end(), std::make_pair(gpu.first, GLint(0)));
+		it = holes.insert(it, { gpu.first, gpu.reserved });
+		if (it + 1 != holes.end() && it->first + it->second == (it + 1)->first) {
+			it->second += (it + 1)->second;
+			holes.erase(it + 1);
+		}
+		if (it != holes.begin() && (it - 1)->first + (it - 1)->second == it->first) {
+			(it - 1)->second += it->second;
+			holes.erase(it);
+		}
+		page.used -= gpu.reserved;
+		if (page.used == 0) destroy(page);
+		gpu.vao = 0;
+		gpu.page = -1;
+	}
+
+	// A block's vertices into a range of a shared page
+	static void storeShared(Gpu& gpu, const std::vector<Vertex>& data) {
+		gpu.vertices = (GLint)data.size();
+		gpu.bytes = data.size() * sizeof(Vertex);
+		gpu.reserved = std::max(gpu.vertices, GLint(1));
+		allocate(gpu, gpu.reserved);
+		glBindBuffer(GL_ARRAY_BUFFER, pages()[gpu.page].vbo);
+		glBufferSubData(GL_ARRAY_BUFFER, (size_t)gpu.first * sizeof(Vertex), gpu.bytes, data.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		profiler::countUpload(gpu.bytes);
+	}
+
+	// A private buffer with its own VAO, replaced wholesale
+	static void store(Gpu& gpu, const std::vector<Vertex>& data) {
+		if (gpu.vao == 0) {
+			glGenVertexArrays(1, &gpu.vao);
+			glGenBuffers(1, &gpu.vbo);
+			glBindVertexArray(gpu.vao);
+			glBindBuffer(GL_ARRAY_BUFFER, gpu.vbo);
+			setLayout();
+			glBindVertexArray(0);
+		}
+		gpu.vertices = (GLint)data.size();
+		gpu.bytes = data.size() * sizeof(Vertex);
+		glBindBuffer(GL_ARRAY_BUFFER, gpu.vbo);
+		glBufferData(GL_ARRAY_BUFFER, gpu.bytes, data.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		profiler::countUpload(gpu.bytes);
+	}
+
+	// Frees a block's page range and forgets it; returns the next cache entry.
+	static std::unordered_map<uint32_t, Gpu>::iterator dropBlock(std::unordered_map<uint32_t, Gpu>::iterator it) {
+		blockBytes() -= it->second.bytes;
+		if (it->second.listed) blockLru().erase(it->second.pos);
+		if (it->second.page >= 0) release(it->second);
+		return blockCache().erase(it);
+	}
+
+	// Least recently bound blocks go first, walking the LRU from its tail; blocks of a bound frame are kept.
+	static void evictBlocks() {
+		auto& lru = blockLru();
+		auto it = lru.end();
+		while (blockBytes() > kBlockBudget && it != lru.begin()) {
+			--it;
+			auto entry = blockCache().find(*it);
+			if (entry->second.users > 0) continue;
+			++it;   // stays valid: dropBlock erases the element before it
+			dropBlock(entry);
+		}
+	}
+
+	// Gathers the spans' per-type vertex ranges by VAO, merging ranges that touch.
+	void buildBatches() {
+		batches.clear();
+		for (const Span& span : spans) {
+			const Gpu& gpu = *span.gpu;
+			auto batch = std::find_if(batches.begin(), batches.end(), [&](const Batch& b) { return b.vao == gpu.vao; });
+			if (batch == batches.end()) {
+				batches.emplace_back();
+				batch = batches.end() - 1;
+				batch->vao = gpu.vao;
+			}
+			for (int t = 0; t < (int)PrimType::Count; ++t) {
+				const GLint end = t + 1 < (int)PrimType::Count ? gpu.base[t + 1] : gpu.vertices;
+				if (end <= gpu.base[t]) continue;
+				const GLint first = gpu.first + gpu.base[t];
+				auto& firsts = batch->first[t];
+				auto& counts = batch->count[t];
+				if (!firsts.empty() && firsts.back() + counts.back() == first) counts.back() += end - gpu.base[t];
+				else {
+					firsts.push_back(first);
+					counts.push_back(end - gpu.base[t]);
+				}
+			}
+		}
+	}
+
+	void drawSpans() const {
+		boundVao = 0;   // another buffer may have been drawn since bind()
+		for (const Batch& batch : batches) {
+			glBindVertexArray(batch.vao);
+			boundVao = batch.vao;
+			for (int t = 0; t < (int)PrimType::Count; ++t) {
+				if (batch.first[t].empty()) continue;
+				const GLenum mode = PrimType(t) == PrimType::Triangle ? GL_TRIANGLES : PrimType(t) == PrimType::Point ? GL_POINTS : GL_LINES;
+				glMultiDrawArrays(mode, batch.first[t].data(), batch.count[t].data(), (GLsizei)batch.first[t].size());
+				profiler::countDraw();
+			}
+		}
+	}
+
+	void releaseSpans() {
+		for (const Span& span : spans)
+			if (span.block != UINT32_MAX) --span.gpu->users;
+		spans.clear();
+		batches.clear();
+	}
+
+	// Draw loops walk primitives in order, so the current and next span are tried first.
+	const Span& spanOf(uint32_t i) const {
+		const size_t n = spans.size();
+		auto inSpan = [&](size_t s) {
+			return spans[s].first <= i && (s + 1 == n || i < spans[s + 1].first);
+		};
+		if (inSpan(lastSpan)) return spans[lastSpan];
+		if (lastSpan + 1 < n && inSpan(lastSpan + 1)) return spans[++lastSpan];
+		auto it = std::upper_bound(spans.begin(), spans.end(), i, [](uint32_t v, const Span& s) { return v < s.first; });
+		lastSpan = (size_t)(it - spans.begin()) - 1;
+		return spans[lastSpan];
+	}
+
+	std::shared_ptr<const Frame> source;
+	std::vector<Span> spans;
+	std::vector<Batch> batches;
+	Gpu own;
+	bool withoutPoints = false;
+	bool colored = false;
+	uint64_t coloredKey = 0;
+	mutable size_t lastSpan = 0;
+	mutable GLuint boundVao = 0;
+};
+
+#endif // FRAME_DRAW_BUFFER_H
@@ -0,0 +1,381 @@
+// FrameStore.h
+#ifndef FRAME_STORE_H
+#define FRAME_STORE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Scene.h"
+#include "FrameCodec.h"
+
+// Every frame of a capture, held compressed in one arena. A frame is cut
+// into content-defined blocks (a boundary follows each primitive whose hash
+// has its low bits clear), so static geometry re-emitted every frame yields
+// the same blocks wherever it sits in the frame. Each distinct block is
+// encoded once (see FrameCodec.h) and frames keep only their block ids.
+// Frames are decoded on access into an LRU cache bounded by a memory
+// budget; the current frame and its neighbours are pinned and never
+// evicted. Bounds and primitive counts stay available without decoding.
+// get() may be called from any thread; append() and clear() must not run
+// while other threads read the store.
+class FrameStore {
+public:
+	using FramePtr = std::shared_ptr<const Frame>;
+
+	struct Stats {
+		size_t frames = 0;
+		uint64_t rawBytes = 0;        // all frames decoded
+		uint64_t packedBytes = 0;     // distinct compressed blocks + per-frame block lists
+		size_t blocks = 0;            // distinct blocks
+		size_t blockRefs = 0;         // blocks referenced by all frames
+		uint64_t residentBytes = 0;   // decoded frames held by the cache
+		size_t residentFrames = 0;
+		uint64_t decodes = 0;
+		double decodeSeconds = 0.0;
+		double maxDecodeSeconds = 0.0;
+	};
+
+	// Primitives shared by a run of frames (the parser's retained set), encoded
+	// once when it changes; append() places them ahead of a frame's own.
+	struct Layer {
+		std::vector<uint32_t> blocks;
+		uint32_t primitives = 0;
+		AABB bounds;
+	};
+
+	explicit FrameStore(size_t budgetBytes = size_t(512) << 20)
+		: arena(1 << 20), budgetBytes(budgetBytes) {
+	}
+
+	size_t size() const { return slots.size(); }
+	bool empty() const { return slots.empty(); }
+	const AABB& bounds(size_t f) const { return slots[f].bounds; }
+	size_t primitiveCount(size_t f) const { return slots[f].primitives; }
+	uint64_t decodedBytes(size_t f) const { return slots[f].rawBytes; }
+
+	// Frame f as its distinct blocks, in order. Ids are the store's own
+	// (without blockIdBase()); decodeBlock() yields one block's primitives.
+	const uint32_t* frameBlockIds(size_t f) const { return slots[f].blocks; }
+	size_t frameBlockCount(size_t f) const { return slots[f].blockCount; }
+	size_t distinctBlocks() const { return blocks.size(); }
+	uint32_t blockPrimitives(uint32_t b) const {
+		uint32_t n = 0;
+		for (uint32_t c : blocks[b].typeCount) n += c;
+		return n;
+	}
+	bool decodeBlock(uint32_t b, Frame& out) const {
+		static thread_local std::vector<uint8_t> buffer;
+		return framecodec::decode(blocks[b].data, blocks[b].size, out, buffer);
+	}
+
+	// Never null; a blob that fails to decode yields an empty frame.
+	FramePtr get(size_t f) const {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it = cache.find(f);
+			if (it != cache.end()) {
+				lru.splice(lru.begin(), lru, it->second.pos);
+				return it->second.frame;
+			}
+		}
+
+		// Decode outside the lock; a concurrent decode of the same frame just loses the race.
+		auto t0 = std::chrono::steady_clock::now();
+		auto frame = std::make_shared<Frame>();
+		decodeFrame(slots[f], *frame);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		++counters.decodes;
+		counters.decodeSeconds += seconds;
+		counters.maxDecodeSeconds = std::max(counters.maxDecodeSeconds, seconds);
+		auto it = cache.find(f);
+		if (it != cache.end()) return it->second.frame;
+		lru.push_front(f);
+		const size_t bytes = frame->memoryUsage();
+		cache.emplace(f, Entry{ frame, bytes, lru.begin() });
+		residentBytes += bytes;
+		evict();
+		return frame;
+	}
+
+	FramePtr operator[](size_t f) const { return get(f); }
+
+	Layer encodeLayer(const Frame& layer) {
+		Layer l;
+		splitBlocks(layer, l.blocks);
+		l.primitives = (uint32_t)layer.size();
+		l.bounds = layer.bounds;
+		return l;
+	}
+
+	// Adds a frame made of `retained` (if any) followed by `frame`'s primitives.
+	void append(const Frame& frame, const Layer* retained = nullptr) {
+		frameBlocks.clear();
+		Slot s;
+		if (retained) {
+			frameBlocks = retained->blocks;
+			s.primitives = retained->primitives;
+			s.bounds = retained->bounds;
+		}
+		splitBlocks(frame, frameBlocks);
+		for (uint32_t id : frameBlocks) ++blocks[id].uses;
+
+		auto* ids = static_cast<uint32_t*>(arena.allocate(frameBlocks.size() * sizeof(uint32_t), alignof(uint32_t)));
+		std::copy(frameBlocks.begin(), frameBlocks.end(), ids);
+		s.blocks = ids;
+		s.blockCount = (uint32_t)frameBlocks.size();
+		s.primitives += (uint32_t)frame.size();
+		s.rawBytes = decodedSize(s);
+		s.bounds.merge(frame.bounds);
+		slots.push_back(s);
+		rawBytes += s.rawBytes;
+		packedBytes += s.blockCount * sizeof(uint32_t);
+		blockRefs += s.blockCount;
+	}
+
+	// Frames still held by callers stay valid; only the store lets go.
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		cache.clear();
+		lru.clear();
+		slots.clear();
+		blocks.clear();
+		blockIndex.clear();
+		arena.release();
+		residentBytes = rawBytes = packedBytes = 0;
+		blockRefs = 0;
+		counters = Stats();
+	}
+
+	// Keeps frames [f - radius, f + radius] decoded.
+	void pin(size_t f, size_t radius = 1) { pin(f, radius, radius); }
+
+	// Keeps frames [f - behind, f + ahead] decoded; past the last frame the
+	// range wraps around to the first (looped playback).
+	void pin(size_t f, size_t behind, size_t ahead) {
+		std::lock_guard<std::mutex> lock(mutex);
+		pinLo = f > behind ? f - behind : 0;
+		pinHi = f + ahead;
+		evict();
+	}
+
+	void setBudget(size_t bytes) {
+		std::lock_guard<std::mutex> lock(mutex);
+		budgetBytes = bytes;
+		evict();
+	}
+
+	size_t budget() const { return budgetBytes; }
+
+	// Added to the block ids of decoded frames, so frames of two stores never
+	// share an id in FrameDrawBuffer's block cache.
+	void setBlockIdBase(uint32_t base) { idBase = base; }
+	uint32_t blockIdBase() const { return idBase; }
+
+	// Quantization of positions per axis, applied to frames appended from now on;
+	// framecodec::kLosslessBits (the default) keeps positions exact.
+	void setPositionBits(int b) { bits = std::clamp(b, 8, framecodec::kLosslessBits); }
+	int positionBits() const { return bits; }
+
+	Stats stats() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		Stats s = counters;
+		s.frames = slots.size();
+		s.rawBytes = rawBytes;
+		s.packedBytes = packedBytes;
+		s.blocks = blocks.size();
+		s.blockRefs = blockRefs;
+		s.residentBytes = residentBytes;
+		s.residentFrames = cache.size();
+		return s;
+	}
+
+private:
+	static constexpr uint64_t kBoundaryMask = 63;   // ~64 primitives per block
+	static constexpr uint32_t kMaxBlock = 1024;
+
+	struct Slot {
+		const uint32_t* blocks = nullptr;
+		uint32_t blockCount = 0;
+		uint32_t primitives = 0;
+		uint64_t rawBytes = 0;
+		AABB bounds;
+	};
+
+	// One distinct run of primitives, shared by every frame that contains it
+	struct Block {
+		const uint8_t* data = nullptr;
+		uint32_t size = 0;
+		uint32_t uses = 0;                              // frames referencing it
+		uint32_t typeCount[(int)PrimType::Count] = {};
+	};
+
+	// Two independent 64-bit hashes of the block's primitives plus their count
+	struct BlockKey {
+		uint64_t a = 0, b = 0;
+		uint32_t count = 0;
+		bool operator==(const BlockKey& o) const { return a == o.a && b == o.b && count == o.count; }
+	};
+
+	struct BlockKeyHash {
+		size_t operator()(const BlockKey& k) const { return (size_t)k.a; }
+	};
+
+	static uint64_t mix64(uint64_t x) {
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdull;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ull;
+		x ^= x >> 33;
+		return x;
+	}
+
+	// Exact content of primitive i: type, name, color and position bits.
+	static uint64_t primitiveHash(const Frame& frame, size_t i) {
+		const PrimType type = frame.type(i);
+		uint64_t h = mix64(((uint64_t)frame.nameId(i) << 8) | (uint64_t)type);
+		h = mix64(h ^ frame.byType[(int)type].colors[frame.slot(i)]);
+		const glm::vec3* p = frame.positions(i);
+		for (uint32_t k = 0; k < frame.vertexCount(i); ++k) {
+			uint32_t w[3];
+			std::memcpy(w, &p[k], sizeof(w));
+			h = mix64(h ^ (w[0] | ((uint64_t)w[1] << 32)));
+			h = mix64(h ^ w[2]);
+		}
+		return h;
+	}
+
+	// Appends the ids of the blocks `frame` is cut into.
+	void splitBlocks(const Frame& frame, std::vector<uint32_t>& out) {
+		size_t begin = 0;
+		BlockKey key;
+		for (size_t i = 0; i < frame.size(); ++i) {
+			const uint64_t h = primitiveHash(frame, i);
+			key.a = mix64(key.a ^ h);
+			key.b = key.b * 0x9e3779b97f4a7c15ull + (h ^ 0x5851f42d4c957f2dull);
+			key.count = (uint32_t)(i + 1 - begin);
+			if ((h & kBoundaryMask) == 0 || key.count == kMaxBlock || i + 1 == frame.size()) {
+				out.push_back(internBlock(frame, begin, i + 1, key));
+				begin = i + 1;
+				key = BlockKey();
+			}
+		}
+	}
+
+	// Id of the block holding primitives [begin, end) of `frame`, encoding it if new.
+	uint32_t internBlock(const Frame& frame, size_t begin, size_t end, const BlockKey& key) {
+		auto it = blockIndex.find(key);
+		if (it != blockIndex.end()) return it->second;
+
+		chunk.clear();
+		for (size_t i = begin; i < end; ++i) {
+			const PrimType type = frame.type(i);
+			chunk.add(type, frame.nameId(i), frame.positions(i), frame.byType[(int)type].colors[frame.slot(i)]);
+		}
+		chunk.computeBounds();
+		framecodec::encode(chunk, bits, encoded, scratch);
+
+		Block b;
+		auto* data = static_cast<uint8_t*>(arena.allocate(encoded.size(), 1));
+		std::memcpy(data, encoded.data(), encoded.size());
+		b.data = data;
+		b.size = (uint32_t)encoded.size();
+		for (int t = 0; t < (int)PrimType::Count; ++t) b.typeCount[t] = (uint32_t)chunk.byType[t].size();
+		const uint32_t id = (uint32_t)blocks.size();
+		blocks.push_back(b);
+		blockIndex.emplace(key, id);
+		packedBytes += b.size;
+		return id;
+	}
+
+	// Concatenates the frame's blocks; a block that fails to decode leaves the frame empty.
+	void decodeFrame(const Slot& s, Frame& frame) const {
+		static thread_local Frame block;
+		static thread_local std::vector<uint8_t> buffer;
+		uint32_t counts[(int)PrimType::Count] = {};
+		for (uint32_t k = 0; k < s.blockCount; ++k)
+			for (int t = 0; t < (int)PrimType::Count; ++t) counts[t] += blocks[s.blocks[k]].typeCount[t];
+		for (int t = 0; t < (int)PrimType::Count; ++t) {
+			auto& a = frame.byType[t];
+			a.positions.reserve((size_t)counts[t] * kPrimVertexCount[t]);
+			a.colors.reserve(counts[t]);
+			a.nameIds.reserve(counts[t]);
+			a.primitives.reserve(counts[t]);
+		}
+		frame.refs.reserve(s.primitives);
+		frame.blockIds.reserve(s.blockCount);
+		frame.blockStart.reserve(s.blockCount);
+
+		for (uint32_t k = 0; k < s.blockCount; ++k) {
+			const Block& b = blocks[s.blocks[k]];
+			if (!framecodec::decode(b.data, b.size, block, buffer)) {
+				frame.clear();
+				return;
+			}
+			frame.blockIds.push_back(idBase + s.blocks[k]);
+			frame.blockStart.push_back((uint32_t)frame.size());
+			frame.append(block);
+		}
+		frame.bounds = s.bounds;
+	}
+
+	struct Entry {
+		FramePtr frame;
+		size_t bytes;
+		std::list<size_t>::iterator pos;
+	};
+
+	// Size of the frame once decoded, from its blocks' type counts.
+	uint64_t decodedSize(const Slot& s) const {
+		uint64_t bytes = sizeof(Frame) + (s.primitives + 2 * (uint64_t)s.blockCount) * sizeof(uint32_t);
+		for (uint32_t k = 0; k < s.blockCount; ++k)
+			for (int t = 0; t < (int)PrimType::Count; ++t)
+				bytes += (uint64_t)blocks[s.blocks[k]].typeCount[t] * (kPrimVertexCount[t] * sizeof(glm::vec3) + 3 * sizeof(uint32_t));
+		return bytes;
+	}
+
+	bool pinned(size_t f) const { return (f >= pinLo && f <= pinHi) || f + slots.size() <= pinHi; }
+
+	// Drops least recently used, unpinned frames until under budget. Caller holds the mutex.
+	void evict() const {
+		auto it = lru.end();
+		while (residentBytes > budgetBytes && it != lru.begin()) {
+			--it;
+			if (pinned(*it)) continue;
+			auto entry = cache.find(*it);
+			residentBytes -= entry->second.bytes;
+			cache.erase(entry);
+			it = lru.erase(it);
+		}
+	}
+
+	std::pmr::monotonic_buffer_resource arena;   // blocks and block lists; released by clear()
+	std::vector<Slot> slots;
+	std::vector<Block> blocks;
+	std::unordered_map<BlockKey, uint32_t, BlockKeyHash> blockIndex;
+	uint64_t rawBytes = 0, packedBytes = 0;
+	size_t blockRefs = 0;
+	int bits = framecodec::kLosslessBits;
+	uint32_t idBase = 0;
+	Frame chunk;                                  // append() buffers
+	std::vector<uint32_t> frameBlocks;
+	std::vector<uint8_t> encoded, scratch;
+
+	mutable std::mutex mutex;
+	mutable std::unordered_map<size_t, Entry> cache;
+	mutable std::list<size_t> lru;                // most recent first
+	mutable size_t residentBytes = 0;
+	mutable Stats counters;                       // decode statistics
+	size_t budgetBytes;
+	size_t pinLo = 1, pinHi = 0;                  // empty range
+};
+
+#endif // FRAME_STORE_H
@@ -0,0 +1,273 @@
+// Geometry.h
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <cmath>
+
+// Exact-ish predicates for the analysis tools. Inputs are float, all
+// arithmetic is double so the sign tests stay reliable for the nearly
+// degenerate configurations that show up in real captures.
+namespace geom {
+
+struct DVec3 {
+	double x, y, z;
+	DVec3() : x(0), y(0), z(0) {}
+	DVec3(double x, double y, double z) : x(x), y(y), z(z) {}
+	explicit DVec3(const glm::vec3& v) : x(v.x), y(v.y), z(v.z) {}
+	DVec3 operator-(const DVec3& o) const { return DVec3(x - o.x, y - o.y, z - o.z); }
+};
+
+static inline double dot(const DVec3& a, const DVec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static inline DVec3 cross(const DVec3& a, const DVec3& b) {
+	return DVec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+// Which side of the plane through (a, b, c) the point p lies on: dot(p - c, (a - c) x (b - c)).
+static inline double side(const DVec3& p, const DVec3& a, const DVec3& b, const DVec3& c) {
+	return dot(p - c, cross(a - c, b - c));
+}
+
+// 2D helpers for the coplanar case
+struct DVec2 { double x, y; };
+static inline double orient2d(const DVec2& a, const DVec2& b, const DVec2& c) {
+	return (a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x);
+}
+
+static inline bool segmentsIntersect2d(const DVec2& p1, const DVec2& p2, const DVec2& q1, const DVec2& q2) {
+	const double d1 = orient2d(q1, q2, p1), d2 = orient2d(q1, q2, p2);
+	const double d3 = orient2d(p1, p2, q1), d4 = orient2d(p1, p2, q2);
+	if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) return true;
+	auto onSegment = [](const DVec2& a, const DVec2& b, const DVec2& p) {
+		return std::fmin(a.x, b.x) <= p.x && p.x <= std::fmax(a.x, b.x) &&
+			std::fmin(a.y, b.y) <= p.y && p.y <= std::fmax(a.y, b.y);
+	};
+	return (d1 == 0 && onSegment(q1, q2, p1)) || (d2 == 0 && onSegment(q1, q2, p2)) ||
+		(d3 == 0 && onSegment(p1, p2, q1)) || (d4 == 0 && onSegment(p1, p2, q2));
+}
+
+static inline bool pointInTriangle2d(const DVec2& p, const DVec2& a, const DVec2& b, const DVec2& c) {
+	const double d1 = orient2d(a, b, p), d2 = orient2d(b, c, p), d3 = orient2d(c, a, p);
+	const bool hasNeg = d1 < 0 || d2 < 0 || d3 < 0;
+	const bool hasPos = d1 > 0 || d2 > 0 || d3 > 0;
+	return !(hasNeg && hasPos);
+}
+
+static inline bool coplanarTriTri(const DVec3* t1, const DVec3* t2, const DVec3& n) {
+	// Drop the dominant normal axis and test in 2D
+	const double ax = std::fabs(n.x), ay = std::fabs(n.y), az = std::fabs(n.z);
+	auto project = [&](const DVec3& p) -> DVec2 {
+		if (ax >= ay && ax >= az) return { p.y, p.z };
+		if (ay >= az) return { p.x, p.z };
+		return { p.x, p.y };
+	};
+	DVec2 a[3] = { project(t1[0]), project(t1[1]), project(t1[2]) };
+	DVec2 b[3] = { project(t2[0]), project(t2[1]), project(t2[2]) };
+
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			if (segmentsIntersect2d(a[i], a[(i + 1) % 3], b[j], b[(j + 1) % 3])) return true;
+	return pointInTriangle2d(a[0], b[0], b[1], b[2]) || pointInTriangle2d(b[0], a[0], a[1], a[2]);
+}
+
+// Interval check once both triangles are arranged so p1 and p2 are alone on their side.
+static inline bool checkMinMax(const DVec3& p1, const DVec3& q1, const DVec3& r1,
+	const DVec3& p2, const DVec3& q2, const DVec3& r2) {
+	if (side(q2, p2, p1, q1) > 0.0) return false;
+	if (side(r2, p2, r1, p1) > 0.0) return false;
+	return true;
+}
+
+static inline bool triTri3d(const DVec3& p1, const DVec3& q1, const DVec3& r1,
+	const DVec3& p2, const DVec3& q2, const DVec3& r2,
+	double dp2, double dq2, double dr2, const DVec3* t1, const DVec3* t2, const DVec3& n1) {
+	if (dp2 > 0) {
+		if (dq2 > 0) return checkMinMax(p1, r1, q1, r2, p2, q2);
+		if (dr2 > 0) return checkMinMax(p1, r1, q1, q2, r2, p2);
+		return checkMinMax(p1, q1, r1, p2, q2, r2);
+	}
+	if (dp2 < 0) {
+		if (dq2 < 0) return checkMinMax(p1, q1, r1, r2, p2, q2);
+		if (dr2 < 0) return checkMinMax(p1, q1, r1, q2, r2, p2);
+		return checkMinMax(p1, r1, q1, p2, q2, r2);
+	}
+	if (dq2 < 0) {
+		if (dr2 >= 0) return checkMinMax(p1, r1, q1, q2, r2, p2);
+		return checkMinMax(p1, q1, r1, p2, q2, r2);
+	}
+	if (dq2 > 0) {
+		if (dr2 > 0) return checkMinMax(p1, r1, q1, p2, q2, r2);
+		return checkMinMax(p1, q1, r1, q2, r2, p2);
+	}
+	if (dr2 > 0) return checkMinMax(p1, q1, r1, r2, p2, q2);
+	if (dr2 < 0) return checkMinMax(p1, r1, q1, r2, p2, q2);
+	return coplanarTriTri(t1, t2, n1);
+}
+
+// Guigue-Devillers triangle-triangle overlap test. Touching counts as overlapping.
+static inline bool triTriOverlap(const glm::vec3& a0, const glm::vec3& a1, const glm::vec3& a2,
+	const glm::vec3& b0, const glm::vec3& b1, const glm::vec3& b2) {
+	const DVec3 t1[3] = { DVec3(a0), DVec3(a1), DVec3(a2) };
+	const DVec3 t2[3] = { DVec3(b0), DVec3(b1), DVec3(b2) };
+	const DVec3 &p1 = t1[0], &q1 = t1[1], &r1 = t1[2];
+	const DVec3 &p2 = t2[0], &q2 = t2[1], &r2 = t2[2];
+
+	const double dp1 = side(p1, p2, q2, r2);
+	const double dq1 = side(q1, p2, q2, r2);
+	const double dr1 = side(r1, p2, q2, r2);
+	if (dp1 * dq1 > 0 && dp1 * dr1 > 0) return false;
+
+	const double dp2 = side(p2, p1, q1, r1);
+	const double dq2 = side(q2, p1, q1, r1);
+	const double dr2 = side(r2, p1, q1, r1);
+	if (dp2 * dq2 > 0 && dp2 * dr2 > 0) return false;
+
+	const DVec3 n1 = cross(q1 - p1, r1 - p1);
+
+	// Rotate triangle 1 so p1 is alone on its side of triangle 2's plane
+	if (dp1 > 0) {
+		if (dq1 > 0) return triTri3d(r1, p1, q1, p2, r2, q2, dp2, dr2, dq2, t1, t2, n1);
+		if (dr1 > 0) return triTri3d(q1, r1, p1, p2, r2, q2, dp2, dr2, dq2, t1, t2, n1);
+		return triTri3d(p1, q1, r1, p2, q2, r2, dp2, dq2, dr2, t1, t2, n1);
+	}
+	if (dp1 < 0) {
+		if (dq1 < 0) return triTri3d(r1, p1, q1, p2, q2, r2, dp2, dq2, dr2, t1, t2, n1);
+		if (dr1 < 0) return triTri3d(q1, r1, p1, p2, q2, r2, dp2, dq2, dr2, t1, t2, n1);
+		return triTri3d(p1, q1, r1, p2, r2, q2, dp2, dr2, dq2, t1, t2, n1);
+	}
+	if (dq1 < 0) {
+		if (dr1 >= 0) return triTri3d(q1, r1, p1, p2, r2, q2, dp2, dr2, dq2, t1, t2, n1);
+		return triTri3d(p1, q1, r1, p2, q2, r2, dp2, dq2, dr2, t1, t2, n1);
+	}
+	if (dq1 > 0) {
+		if (dr1 > 0) return triTri3d(p1, q1, r1, p2, r2, q2, dp2, dr2, dq2, t1, t2, n1);
+		return triTri3d(q1, r1, p1, p2, q2, r2, dp2, dq2, dr2, t1, t2, n1);
+	}
+	if (dr1 > 0) return triTri3d(r1, p1, q1, p2, q2, r2, dp2, dq2, dr2, t1, t2, n1);
+	if (dr1 < 0) return triTri3d(r1, p1, q1, p2, r2, q2, dp2, dr2, dq2, t1, t2, n1);
+	return coplanarTriTri(t1, t2, n1);
+}
+
+// --- Closest points (float, after Ericson, Real-Time Collision Detection) ---
+
+static inline glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+	const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+	const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+	const glm::vec3 bp = p - b;
+	const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3) return b;
+
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+
+	const glm::vec3 cp = p - c;
+	const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6) return c;
+
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+	const float denom = 1.0f / (va + vb + vc);
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Returns the squared distance; c1 lies on [p1, q1], c2 on [p2, q2].
+static inline float closestPointsSegmentSegment(const glm::vec3& p1, const glm::vec3& q1,
+	const glm::vec3& p2, const glm::vec3& q2, glm::vec3& c1, glm::vec3& c2) {
+	const float EPS = 1e-12f;
+	const glm::vec3 d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+	const float a = glm::dot(d1, d1), e = glm::dot(d2, d2), f = glm::dot(d2, r);
+	float s = 0.0f, t = 0.0f;
+
+	if (a <= EPS && e <= EPS) {
+		// both degenerate
+	}
+	else if (a <= EPS) {
+		t = glm::clamp(f / e, 0.0f, 1.0f);
+	}
+	else {
+		const float c = glm::dot(d1, r);
+		if (e <= EPS) {
+			s = glm::clamp(-c / a, 0.0f, 1.0f);
+		}
+		else {
+			const float b = glm::dot(d1, d2);
+			const float denom = a * e - b * b;
+			s = denom != 0.0f ? glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+			t = (b * s + f) / e;
+			if (t < 0.0f) { t = 0.0f; s = glm::clamp(-c / a, 0.0f, 1.0f); }
+			else if (t > 1.0f) { t = 1.0f; s = glm::clamp((b - c) / a, 0.0f, 1.0f); }
+		}
+	}
+	c1 = p1 + d1 * s;
+	c2 = p2 + d2 * t;
+	return glm::dot(c1 - c2, c1 - c2);
+}
+
+// Segment [p, q] against a triangle; `hit` receives the crossing point.
+static inline bool segmentTriangleIntersect(const glm::vec3& p, const glm::vec3& q,
+	const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, glm::vec3& hit) {
+	const glm::vec3 dir = q - p, e1 = b - a, e2 = c - a;
+	const glm::vec3 h = glm::cross(dir, e2);
+	const float det = glm::dot(e1, h);
+	if (std::fabs(det) < 1e-12f) return false;
+	const float inv = 1.0f / det;
+	const glm::vec3 s = p - a;
+	const float u = glm::dot(s, h) * inv;
+	if (u < 0.0f || u > 1.0f) return false;
+	const glm::vec3 qv = glm::cross(s, e1);
+	const float v = glm::dot(dir, qv) * inv;
+	if (v < 0.0f || u + v > 1.0f) return false;
+	const float t = glm::dot(e2, qv) * inv;
+	if (t < 0.0f || t > 1.0f) return false;
+	hit = p + dir * t;
+	return true;
+}
+
+static inline float closestPointsSegmentTriangle(const glm::vec3& p, const glm::vec3& q, const glm::vec3* tri,
+	glm::vec3& onSegment, glm::vec3& onTriangle) {
+	glm::vec3 hit;
+	if (segmentTriangleIntersect(p, q, tri[0], tri[1], tri[2], hit)) {
+		onSegment = onTriangle = hit;
+		return 0.0f;
+	}
+	float best = FLT_MAX;
+	auto consider = [&](const glm::vec3& s, const glm::vec3& t) {
+		float d2 = glm::dot(s - t, s - t);
+		if (d2 < best) { best = d2; onSegment = s; onTriangle = t; }
+	};
+	consider(p, closestPointOnTriangle(p, tri[0], tri[1], tri[2]));
+	consider(q, closestPointOnTriangle(q, tri[0], tri[1], tri[2]));
+	for (int i = 0; i < 3; ++i) {
+		glm::vec3 c1, c2;
+		closestPointsSegmentSegment(p, q, tri[i], tri[(i + 1) % 3], c1, c2);
+		consider(c1, c2);
+	}
+	return best;
+}
+
+static inline float closestPointsTriangleTriangle(const glm::vec3* t, const glm::vec3* u,
+	glm::vec3& onT, glm::vec3& onU) {
+	float best = FLT_MAX;
+	// Edges of each triangle against the other cover both the crossing and the separated cases
+	for (int i = 0; i < 3; ++i) {
+		glm::vec3 a, b;
+		float d2 = closestPointsSegmentTriangle(t[i], t[(i + 1) % 3], u, a, b);
+		if (d2 < best) { best = d2; onT = a; onU = b; }
+		d2 = closestPointsSegmentTriangle(u[i], u[(i + 1) % 3], t, b, a);
+		if (d2 < best) { best = d2; onT = a; onU = b; }
+		if (best == 0.0f) return best;
+	}
+	return best;
+}
+
+} // namespace geom
+
+#endif // GEOMETRY_H
@@ -0,0 +1,100 @@
+// GpuTimer.h
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Profiler.h"
+
+namespace profiler {
+
+// GL_TIME_ELAPSED queries around render passes. Each pass cycles through a
+// few query objects and reads them back frames later, so timing never
+// stalls the pipeline. Passes must not nest (GL allows one active
+// TIME_ELAPSED query).
+class GpuTimer {
+public:
+	static GpuTimer& shared() {
+		static GpuTimer instance;
+		return instance;
+	}
+
+	void begin(const char* name) {
+		if (!Profiler::shared().enabled || active) return;
+		Pass& pass = find(name);
+		const size_t slot = pass.next++ % kLatency;
+		collect(pass, slot);
+		glBeginQuery(GL_TIME_ELAPSED, pass.queries[slot]);
+		pass.submitted[slot] = nowNs();
+		pass.pending[slot] = true;
+		active = &pass;
+	}
+
+	void end() {
+		if (!active) return;
+		glEndQuery(GL_TIME_ELAPSED);
+		active = nullptr;
+	}
+
+	// Call with the GL context current, before it is destroyed.
+	void release() {
+		for (Pass& pass : passes) glDeleteQueries(kLatency, pass.queries);
+		passes.clear();
+		active = nullptr;
+	}
+
+private:
+	static constexpr size_t kLatency = 4;
+
+	struct Pass {
+		const char* name = nullptr;
+		GLuint queries[kLatency] = {};
+		uint64_t submitted[kLatency] = {};
+		bool pending[kLatency] = {};
+		size_t next = 0;
+	};
+
+	Pass& find(const char* name) {
+		for (Pass& pass : passes)
+			if (std::strcmp(pass.name, name) == 0) return pass;
+		passes.emplace_back();
+		passes.back().name = name;
+		glGenQueries(kLatency, passes.back().queries);
+		return passes.back();
+	}
+
+	// Hands finished queries to the profiler. Waits only for `reuse`, the
+	// slot about to be restarted (the GPU is kLatency frames behind then).
+	static void collect(Pass& pass, size_t reuse) {
+		for (size_t s = 0; s < kLatency; ++s) {
+			if (!pass.pending[s]) continue;
+			if (s != reuse) {
+				GLint available = 0;
+				glGetQueryObjectiv(pass.queries[s], GL_QUERY_RESULT_AVAILABLE, &available);
+				if (!available) continue;
+			}
+			GLuint64 ns = 0;
+			glGetQueryObjectui64v(pass.queries[s], GL_QUERY_RESULT, &ns);
+			pass.pending[s] = false;
+			Profiler::shared().recordGpu(pass.name, pass.submitted[s], ns);
+		}
+	}
+
+	std::vector<Pass> passes;
+	Pass* active = nullptr;
+};
+
+// Times the GPU work issued in the enclosing block; `name` must be a string literal.
+class GpuScope {
+public:
+	explicit GpuScope(const char* name) { GpuTimer::shared().begin(name); }
+	~GpuScope() { GpuTimer::shared().end(); }
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+};
+
+} // namespace profiler
+
+#endif // GPU_TIMER_H
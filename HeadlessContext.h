@@ -0,0 +1,265 @@
+// HeadlessContext.h
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "PngWriter.h"
+#include "ThreadPool.h"
+
+#if defined(SCENE_HAVE_EGL)
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// GL 3.3 core context without a visible window, for --headless rendering.
+// With EGL it is a surfaceless context (Mesa llvmpipe works with no display
+// and no GPU); otherwise, or when EGL fails, a hidden GLFW window.
+class HeadlessContext {
+public:
+	HeadlessContext() = default;
+	~HeadlessContext() { destroy(); }
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	bool create(std::string& error) {
+#if defined(SCENE_HAVE_EGL)
+		if (createEgl(error)) return true;
+#endif
+		return createGlfw(error);
+	}
+
+	void destroy() {
+#if defined(SCENE_HAVE_EGL)
+		if (display != EGL_NO_DISPLAY) {
+			eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+			eglTerminate(display);
+			context = EGL_NO_CONTEXT;
+			display = EGL_NO_DISPLAY;
+		}
+#endif
+		if (window) {
+			glfwDestroyWindow(window);
+			glfwTerminate();
+			window = nullptr;
+		}
+	}
+
+	const char* backend() const { return window ? "glfw" : "egl"; }
+
+private:
+#if defined(SCENE_HAVE_EGL)
+	bool createEgl(std::string& error) {
+		auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+			display = EGL_NO_DISPLAY;
+			error = "EGL: no display";
+			return false;
+		}
+
+		const EGLint configAttribs[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_NONE
+		};
+		const EGLint contextAttribs[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 3,
+			EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		EGLConfig config = nullptr;
+		EGLint count = 0;
+		if (eglBindAPI(EGL_OPENGL_API) && eglChooseConfig(display, configAttribs, &config, 1, &count) && count > 0)
+			context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+		// The framebuffer is ours, so no surface is needed (EGL_KHR_surfaceless_context)
+		if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+			error = "EGL: cannot create a surfaceless OpenGL 3.3 context";
+			destroy();
+			return false;
+		}
+		return true;
+	}
+
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+#endif
+
+	bool createGlfw(std::string& error) {
+		if (!glfwInit()) {
+			error += error.empty() ? "" : "; ";
+			error += "GLFW: cannot initialize (no display?)";
+			return false;
+		}
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		window = glfwCreateWindow(64, 64, "Scene Debugger (headless)", NULL, NULL);
+		if (!window) {
+			glfwTerminate();
+			error += error.empty() ? "" : "; ";
+			error += "GLFW: cannot create a hidden window";
+			return false;
+		}
+		glfwMakeContextCurrent(window);
+		return true;
+	}
+
+	GLFWwindow* window = nullptr;
+};
+
+// Offscreen color/depth target with pipelined readback. glReadPixels goes
+// into a ring of pixel pack buffers that are mapped kRing frames later, so
+// the CPU never waits for the frame it just submitted. Mapped pixels are
+// copied out and PNG encoded on the shared thread pool.
+class OffscreenRenderer {
+public:
+	OffscreenRenderer() = default;
+	~OffscreenRenderer() { release(); }
+	OffscreenRenderer(const OffscreenRenderer&) = delete;
+	OffscreenRenderer& operator=(const OffscreenRenderer&) = delete;
+
+	bool create(int w, int h, std::string& error) {
+		width = w;
+		height = h;
+		glGenRenderbuffers(2, renderbuffers);
+		glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glGenFramebuffers(1, &fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			error = "offscreen framebuffer is incomplete";
+			return false;
+		}
+
+		glGenBuffers(kRing, pbos);
+		for (GLuint pbo : pbos) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+			glBufferData(GL_PIXEL_PACK_BUFFER, imageBytes(), nullptr, GL_STREAM_READ);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		glViewport(0, 0, width, height);
+		return true;
+	}
+
+	// Starts the readback of what was just rendered; the image is written to `path` later.
+	void capture(const std::string& path) {
+		Slot& slot = slots[next];
+		if (slot.pending) retire(slot);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[next]);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		slot.path = path;
+		slot.pending = true;
+		next = (next + 1) % kRing;
+	}
+
+	// Retires outstanding readbacks in submission order and waits for the encoders.
+	void finish() {
+		for (int i = 0; i < kRing; ++i) {
+			Slot& slot = slots[(next + i) % kRing];
+			if (slot.pending) retire(slot);
+		}
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->done.wait(lock, [&] { return state->inFlight == 0; });
+	}
+
+	size_t imagesWritten() const { return state->written; }
+	size_t imagesFailed() const { return state->failed; }
+
+	void release() {
+		if (!fbo) return;
+		finish();
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &fbo);
+		glDeleteRenderbuffers(2, renderbuffers);
+		glDeleteBuffers(kRing, pbos);
+		fbo = 0;
+	}
+
+private:
+	static constexpr int kRing = 3;
+
+	struct Slot {
+		std::string path;
+		bool pending = false;
+	};
+
+	// Shared with the encode jobs
+	struct State {
+		std::mutex mutex;
+		std::condition_variable done;
+		size_t inFlight = 0, written = 0, failed = 0;
+	};
+
+	size_t imageBytes() const { return (size_t)width * height * 4; }
+
+	void retire(Slot& slot) {
+		const size_t index = &slot - slots;
+		auto pixels = std::make_shared<std::vector<uint8_t>>(imageBytes());
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[index]);
+		const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, imageBytes(), GL_MAP_READ_BIT);
+		if (mapped) {
+			std::memcpy(pixels->data(), mapped, imageBytes());
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		slot.pending = false;
+		if (!mapped) {
+			// No pixels to encode: count the image as failed rather than writing a blank one
+			std::lock_guard<std::mutex> lock(state->mutex);
+			++state->failed;
+			return;
+		}
+
+		// Bound the decoded images waiting for an encoder
+		ThreadPool& pool = ThreadPool::shared();
+		{
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->done.wait(lock, [&] { return state->inFlight < 2 * (size_t)pool.size() + 2; });
+			++state->inFlight;
+		}
+		pool.submit([state = state, pixels, path = slot.path, w = width, h = height] {
+			std::vector<uint8_t> file;
+			png::encode(pixels->data(), w, h, (size_t)w * 4, true, file);
+			const bool ok = png::writeFile(path, file);
+			std::lock_guard<std::mutex> lock(state->mutex);
+			++(ok ? state->written : state->failed);
+			--state->inFlight;
+			state->done.notify_all();
+		});
+	}
+
+	int width = 0, height = 0;
+	GLuint fbo = 0;
+	GLuint renderbuffers[2] = {};
+	GLuint pbos[kRing] = {};
+	Slot slots[kRing];
+	int next = 0;
+	std::shared_ptr<State> state = std::make_shared<State>();
+};
+
+#endif // HEADLESS_CONTEXT_H
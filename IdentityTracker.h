@@ -0,0 +1,174 @@
+// IdentityTracker.h
+#ifndef IDENTITY_TRACKER_H
+#define IDENTITY_TRACKER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "Scene.h"
+#include "FrameStore.h"
+
+// A primitive's identity across frames: its name plus which same-named
+// occurrence it is inside a frame (so repeated names still track 1:1).
+struct PrimitiveIdentity {
+	uint32_t nameId = 0;   // Frame::names() id
+	uint32_t duplicate = 0;
+	bool valid = false;
+};
+
+// Per distinct FrameStore block, its primitives' (name id, offset,
+// centroid) sorted by name, filled in frame order by a worker thread.
+// Frames are lists of shared blocks, so geometry repeated across frames is
+// indexed once, and a frame's entry is found by walking its block list.
+// Frames below indexedFrames() are answered from the index, newer ones by a
+// linear scan, so lookups never wait for the worker. Trajectories come from
+// the recorded centroids without decoding frames. The frames passed to
+// start() must not change until stop() returns.
+class IdentityTracker {
+public:
+	~IdentityTracker() { stop(); }
+
+	void start(const FrameStore& frames) {
+		stop();
+		source = &frames;
+		frameTotal = frames.size();
+		tables.assign(frames.distinctBlocks(), {});
+		broken.assign(frames.size(), 0);
+		cancel.store(false);
+		worker = std::thread([this] { run(); });
+	}
+
+	void stop() {
+		if (worker.joinable()) {
+			cancel.store(true);
+			worker.join();
+		}
+		tables = {};
+		broken = {};
+		frameTotal = 0;
+		framesDone.store(0);
+		entryBytes.store(0);
+		source = nullptr;
+	}
+
+	size_t indexedFrames() const { return framesDone.load(std::memory_order_acquire); }
+	size_t frameCount() const { return frameTotal; }
+
+	// Held by the index so far.
+	size_t memoryBytes() const {
+		return entryBytes.load(std::memory_order_relaxed) + tables.capacity() * sizeof(tables[0]) + broken.capacity();
+	}
+
+	static PrimitiveIdentity identify(const Frame& frame, int primitive) {
+		PrimitiveIdentity id;
+		if (primitive < 0 || primitive >= (int)frame.size()) return id;
+		id.nameId = frame.nameId(primitive);
+		for (int i = 0; i < primitive; ++i)
+			if (frame.nameId(i) == id.nameId) ++id.duplicate;
+		id.valid = true;
+		return id;
+	}
+
+	// Index of the primitive carrying `id` in frame f, or -1 when absent.
+	int locate(const FrameStore& frames, size_t f, const PrimitiveIdentity& id) const {
+		if (!id.valid || f >= frames.size()) return -1;
+		if (f < indexedFrames()) {
+			uint32_t primitive = 0;
+			return find(f, id, primitive) ? (int)primitive : -1;
+		}
+
+		uint32_t dup = 0;
+		const auto frame = frames[f];
+		for (size_t i = 0; i < frame->size(); ++i)
+			if (frame->nameId(i) == id.nameId && dup++ == id.duplicate) return (int)i;
+		return -1;
+	}
+
+	// Appends the centroid of `id` in each indexed frame from `from` on that it
+	// occurs in, in frame order, and returns the frame to continue from, so a
+	// path is extended as indexing advances instead of rebuilt.
+	size_t extendTrajectory(const PrimitiveIdentity& id, size_t from, std::vector<glm::vec3>& out) const {
+		const size_t n = indexedFrames();
+		if (!id.valid) return std::max(from, n);
+		uint32_t primitive = 0;
+		for (size_t f = from; f < n; ++f)
+			if (const Entry* e = find(f, id, primitive)) out.push_back(e->centroid);
+		return std::max(from, n);
+	}
+
+private:
+	struct Entry {
+		uint32_t nameId;
+		uint32_t offset;       // primitive index within the block
+		glm::vec3 centroid;
+		bool operator<(const Entry& o) const {
+			return nameId != o.nameId ? nameId < o.nameId : offset < o.offset;
+		}
+	};
+
+	// Entry of `id` in indexed frame f and its primitive index there, or null when absent.
+	const Entry* find(size_t f, const PrimitiveIdentity& id, uint32_t& primitive) const {
+		if (broken[f]) return nullptr;
+		const uint32_t* ids = source->frameBlockIds(f);
+		uint32_t dup = id.duplicate, offset = 0;
+		for (size_t k = 0; k < source->frameBlockCount(f); ++k) {
+			const auto& table = tables[ids[k]];
+			auto range = std::equal_range(table.begin(), table.end(), Entry{ id.nameId, 0, glm::vec3(0.0f) },
+				[](const Entry& a, const Entry& b) { return a.nameId < b.nameId; });
+			const uint32_t n = (uint32_t)(range.second - range.first);
+			if (dup < n) {
+				primitive = offset + range.first[dup].offset;
+				return &range.first[dup];
+			}
+			dup -= n;
+			offset += source->blockPrimitives(ids[k]);
+		}
+		return nullptr;
+	}
+
+	// Indexes each block the first time a frame references it. A block that
+	// fails to decode leaves its frames empty when decoded, so they are too here.
+	void run() {
+		const auto& frames = *source;
+		std::vector<bool> indexed(tables.size()), corrupt(tables.size());
+		Frame block;
+		size_t bytes = 0;
+		for (size_t f = 0; f < frames.size(); ++f) {
+			const uint32_t* ids = frames.frameBlockIds(f);
+			for (size_t k = 0; k < frames.frameBlockCount(f); ++k) {
+				if (cancel.load(std::memory_order_relaxed)) return;
+				const uint32_t b = ids[k];
+				if (corrupt[b]) broken[f] = 1;
+				if (indexed[b]) continue;
+				indexed[b] = true;
+				if (!frames.decodeBlock(b, block)) {
+					corrupt[b] = true;
+					broken[f] = 1;
+					continue;
+				}
+				auto& table = tables[b];
+				table.resize(block.size());
+				for (size_t i = 0; i < block.size(); ++i)
+					table[i] = { block.nameId(i), (uint32_t)i, block.centroid(i) };
+				std::sort(table.begin(), table.end());
+				bytes += table.capacity() * sizeof(Entry);
+			}
+			entryBytes.store(bytes, std::memory_order_relaxed);
+			framesDone.store(f + 1, std::memory_order_release);
+		}
+	}
+
+	const FrameStore* source = nullptr;
+	size_t frameTotal = 0;
+	std::vector<std::vector<Entry>> tables;   // by FrameStore block id
+	std::vector<uint8_t> broken;              // frames with a block that failed to decode
+	std::atomic<size_t> framesDone{ 0 };
+	std::atomic<size_t> entryBytes{ 0 };
+	std::atomic<bool> cancel{ false };
+	std::thread worker;
+};
+
+#endif // IDENTITY_TRACKER_H
@@ -0,0 +1,106 @@
+// Intersections.h
+#ifndef INTERSECTIONS_H
+#define INTERSECTIONS_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Scene.h"
+#include "Bvh.h"
+#include "Geometry.h"
+#include "ThreadPool.h"
+
+struct TrianglePair {
+	uint32_t a;   // primitive index in the frame
+	uint32_t b;   // primitive index in the frame, or overlay triangle index
+};
+
+struct IntersectionReport {
+	size_t frame = 0;
+	size_t triangles = 0;
+	std::vector<TrianglePair> framePairs;     // a < b
+	std::vector<TrianglePair> overlayPairs;   // (frame primitive, overlay triangle)
+	double seconds = 0.0;
+};
+
+// Overlay mesh triangles (in index order) as a BVH; built once per overlay.
+static inline std::shared_ptr<const TriangleBvh> buildMeshBvh(const std::vector<Primitive>& overlay) {
+	std::vector<glm::vec3> soup;
+	for (const auto& prim : overlay) {
+		if (prim.type != "overlaymesh") continue;
+		for (size_t i = 0; i + 2 < prim.indices.size(); i += 3)
+			for (int k = 0; k < 3; ++k)
+				soup.push_back(prim.vertices[prim.indices[i + k]].position);
+	}
+	auto bvh = std::make_shared<TriangleBvh>();
+	bvh->build(soup.data(), soup.size() / 3);
+	return bvh;
+}
+
+static inline bool sharesVertex(const glm::vec3* t, const glm::vec3* u) {
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			if (t[i] == u[j]) return true;
+	return false;
+}
+
+// All intersecting drawtriangle pairs of `frame`, and optionally between the
+// frame and `overlay`. Triangles sharing a vertex position are treated as
+// mesh neighbours and not reported. Work is split over `pool`.
+static inline IntersectionReport findTriangleIntersections(const Frame& frame, const TriangleBvh* overlay, ThreadPool& pool) {
+	auto t0 = std::chrono::steady_clock::now();
+	IntersectionReport report;
+
+	// The frame's triangle array is already a triangle soup
+	const Frame::TypeArrays& tris = frame.arrays(PrimType::Triangle);
+	const auto& primOf = tris.primitives;
+	report.triangles = primOf.size();
+
+	TriangleBvh bvh;
+	bvh.build(tris.positions.data(), primOf.size());
+
+	std::mutex merge;
+	pool.parallelFor(bvh.size(), 1024, [&](size_t begin, size_t end) {
+		std::vector<TrianglePair> local, localOverlay;
+		for (uint32_t slot = (uint32_t)begin; slot < (uint32_t)end; ++slot) {
+			const glm::vec3* t = bvh.triangle(slot);
+			AABB box;
+			box.expand(t[0]); box.expand(t[1]); box.expand(t[2]);
+
+			bvh.overlapping(box, [&](uint32_t other) {
+				if (other <= slot) return;   // each unordered pair once
+				const glm::vec3* u = bvh.triangle(other);
+				if (sharesVertex(t, u)) return;
+				if (geom::triTriOverlap(t[0], t[1], t[2], u[0], u[1], u[2])) {
+					uint32_t a = primOf[bvh.id(slot)], b = primOf[bvh.id(other)];
+					local.push_back({ std::min(a, b), std::max(a, b) });
+				}
+			});
+
+			if (overlay) {
+				overlay->overlapping(box, [&](uint32_t other) {
+					const glm::vec3* u = overlay->triangle(other);
+					if (sharesVertex(t, u)) return;
+					if (geom::triTriOverlap(t[0], t[1], t[2], u[0], u[1], u[2]))
+						localOverlay.push_back({ primOf[bvh.id(slot)], overlay->id(other) });
+				});
+			}
+		}
+		std::lock_guard<std::mutex> lock(merge);
+		report.framePairs.insert(report.framePairs.end(), local.begin(), local.end());
+		report.overlayPairs.insert(report.overlayPairs.end(), localOverlay.begin(), localOverlay.end());
+	});
+
+	auto byPair = [](const TrianglePair& x, const TrianglePair& y) { return x.a != y.a ? x.a < y.a : x.b < y.b; };
+	std::sort(report.framePairs.begin(), report.framePairs.end(), byPair);
+	std::sort(report.overlayPairs.begin(), report.overlayPairs.end(), byPair);
+
+	report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	return report;
+}
+
+#endif // INTERSECTIONS_H
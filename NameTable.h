@@ -0,0 +1,84 @@
+// NameTable.h
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Interned primitive names. Ids are dense (0..size()-1) and stay valid until clear().
+// intern() and find() lock; name() and size() do not, so list rows, labels and
+// search read names without contention while parser threads intern
+// (scenedebugger_query parses in parallel). Names live in chunks that double
+// in size and never move; a new name is published by storing the count with
+// release order, so any id below size() can be read.
+class NameTable {
+public:
+	NameTable() = default;
+	~NameTable() { clear(); }
+	NameTable(const NameTable&) = delete;
+	NameTable& operator=(const NameTable&) = delete;
+
+	uint32_t intern(std::string_view name) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = ids.find(name);
+		if (it != ids.end()) return it->second;
+		const uint32_t id = count.load(std::memory_order_relaxed);
+		uint32_t chunk, offset;
+		locate(id, chunk, offset);
+		std::string* names = chunks[chunk].load(std::memory_order_relaxed);
+		if (!names) {
+			names = new std::string[(size_t)kFirstChunk << chunk];
+			chunks[chunk].store(names, std::memory_order_release);
+		}
+		names[offset] = name;
+		ids.emplace(names[offset], id); // key views the chunk-owned string, which never moves
+		count.store(id + 1, std::memory_order_release);
+		return id;
+	}
+
+	// Returns UINT32_MAX when the name was never interned.
+	uint32_t find(std::string_view name) const {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = ids.find(name);
+		return it != ids.end() ? it->second : UINT32_MAX;
+	}
+
+	// `id` must be below size()
+	const std::string& name(uint32_t id) const {
+		uint32_t chunk, offset;
+		locate(id, chunk, offset);
+		return chunks[chunk].load(std::memory_order_acquire)[offset];
+	}
+	size_t size() const { return count.load(std::memory_order_acquire); }
+
+	// Not safe while other threads use the table.
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		ids.clear();
+		for (auto& c : chunks) delete[] c.exchange(nullptr);
+		count.store(0, std::memory_order_release);
+	}
+
+private:
+	static constexpr uint32_t kFirstChunk = 1024;
+	static constexpr int kChunks = 23;   // kFirstChunk * (2^23 - 1) covers every 32-bit id
+
+	// Chunk c holds ids [kFirstChunk * (2^c - 1), kFirstChunk * (2^(c+1) - 1))
+	static void locate(uint32_t id, uint32_t& chunk, uint32_t& offset) {
+		const uint64_t v = (uint64_t)id / kFirstChunk + 1;
+		chunk = 0;
+		while (v >> (chunk + 1)) ++chunk;
+		offset = id - kFirstChunk * ((1u << chunk) - 1);
+	}
+
+	mutable std::mutex mutex;   // intern, find and clear
+	std::atomic<std::string*> chunks[kChunks] = {};
+	std::atomic<uint32_t> count{ 0 };
+	std::unordered_map<std::string_view, uint32_t> ids;
+};
+
+#endif // NAME_TABLE_H
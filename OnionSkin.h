@@ -0,0 +1,92 @@
+// OnionSkin.h
+#ifndef ONION_SKIN_H
+#define ONION_SKIN_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include "FrameDrawBuffer.h"
+#include "FrameStore.h"
+#include "Profiler.h"
+#include "Shader.h"
+
+// Neighbouring frames drawn ghosted over the current one, earlier frames in
+// blue and later ones in orange, fading with distance. Each ghost is a
+// FrameDrawBuffer bound to its frame, so it draws from the shared block
+// pages in one tint, one multi-draw per page and type: geometry common to
+// neighbouring frames is on the GPU once, and stepping a frame uploads only
+// blocks not seen before. Ghosts
+// test against the current frame's depth but do not write it: geometry that
+// did not move fails the depth test and stays unghosted.
+class OnionSkin {
+public:
+	static constexpr int kMaxFrames = 10;   // on each side
+
+	OnionSkin() = default;
+	OnionSkin(const OnionSkin&) = delete;
+	OnionSkin& operator=(const OnionSkin&) = delete;
+
+	// Frames current - range … current + range, excluding current; `alpha` is the nearest ghosts' opacity.
+	void draw(Shader& shaderProgram, const FrameStore& frames, int current, int range, float alpha) {
+		profiler::Scope scope("onionSkin");
+		range = std::clamp(range, 1, kMaxFrames);
+		++clock;
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDepthMask(GL_FALSE);
+		glPointSize(5.0f);
+		// Farthest first, so nearer ghosts blend on top
+		for (int d = range; d >= 1; --d) {
+			const float a = alpha * (range + 1 - d) / range;
+			if (current - d >= 0)
+				ghost(frames, current - d).drawTinted(shaderProgram, glm::vec4(0.3f, 0.6f, 1.0f, a));
+			if (current + d < (int)frames.size())
+				ghost(frames, current + d).drawTinted(shaderProgram, glm::vec4(1.0f, 0.6f, 0.2f, a));
+		}
+		glPointSize(1.0f);
+		glDepthMask(GL_TRUE);
+		glDisable(GL_BLEND);
+		glBindVertexArray(0);
+	}
+
+	// Call when the capture is released, before FrameDrawBuffer::releaseBlocks().
+	void release() {
+		for (Ghost& g : ghosts) {
+			g.buffer.invalidate();
+			g.frame = -1;
+		}
+	}
+
+private:
+	static constexpr size_t kCacheSize = 2 * kMaxFrames + 4;
+
+	struct Ghost {
+		int frame = -1;
+		FrameDrawBuffer buffer;
+		uint64_t lastUse = 0;
+	};
+
+	// Buffer bound to frame f; the least recently drawn one is rebound when none is.
+	FrameDrawBuffer& ghost(const FrameStore& frames, int f) {
+		Ghost* g = nullptr;
+		for (Ghost& candidate : ghosts) {
+			if (candidate.frame == f) {
+				g = &candidate;
+				break;
+			}
+		}
+		if (!g) {
+			g = &*std::min_element(std::begin(ghosts), std::end(ghosts), [](const Ghost& a, const Ghost& b) { return a.lastUse < b.lastUse; });
+			g->buffer.bind(frames.get(f));
+			g->frame = f;
+		}
+		g->lastUse = clock;
+		return g->buffer;
+	}
+
+	Ghost ghosts[kCacheSize];
+	uint64_t clock = 0;
+};
+
+#endif // ONION_SKIN_H
@@ -0,0 +1,57 @@
+// Palette.h
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+
+// Stable "random" color from an integer id
+static inline uint32_t pcg_hash(uint32_t x) {
+	// PCG-inspired integer hash. Fast and decent distribution.
+	x ^= x >> 16;
+	x *= 0x7feb352dU;
+	x ^= x >> 15;
+	x *= 0x846ca68bU;
+	x ^= x >> 16;
+	return x;
+}
+
+static inline void hsv2rgb(float H, float S, float V, float& r, float& g, float& b) {
+	// H in [0,1), S,V in [0,1]
+	float h = H * 6.0f;
+	int i = (int)h;
+	float f = h - i;
+	float p = V * (1.0f - S);
+	float q = V * (1.0f - S * f);
+	float t = V * (1.0f - S * (1.0f - f));
+	switch (i % 6) {
+	case 0: r = V; g = t; b = p; break;
+	case 1: r = q; g = V; b = p; break;
+	case 2: r = p; g = V; b = t; break;
+	case 3: r = p; g = q; b = V; break;
+	case 4: r = t; g = p; b = V; break;
+	default: r = V; g = p; b = q; break;
+	}
+}
+
+// Optional: tweak to taste. Lower S gives more pastel, higher V gives brighter.
+static inline glm::vec4 stableColor(uint32_t id, float S = 0.65f, float V = 1.0f, float A = 1.0f) {
+	uint32_t h = pcg_hash(id);
+	// Use different hashed bits for hue/sat/val slight jitter (keeps variety)
+	float H = (h & 0xFFFFu) / 65535.0f;                 // hue in [0,1)
+	float sJit = ((h >> 16) & 0xFFu) / 255.0f * 0.10f;  // +/- 0.05 jitter
+	float vJit = ((h >> 24) & 0xFFu) / 255.0f * 0.10f;  // +/- 0.05 jitter
+	float r, g, b;
+	hsv2rgb(H, std::clamp(S - 0.05f + sJit, 0.3f, 0.9f),
+		std::clamp(V - 0.05f + vJit, 0.6f, 1.0f), r, g, b);
+	return glm::vec4(r, g, b, A);
+}
+
+// If you want separation by primitive type too, combine like this:
+template <class T>
+static inline uint32_t hashCombine32(uint32_t a, T b) {
+	return pcg_hash(a ^ (uint32_t)pcg_hash((uint32_t)b + 0x9e3779b9u + (a << 6) + (a >> 2)));
+}
+
+#endif // PALETTE_H
@@ -0,0 +1,88 @@
+// Picking.h
+#ifndef PICKING_H
+#define PICKING_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Ray tests used by mouse picking.
+
+// Distance from ray to segment (squared)
+static inline float raySegmentDist2(const glm::vec3& ro, const glm::vec3& rd,
+	const glm::vec3& a, const glm::vec3& b)
+{
+	// Based on closest points between two lines (ray and segment), clamped to segment.
+	const glm::vec3 u = rd;                 // normalized
+	const glm::vec3 v = b - a;              // segment direction
+	const glm::vec3 w0 = ro - a;
+	float aUU = glm::dot(u, u);             // =1, but keep general
+	float bUV = glm::dot(u, v);
+	float cVV = glm::dot(v, v);
+	float dUW0 = glm::dot(u, w0);
+	float eVW0 = glm::dot(v, w0);
+
+	float denom = aUU * cVV - bUV * bUV;
+	float sc = 0.f, tc = 0.f;
+	if (denom > 1e-12f) {
+		sc = (bUV * eVW0 - cVV * dUW0) / denom;   // along ray
+		tc = (aUU * eVW0 - bUV * dUW0) / denom;   // along segment
+	}
+	else {
+		// nearly parallel: project a→ray and clamp tc
+		sc = -dUW0 / aUU;
+		tc = 0.f;
+	}
+	tc = glm::clamp(tc, 0.f, 1.f);
+	// closest points
+	glm::vec3 Pc = ro + sc * u;
+	glm::vec3 Qc = a + tc * v;
+	return glm::dot(Pc - Qc, Pc - Qc);
+}
+
+// Distance from ray to point (squared)
+static inline float rayPointDist2(const glm::vec3& ro, const glm::vec3& rd, const glm::vec3& p)
+{
+	glm::vec3 w = p - ro;
+	float t = glm::dot(w, rd);          // along ray
+	glm::vec3 closest = ro + t * rd;
+	glm::vec3 d = p - closest;
+	return glm::dot(d, d);
+}
+
+// Convert a constant pixel radius to world units at depth d.
+// Assumes 45° vertical FOV like Camera::getProjectionMatrix.
+static inline float pixelRadiusToWorld(float pixels, float depth, int viewportHeight)
+{
+	// size of 1 pixel at depth d: (2 * d * tan(fov/2)) / H
+	const float fovY_deg = 45.0f;
+	const float fovY = glm::radians(fovY_deg);
+	float pixelWorld = (2.0f * depth * tanf(fovY * 0.5f)) / float(std::max(1, viewportHeight));
+	return pixels * pixelWorld;
+}
+
+// Möller-Trumbore
+static inline bool rayTriangleIntersect(const glm::vec3& orig, const glm::vec3& dir,
+	const glm::vec3& v0, const glm::vec3& v1,
+	const glm::vec3& v2, float& tOut)
+{
+	const float EPS = 1e-6f;
+	glm::vec3 e1 = v1 - v0;
+	glm::vec3 e2 = v2 - v0;
+	glm::vec3 p = glm::cross(dir, e2);
+	float det = glm::dot(e1, p);
+	if (fabs(det) < EPS) return false;
+	float invDet = 1.0f / det;
+	glm::vec3 t = orig - v0;
+	float u = glm::dot(t, p) * invDet;
+	if (u < 0.f || u > 1.f) return false;
+	glm::vec3 q = glm::cross(t, e1);
+	float v = glm::dot(dir, q) * invDet;
+	if (v < 0.f || u + v > 1.f) return false;
+	float tHit = glm::dot(e2, q) * invDet;
+	if (tHit < EPS) return false;
+	tOut = tHit;
+	return true;
+}
+
+#endif // PICKING_H
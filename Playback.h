@@ -0,0 +1,234 @@
+// Playback.h
+#ifndef PLAYBACK_H
+#define PLAYBACK_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "FrameDrawBuffer.h"
+#include "FrameStore.h"
+#include "ThreadPool.h"
+
+// Turns wall time into frame steps at fps * speed. When drawing falls
+// behind, frames are skipped so the capture keeps its pace.
+class PlaybackClock {
+public:
+	float fps = 30.0f;
+	float speed = 1.0f;
+	bool loop = true;
+
+	bool playing() const { return active; }
+	void play() {
+		active = true;
+		pending = 0.0;
+	}
+	void pause() { active = false; }
+	void toggle() { active ? pause() : play(); }
+
+	double rate() const { return std::max(0.0, (double)fps * speed); }
+
+	// Frame to show `seconds` after the previous call, coming from `current`.
+	// Without loop the clock stops on the last frame.
+	int advance(double seconds, int current, int frameCount) {
+		if (!active || frameCount <= 0) return current;
+		pending += std::min(seconds, 0.25) * rate();   // a stall (window drag) is not caught up
+		const int steps = (int)pending;
+		if (steps == 0) return current;
+		pending -= steps;
+		int next = current + steps;
+		if (next >= frameCount) {
+			if (loop) {
+				next %= frameCount;
+			}
+			else {
+				next = frameCount - 1;
+				active = false;
+			}
+		}
+		return next;
+	}
+
+private:
+	bool active = false;
+	double pending = 0.0;   // fractional frames
+};
+
+// Prepares the frames playback is about to show. Decoding (the store's
+// block decompression) and building vertex data run on the shared pool;
+// the GL thread only uploads finished blocks into FrameDrawBuffer's block
+// cache, at most `uploadBudget` bytes per update, so the setup of a heavy
+// frame is spread over the frames shown before it.
+class FramePrefetcher {
+public:
+	static constexpr size_t kUploadBudget = size_t(32) << 20;
+
+	FramePrefetcher() = default;
+	~FramePrefetcher() { reset(); }
+	FramePrefetcher(const FramePrefetcher&) = delete;
+	FramePrefetcher& operator=(const FramePrefetcher&) = delete;
+
+	// Call once per UI frame on the GL thread with the frame on screen;
+	// prepares up to `ahead` frames after it.
+	void update(FrameStore& store, int current, int ahead, bool loop, size_t uploadBudget = kUploadBudget) {
+		collect();
+
+		// Pinned frames are never evicted, so the window stays well inside the cache budget
+		const int count = (int)store.size();
+		wanted.clear();
+		uint64_t bytes = 0;
+		for (int k = 1; k <= ahead && k < count; ++k) {
+			int f = current + k;
+			if (f >= count) {
+				if (!loop) break;
+				f -= count;
+			}
+			bytes += store.decodedBytes(f);
+			if (k > 1 && bytes > store.budget() / 2) break;
+			wanted.push_back(f);
+		}
+		store.pin(current, 1, std::max<size_t>(1, wanted.size()));
+
+		for (auto it = entries.begin(); it != entries.end();)
+			it = std::find(wanted.begin(), wanted.end(), it->first) == wanted.end() ? entries.erase(it) : std::next(it);
+
+		// Nearest frames first at every stage; a few jobs per worker keep the pool busy between updates
+		const int maxJobs = 2 * (int)ThreadPool::shared().size() + 2;
+		for (int f : wanted) {
+			Entry& e = entries[f];
+			if (!e.frame) {
+				if (!e.decoding && jobs < maxJobs) decode(store, f, e);
+				continue;
+			}
+			if (e.ready) continue;
+			std::vector<size_t> missing;
+			for (size_t b = 0; b < e.frame->blockIds.size(); ++b) {
+				const uint32_t id = e.frame->blockIds[b];
+				if (FrameDrawBuffer::touchBlock(id) || queued.count(id)) continue;
+				missing.push_back(b);
+			}
+			if (!missing.empty() && jobs < maxJobs) build(e.frame, std::move(missing));
+		}
+
+		// Upload at least one block per call so progress never stalls on a large block
+		size_t uploaded = 0;
+		while (uploaded < uploadBudget && !built.empty()) {
+			uploaded += FrameDrawBuffer::uploadBlock(built.front());
+			queued.erase(built.front().block);
+			built.pop_front();
+		}
+
+		for (int f : wanted) {
+			Entry& e = entries[f];
+			if (!e.frame || e.ready) continue;
+			e.ready = std::all_of(e.frame->blockIds.begin(), e.frame->blockIds.end(), FrameDrawBuffer::touchBlock);
+		}
+	}
+
+	// True when frame f is decoded and all of its blocks are on the GPU.
+	bool ready(int f) const {
+		auto it = entries.find(f);
+		return it != entries.end() && it->second.ready;
+	}
+
+	// Frames currently being prepared, and how many of them are ready
+	size_t window() const { return wanted.size(); }
+	size_t readyCount() const {
+		size_t n = 0;
+		for (const auto& entry : entries) n += entry.second.ready;
+		return n;
+	}
+
+	bool active() const { return !entries.empty() || !wanted.empty() || jobs > 0; }
+
+	// Waits for the workers and drops every prepared frame; call before the store changes.
+	void reset() {
+		{
+			std::unique_lock<std::mutex> lock(shared->mutex);
+			shared->idle.wait(lock, [&] { return shared->jobs == 0; });
+			shared->decoded.clear();
+			shared->built.clear();
+		}
+		jobs = 0;
+		entries.clear();
+		wanted.clear();
+		built.clear();
+		queued.clear();
+	}
+
+private:
+	struct Entry {
+		FrameStore::FramePtr frame;
+		bool decoding = false;
+		bool ready = false;
+	};
+
+	// Results handed over by the workers
+	struct Shared {
+		std::mutex mutex;
+		std::condition_variable idle;
+		int jobs = 0;
+		std::vector<std::pair<int, FrameStore::FramePtr>> decoded;
+		std::vector<FrameDrawBuffer::BlockData> built;
+	};
+
+	void decode(const FrameStore& store, int f, Entry& e) {
+		e.decoding = true;
+		start();
+		ThreadPool::shared().submit([s = shared, &store, f] {
+			FrameStore::FramePtr frame = store.get(f);
+			std::lock_guard<std::mutex> lock(s->mutex);
+			s->decoded.emplace_back(f, std::move(frame));
+			--s->jobs;
+			s->idle.notify_all();
+		});
+	}
+
+	void build(const FrameStore::FramePtr& frame, std::vector<size_t> blocks) {
+		for (size_t b : blocks) queued.insert(frame->blockIds[b]);
+		start();
+		ThreadPool::shared().submit([s = shared, frame, blocks = std::move(blocks)] {
+			std::vector<FrameDrawBuffer::BlockData> data(blocks.size());
+			for (size_t i = 0; i < blocks.size(); ++i) FrameDrawBuffer::buildBlock(*frame, blocks[i], data[i]);
+			std::lock_guard<std::mutex> lock(s->mutex);
+			for (auto& d : data) s->built.push_back(std::move(d));
+			--s->jobs;
+			s->idle.notify_all();
+		});
+	}
+
+	void start() {
+		++jobs;
+		std::lock_guard<std::mutex> lock(shared->mutex);
+		++shared->jobs;
+	}
+
+	// Moves finished work over from the workers
+	void collect() {
+		std::lock_guard<std::mutex> lock(shared->mutex);
+		for (auto& result : shared->decoded) {
+			auto it = entries.find(result.first);
+			if (it == entries.end()) continue;   // left the window meanwhile
+			it->second.frame = std::move(result.second);
+			it->second.decoding = false;
+		}
+		shared->decoded.clear();
+		for (auto& d : shared->built) built.push_back(std::move(d));
+		shared->built.clear();
+		jobs = shared->jobs;
+	}
+
+	std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+	std::unordered_map<int, Entry> entries;
+	std::vector<int> wanted;                      // frames ahead, nearest first
+	std::deque<FrameDrawBuffer::BlockData> built;
+	std::unordered_set<uint32_t> queued;          // blocks being built or waiting for upload
+	int jobs = 0;
+};
+
+#endif // PLAYBACK_H
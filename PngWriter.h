@@ -0,0 +1,125 @@
+// PngWriter.h
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(SCENE_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+// Minimal RGBA8 PNG encoder for rendered frames. Rows use filter 0 and a
+// fast deflate level when zlib is available; without zlib the image data
+// goes into stored (uncompressed) deflate blocks, still a valid PNG.
+namespace png {
+
+static inline uint32_t crc32Of(const uint8_t* p, size_t n, uint32_t crc = 0) {
+#if defined(SCENE_HAVE_ZLIB)
+	return (uint32_t)::crc32(crc, p, (uInt)n);
+#else
+	static const auto table = [] {
+		std::vector<uint32_t> t(256);
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			t[i] = c;
+		}
+		return t;
+	}();
+	crc = ~crc;
+	for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+#endif
+}
+
+static inline void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+	out.push_back(uint8_t(v >> 24));
+	out.push_back(uint8_t(v >> 16));
+	out.push_back(uint8_t(v >> 8));
+	out.push_back(uint8_t(v));
+}
+
+static inline void chunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size) {
+	putBE32(out, (uint32_t)size);
+	const size_t start = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data, data + size);
+	putBE32(out, crc32Of(out.data() + start, size + 4));
+}
+
+// Zlib stream of `raw` made of stored blocks
+static inline void storedZlib(const std::vector<uint8_t>& raw, std::vector<uint8_t>& out) {
+	out.clear();
+	out.push_back(0x78);
+	out.push_back(0x01);
+	size_t at = 0;
+	do {
+		const size_t n = std::min<size_t>(65535, raw.size() - at);
+		out.push_back(at + n == raw.size() ? 1 : 0);
+		out.push_back(uint8_t(n));
+		out.push_back(uint8_t(n >> 8));
+		out.push_back(uint8_t(~n));
+		out.push_back(uint8_t(~n >> 8));
+		out.insert(out.end(), raw.begin() + at, raw.begin() + at + n);
+		at += n;
+	} while (at < raw.size());
+	uint32_t a = 1, b = 0;
+	for (uint8_t v : raw) {
+		a = (a + v) % 65521;
+		b = (b + a) % 65521;
+	}
+	putBE32(out, (b << 16) | a);
+}
+
+// `rgba` holds height rows of width * 4 bytes, `stride` apart; with
+// flipY the last row is written first (OpenGL readback order).
+static inline void encode(const uint8_t* rgba, int width, int height, size_t stride, bool flipY, std::vector<uint8_t>& out) {
+	std::vector<uint8_t> raw((size_t)height * (1 + (size_t)width * 4));
+	for (int y = 0; y < height; ++y) {
+		const uint8_t* row = rgba + (size_t)(flipY ? height - 1 - y : y) * stride;
+		uint8_t* dst = &raw[(size_t)y * (1 + (size_t)width * 4)];
+		dst[0] = 0;   // filter: none
+		std::copy(row, row + (size_t)width * 4, dst + 1);
+	}
+
+	std::vector<uint8_t> packed;
+#if defined(SCENE_HAVE_ZLIB)
+	uLongf size = compressBound((uLong)raw.size());
+	packed.resize(size);
+	if (compress2(packed.data(), &size, raw.data(), (uLong)raw.size(), 1) == Z_OK)
+		packed.resize(size);
+	else
+		storedZlib(raw, packed);
+#else
+	storedZlib(raw, packed);
+#endif
+
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	out.assign(signature, signature + 8);
+	std::vector<uint8_t> header;
+	putBE32(header, (uint32_t)width);
+	putBE32(header, (uint32_t)height);
+	header.push_back(8);   // bit depth
+	header.push_back(6);   // RGBA
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	chunk(out, "IHDR", header.data(), header.size());
+	chunk(out, "IDAT", packed.data(), packed.size());
+	chunk(out, "IEND", nullptr, 0);
+}
+
+static inline bool writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+	std::FILE* f = std::fopen(path.c_str(), "wb");
+	if (!f) return false;
+	const bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+	return std::fclose(f) == 0 && ok;
+}
+
+} // namespace png
+
+#endif // PNG_WRITER_H
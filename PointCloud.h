@@ -0,0 +1,151 @@
+// PointCloud.h
+#ifndef POINT_CLOUD_H
+#define POINT_CLOUD_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "PointOctree.h"
+#include "Profiler.h"
+#include "Shader.h"
+
+// Draws a PointOctree with colors per point. Each frame the octree nodes for
+// the view are selected, nodes already on the GPU are drawn and missing ones
+// are streamed in, at most `uploadBudget` bytes per frame (coarse nodes come
+// first, so the cloud refines over a few frames instead of stalling). Node
+// buffers are kept in an LRU bounded by `gpuBudget` bytes.
+class PointCloudRenderer {
+public:
+	size_t pointBudget = 4000000;                 // points drawn per frame
+	float maxErrorPx = 1.5f;                      // projected point spacing at which nodes stop refining
+	size_t uploadBudget = size_t(16) << 20;       // per frame
+	size_t gpuBudget = size_t(256) << 20;
+
+	struct Stats {
+		size_t nodes = 0, points = 0;    // drawn last frame
+		size_t missing = 0;              // selected but not on the GPU yet
+		size_t residentBytes = 0;
+	};
+
+	PointCloudRenderer() = default;
+	~PointCloudRenderer() { release(); }
+	PointCloudRenderer(const PointCloudRenderer&) = delete;
+	PointCloudRenderer& operator=(const PointCloudRenderer&) = delete;
+
+	// The octree of frame `frame`; replacing it drops the node buffers.
+	void setOctree(std::shared_ptr<const PointOctree> tree, int frame) {
+		releaseNodes();
+		octree = std::move(tree);
+		octreeFrame = frame;
+	}
+
+	const std::shared_ptr<const PointOctree>& tree() const { return octree; }
+	int frame() const { return octree ? octreeFrame : -1; }
+
+	void draw(Shader& shaderProgram, const PointOctree::View& view, float pointSize) {
+		profiler::Scope scope("pointCloud");
+		stats.nodes = stats.points = stats.missing = 0;
+		if (!octree) return;
+		octree->select(view, maxErrorPx, pointBudget, selected);
+
+		++clock;
+		size_t uploaded = 0;
+		shaderProgram.setBool("useLighting", false);
+		shaderProgram.setBool("useVertexColor", true);
+		glPointSize(pointSize);
+		for (uint32_t index : selected) {
+			auto it = nodes.find(index);
+			if (it == nodes.end()) {
+				if (uploaded >= uploadBudget) {
+					++stats.missing;
+					continue;
+				}
+				it = nodes.emplace(index, upload(octree->nodes()[index])).first;
+				uploaded += it->second.bytes;
+			}
+			GpuNode& gpu = it->second;
+			gpu.lastUse = clock;
+			glBindVertexArray(gpu.vao);
+			glDrawArrays(GL_POINTS, 0, (GLsizei)octree->nodes()[index].count);
+			profiler::countDraw();
+			++stats.nodes;
+			stats.points += octree->nodes()[index].count;
+		}
+		glPointSize(1.0f);
+		shaderProgram.setBool("useVertexColor", false);
+		glBindVertexArray(0);
+		evict();
+		stats.residentBytes = residentBytes;
+	}
+
+	const Stats& lastStats() const { return stats; }
+
+	void release() {
+		releaseNodes();
+		octree.reset();
+		octreeFrame = -1;
+	}
+
+private:
+	struct GpuNode {
+		GLuint vao = 0, vbo = 0;
+		size_t bytes = 0;
+		uint64_t lastUse = 0;
+	};
+
+	GpuNode upload(const PointOctree::Node& node) {
+		GpuNode gpu;
+		gpu.bytes = node.count * sizeof(PointOctree::Point);
+		glGenVertexArrays(1, &gpu.vao);
+		glGenBuffers(1, &gpu.vbo);
+		glBindVertexArray(gpu.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, gpu.vbo);
+		glBufferData(GL_ARRAY_BUFFER, gpu.bytes, octree->points().data() + node.first, GL_STATIC_DRAW);
+		profiler::countUpload(gpu.bytes);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PointOctree::Point), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PointOctree::Point), (void*)offsetof(PointOctree::Point, color));
+		glEnableVertexAttribArray(2);
+		residentBytes += gpu.bytes;
+		return gpu;
+	}
+
+	static void destroy(GpuNode& gpu) {
+		glDeleteBuffers(1, &gpu.vbo);
+		glDeleteVertexArrays(1, &gpu.vao);
+	}
+
+	// Least recently drawn nodes go first; nodes drawn this frame are kept.
+	void evict() {
+		while (residentBytes > gpuBudget) {
+			auto victim = nodes.end();
+			for (auto it = nodes.begin(); it != nodes.end(); ++it)
+				if (it->second.lastUse < clock && (victim == nodes.end() || it->second.lastUse < victim->second.lastUse))
+					victim = it;
+			if (victim == nodes.end()) return;
+			residentBytes -= victim->second.bytes;
+			destroy(victim->second);
+			nodes.erase(victim);
+		}
+	}
+
+	void releaseNodes() {
+		for (auto& entry : nodes) destroy(entry.second);
+		nodes.clear();
+		residentBytes = 0;
+	}
+
+	std::shared_ptr<const PointOctree> octree;
+	int octreeFrame = -1;
+	std::unordered_map<uint32_t, GpuNode> nodes;   // by octree node index
+	std::vector<uint32_t> selected;
+	size_t residentBytes = 0;
+	uint64_t clock = 0;
+	Stats stats;
+};
+
+#endif // POINT_CLOUD_H
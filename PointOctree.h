@@ -0,0 +1,272 @@
+// PointOctree.h
+#ifndef POINT_OCTREE_H
+#define POINT_OCTREE_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "Bounds.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+
+// Level-of-detail octree over the points of a frame, for captures that are
+// point clouds with millions of drawpoints. Every point lives in exactly one
+// node: a node keeps the first point falling into each cell of a kGrid^3
+// grid over its cube and passes the rest down to its octants. Nodes near the
+// root are thus an even subsample of the whole cloud, each level doubles the
+// density, and drawing any top part of the tree shows the cloud at the
+// density of its deepest nodes. select() picks that part for a view.
+// Points are copied out of the frame, so the frame can be released.
+class PointOctree {
+public:
+	static constexpr int kGrid = 32;                  // sampling cells per node axis
+	static constexpr uint32_t kLeafPoints = 8192;     // smaller nodes are not split
+	static constexpr uint32_t kMaxDepth = 20;
+
+	// As uploaded: position and RGBA8 color (see packColor)
+	struct Point {
+		glm::vec3 position;
+		uint32_t color;
+	};
+
+	struct Node {
+		glm::vec3 min;                     // cube corner
+		float size = 0.0f;                 // cube edge
+		uint32_t first = 0, count = 0;     // the node's points in points()
+		int32_t child[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+		uint32_t depth = 0;
+
+		float spacing() const { return size / kGrid; }
+		glm::vec3 center() const { return min + glm::vec3(size * 0.5f); }
+	};
+
+	// Camera for select(); pixelsPerUnit is the viewport height over 2 tan(fovy / 2).
+	struct View {
+		glm::mat4 viewProjection;
+		glm::vec3 eye;
+		float pixelsPerUnit;
+	};
+
+	PointOctree() = default;
+	explicit PointOctree(const Frame& frame) { build(frame); }
+
+	// The root is split here and its octants are built on the shared pool.
+	void build(const Frame& frame) {
+		nodeList.clear();
+		pointList.clear();
+		const Frame::TypeArrays& points = frame.arrays(PrimType::Point);
+		const uint32_t n = (uint32_t)points.size();
+		if (n == 0) return;
+
+		AABB box;
+		for (const glm::vec3& p : points.positions) box.expand(p);
+		const glm::vec3 extent = box.max - box.min;
+		Node root;
+		root.min = box.min;
+		root.size = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f)) * 1.0001f;
+
+		Scratch work(n);
+		if (n <= kLeafPoints) {
+			buildSubtree(points, work, root, 0, n, nodeList, pointList);
+			return;
+		}
+
+		uint32_t start[9], counts[9];
+		std::vector<uint8_t> taken((size_t)kGrid * kGrid * kGrid);
+		split(points, work, taken, root, 0, n, start, counts);
+		struct Subtree {
+			std::vector<Node> nodes;
+			std::vector<Point> points;
+		};
+		Subtree children[8];
+		ThreadPool::shared().parallelFor(8, 1, [&](size_t b, size_t e) {
+			for (size_t c = b; c < e; ++c) {
+				if (counts[c] == 0) continue;
+				children[c].points.reserve(counts[c]);
+				buildSubtree(points, work, childOf(root, (int)c), start[c], start[c] + counts[c], children[c].nodes, children[c].points);
+			}
+		});
+
+		pointList.reserve(n);
+		appendTo(points, work, start[8], start[8] + counts[8], pointList);
+		root.first = 0;
+		root.count = counts[8];
+		nodeList.push_back(root);
+		for (int c = 0; c < 8; ++c) {
+			if (children[c].nodes.empty()) continue;
+			const int32_t nodeBase = (int32_t)nodeList.size();
+			const uint32_t pointBase = (uint32_t)pointList.size();
+			nodeList[0].child[c] = nodeBase;
+			for (Node node : children[c].nodes) {
+				node.first += pointBase;
+				for (int32_t& k : node.child)
+					if (k >= 0) k += nodeBase;
+				nodeList.push_back(node);
+			}
+			pointList.insert(pointList.end(), children[c].points.begin(), children[c].points.end());
+		}
+	}
+
+	const std::vector<Node>& nodes() const { return nodeList; }
+	const std::vector<Point>& points() const { return pointList; }
+	size_t pointCount() const { return pointList.size(); }
+	bool empty() const { return pointList.empty(); }
+
+	// Nodes to draw for `view`, coarsest first. A node's children are visited
+	// while its point spacing projects to more than `maxErrorPx` pixels, the
+	// largest errors first, until `pointBudget` points are selected. Nodes
+	// outside the frustum are skipped. Returns the selected point count.
+	size_t select(const View& view, float maxErrorPx, size_t pointBudget, std::vector<uint32_t>& out) const {
+		out.clear();
+		if (nodeList.empty()) return 0;
+		glm::vec4 planes[6];
+		frustumPlanes(view.viewProjection, planes);
+
+		std::priority_queue<std::pair<float, uint32_t>> queue;
+		if (visible(nodeList[0], planes)) queue.push({ projectedSpacing(nodeList[0], view), 0u });
+		size_t selected = 0;
+		while (!queue.empty()) {
+			const auto [error, index] = queue.top();
+			queue.pop();
+			const Node& node = nodeList[index];
+			if (selected + node.count > pointBudget && !out.empty()) break;
+			out.push_back(index);
+			selected += node.count;
+			if (error <= maxErrorPx) continue;
+			for (int32_t c : node.child)
+				if (c >= 0 && visible(nodeList[c], planes))
+					queue.push({ projectedSpacing(nodeList[c], view), (uint32_t)c });
+		}
+		return selected;
+	}
+
+	size_t memoryUsage() const {
+		return nodeList.capacity() * sizeof(Node) + pointList.capacity() * sizeof(Point);
+	}
+
+private:
+	// Per point working arrays of a build, indexed by position in `order`
+	struct Scratch {
+		std::vector<uint32_t> order, sorted;
+		std::vector<uint8_t> octant;
+
+		explicit Scratch(uint32_t n) : order(n), sorted(n), octant(n) {
+			std::iota(order.begin(), order.end(), 0u);
+		}
+	};
+
+	static Node childOf(const Node& node, int c) {
+		Node child;
+		child.size = node.size * 0.5f;
+		child.min = node.min + glm::vec3(c & 1 ? child.size : 0.0f, c & 2 ? child.size : 0.0f, c & 4 ? child.size : 0.0f);
+		child.depth = node.depth + 1;
+		return child;
+	}
+
+	// Reorders order[begin, end) into the points kept by `node` (start[8]) followed
+	// by those of each octant (start[0..7]).
+	static void split(const Frame::TypeArrays& points, Scratch& work, std::vector<uint8_t>& taken,
+		const Node& node, uint32_t begin, uint32_t end, uint32_t* start, uint32_t* counts) {
+		std::fill(taken.begin(), taken.end(), 0);
+		const float cellsPerUnit = kGrid / node.size;
+		const glm::vec3 center = node.center();
+		std::fill(counts, counts + 9, 0u);
+		auto cell = [&](float v, float lo) { return std::clamp((int)((v - lo) * cellsPerUnit), 0, kGrid - 1); };
+		for (uint32_t k = begin; k < end; ++k) {
+			const glm::vec3& p = points.positions[work.order[k]];
+			uint8_t& t = taken[((size_t)cell(p.x, node.min.x) * kGrid + cell(p.y, node.min.y)) * kGrid + cell(p.z, node.min.z)];
+			uint8_t c = 8;
+			if (t) c = uint8_t((p.x >= center.x) | (p.y >= center.y) << 1 | (p.z >= center.z) << 2);
+			t = 1;
+			work.octant[k] = c;
+			++counts[c];
+		}
+
+		start[8] = begin;
+		for (uint32_t c = 0, at = begin + counts[8]; c < 8; at += counts[c++]) start[c] = at;
+		uint32_t next[9];
+		std::copy(start, start + 9, next);
+		for (uint32_t k = begin; k < end; ++k) work.sorted[next[work.octant[k]]++] = work.order[k];
+		std::copy(work.sorted.begin() + begin, work.sorted.begin() + end, work.order.begin() + begin);
+	}
+
+	static void appendTo(const Frame::TypeArrays& points, const Scratch& work, uint32_t begin, uint32_t end, std::vector<Point>& out) {
+		for (uint32_t k = begin; k < end; ++k)
+			out.push_back({ points.positions[work.order[k]], points.colors[work.order[k]] });
+	}
+
+	// Nodes of the subtree under `root` (points order[begin, end)), root first
+	static void buildSubtree(const Frame::TypeArrays& points, Scratch& work, const Node& root, uint32_t begin, uint32_t end,
+		std::vector<Node>& nodes, std::vector<Point>& out) {
+		std::vector<uint8_t> taken;
+		struct Work {
+			uint32_t node, begin, end;
+		};
+		nodes.push_back(root);
+		std::vector<Work> stack{ { 0, begin, end } };
+		while (!stack.empty()) {
+			const Work w = stack.back();
+			stack.pop_back();
+			const Node node = nodes[w.node];
+			nodes[w.node].first = (uint32_t)out.size();
+
+			if (w.end - w.begin <= kLeafPoints || node.depth >= kMaxDepth) {
+				appendTo(points, work, w.begin, w.end, out);
+				nodes[w.node].count = w.end - w.begin;
+				continue;
+			}
+
+			if (taken.empty()) taken.resize((size_t)kGrid * kGrid * kGrid);
+			uint32_t start[9], counts[9];
+			split(points, work, taken, node, w.begin, w.end, start, counts);
+			appendTo(points, work, start[8], start[8] + counts[8], out);
+			nodes[w.node].count = counts[8];
+			for (int c = 0; c < 8; ++c) {
+				if (counts[c] == 0) continue;
+				nodes[w.node].child[c] = (int32_t)nodes.size();
+				stack.push_back({ (uint32_t)nodes.size(), start[c], start[c] + counts[c] });
+				nodes.push_back(childOf(node, c));
+			}
+		}
+	}
+
+	static float projectedSpacing(const Node& node, const View& view) {
+		const float radius = node.size * 0.8660254f;
+		const float distance = std::max(glm::length(node.center() - view.eye) - radius, node.size * 1e-3f);
+		return node.spacing() * view.pixelsPerUnit / distance;
+	}
+
+	// Plane i as (normal, offset), inside where dot(normal, p) + offset >= 0
+	static void frustumPlanes(const glm::mat4& m, glm::vec4* planes) {
+		auto row = [&](int r) { return glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]); };
+		const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+		planes[0] = r3 + r0;
+		planes[1] = r3 - r0;
+		planes[2] = r3 + r1;
+		planes[3] = r3 - r1;
+		planes[4] = r3 + r2;
+		planes[5] = r3 - r2;
+	}
+
+	static bool visible(const Node& node, const glm::vec4* planes) {
+		for (int i = 0; i < 6; ++i) {
+			const glm::vec4& pl = planes[i];
+			// Corner farthest along the plane normal
+			const glm::vec3 p(node.min.x + (pl.x >= 0.0f ? node.size : 0.0f),
+				node.min.y + (pl.y >= 0.0f ? node.size : 0.0f),
+				node.min.z + (pl.z >= 0.0f ? node.size : 0.0f));
+			if (pl.x * p.x + pl.y * p.y + pl.z * p.z + pl.w < 0.0f) return false;
+		}
+		return true;
+	}
+
+	std::vector<Node> nodeList;
+	std::vector<Point> pointList;   // grouped by node
+};
+
+#endif // POINT_OCTREE_H
@@ -0,0 +1,56 @@
+// PositionBuffer.h
+#ifndef POSITION_BUFFER_H
+#define POSITION_BUFFER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Profiler.h"
+
+// Bare positions (attribute 0) in one VAO/VBO, uploaded when the data they
+// come from changes and drawn from the GPU copy in between (highlighted
+// overlay triangles, the trajectory path).
+class PositionBuffer {
+public:
+	void upload(const std::vector<glm::vec3>& positions) {
+		if (vao == 0) {
+			glGenVertexArrays(1, &vao);
+			glGenBuffers(1, &vbo);
+			glBindVertexArray(vao);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+			glEnableVertexAttribArray(0);
+			glBindVertexArray(0);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		profiler::countUpload(positions.size() * sizeof(glm::vec3));
+		count = (GLsizei)positions.size();
+	}
+
+	// Leaves the VAO bound; callers unbind once done drawing.
+	void draw(GLenum mode) const {
+		if (count == 0) return;
+		glBindVertexArray(vao);
+		glDrawArrays(mode, 0, count);
+		profiler::countDraw();
+	}
+
+	GLsizei size() const { return count; }
+
+	// Call with the GL context current.
+	void release() {
+		if (vao == 0) return;
+		glDeleteBuffers(1, &vbo);
+		glDeleteVertexArrays(1, &vao);
+		vao = vbo = 0;
+		count = 0;
+	}
+
+private:
+	GLuint vao = 0, vbo = 0;
+	GLsizei count = 0;
+};
+
+#endif // POSITION_BUFFER_H
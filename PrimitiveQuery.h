@@ -0,0 +1,576 @@
+// PrimitiveQuery.h
+#ifndef PRIMITIVE_QUERY_H
+#define PRIMITIVE_QUERY_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Scene.h"
+#include "Geometry.h"
+#include "SearchIndex.h"
+
+// Filter and aggregate expressions over the primitives of a frame, used by
+// scenedebugger_query. A filter is a boolean expression such as
+//   type == box && name ~ "wheel*" && contains(1, 2, 3)
+// and aggregates are count, sum(e), min(e), max(e) and avg(e) over the
+// primitives that pass it, per frame, name, type or the whole capture.
+namespace query {
+
+// A number or a string; strings point into the name table or the expression
+struct Value {
+	double num = 0.0;
+	const std::string* str = nullptr;
+
+	bool isString() const { return str != nullptr; }
+	bool truthy() const { return str ? !str->empty() : num != 0.0; }
+};
+
+// The primitive an expression is evaluated for
+struct Subject {
+	const Frame* frame = nullptr;
+	size_t index = 0;
+	uint64_t frameNumber = 0;
+};
+
+enum class Field {
+	Type, Name, Frame, Index, Vertices, X, Y, Z, MinX, MinY, MinZ, MaxX, MaxY, MaxZ,
+	Size, Area, Length, R, G, B, A, Degenerate, Count
+};
+static const char* const kFieldNames[(int)Field::Count] = {
+	"type", "name", "frame", "index", "vertices", "x", "y", "z", "minx", "miny", "minz", "maxx", "maxy", "maxz",
+	"size", "area", "length", "r", "g", "b", "a", "degenerate"
+};
+
+enum class Func { Contains, Overlaps, Dist, Abs, Sqrt, Min, Max };
+struct FuncInfo {
+	const char* name;
+	Func func;
+	int minArgs, maxArgs;
+};
+static const FuncInfo kFuncs[] = {
+	{ "contains", Func::Contains, 3, 4 },   // bounds contain (x, y, z) [within eps]
+	{ "overlaps", Func::Overlaps, 6, 6 },   // bounds overlap the box (minx, miny, minz, maxx, maxy, maxz)
+	{ "dist", Func::Dist, 3, 3 },           // exact distance to (x, y, z)
+	{ "abs", Func::Abs, 1, 1 },
+	{ "sqrt", Func::Sqrt, 1, 1 },
+	{ "min", Func::Min, 2, 2 },
+	{ "max", Func::Max, 2, 2 },
+};
+
+static inline double triangleArea(const glm::vec3* p) {
+	const geom::DVec3 a{ p[0].x, p[0].y, p[0].z };
+	const geom::DVec3 ab{ p[1].x - a.x, p[1].y - a.y, p[1].z - a.z };
+	const geom::DVec3 ac{ p[2].x - a.x, p[2].y - a.y, p[2].z - a.z };
+	const geom::DVec3 n = geom::cross(ab, ac);
+	return 0.5 * std::sqrt(geom::dot(n, n));
+}
+
+// Zero area triangles, zero length lines, inverted or flat boxes and any
+// non-finite coordinate.
+static inline bool isDegenerate(const Frame& frame, size_t i) {
+	const glm::vec3* p = frame.positions(i);
+	for (uint32_t k = 0; k < frame.vertexCount(i); ++k)
+		if (!std::isfinite(p[k].x) || !std::isfinite(p[k].y) || !std::isfinite(p[k].z)) return true;
+	switch (frame.type(i)) {
+	case PrimType::Triangle: {
+		const double longest = std::max({ glm::length(p[1] - p[0]), glm::length(p[2] - p[1]), glm::length(p[0] - p[2]) });
+		return triangleArea(p) <= 1e-7 * longest * longest;
+	}
+	case PrimType::Line: return p[0] == p[1];
+	case PrimType::Box: return !(p[0].x < p[1].x && p[0].y < p[1].y && p[0].z < p[1].z);
+	default: return false;
+	}
+}
+
+static inline double primitiveDistance(const Frame& frame, size_t i, const glm::vec3& q) {
+	const glm::vec3* p = frame.positions(i);
+	switch (frame.type(i)) {
+	case PrimType::Triangle: return glm::length(q - geom::closestPointOnTriangle(q, p[0], p[1], p[2]));
+	case PrimType::Line: {
+		const glm::vec3 d = p[1] - p[0];
+		const float len2 = glm::dot(d, d);
+		const float t = len2 > 0.0f ? std::clamp(glm::dot(q - p[0], d) / len2, 0.0f, 1.0f) : 0.0f;
+		return glm::length(q - (p[0] + d * t));
+	}
+	case PrimType::Box: {
+		AABB box;
+		box.expand(p[0]);
+		box.expand(p[1]);
+		return std::sqrt(box.distance2(q));
+	}
+	default: return glm::length(q - p[0]);
+	}
+}
+
+class Expr {
+public:
+	// An empty text compiles to an expression that accepts everything.
+	bool compile(const std::string& text, std::string& error) {
+		nodes.clear();
+		src = text;
+		pos = 0;
+		error.clear();
+		skipSpace();
+		if (pos == src.size()) return true;
+		root = parseOr(error);
+		if (error.empty() && (skipSpace(), pos != src.size())) fail(error, "unexpected input");
+		if (!error.empty()) nodes.clear();
+		return error.empty();
+	}
+
+	bool empty() const { return nodes.empty(); }
+	Value eval(const Subject& s) const { return nodes.empty() ? Value{ 1.0 } : eval(root, s); }
+	bool test(const Subject& s) const { return nodes.empty() || eval(root, s).truthy(); }
+
+private:
+	enum class Op : uint8_t { Num, Str, Field, Call, Neg, Not, And, Or, Add, Sub, Mul, Div, Eq, Ne, Lt, Le, Gt, Ge, Glob };
+
+	struct Node {
+		explicit Node(Op o) : op(o) {}
+
+		Op op;
+		double num = 0.0;
+		std::string str;
+		int index = 0;              // Field or Func
+		int a = -1, b = -1;
+		std::vector<int> args;
+	};
+
+	int add(Node n) {
+		nodes.push_back(std::move(n));
+		return (int)nodes.size() - 1;
+	}
+
+	void fail(std::string& error, const char* what) const {
+		if (error.empty()) error = std::string(what) + " at column " + std::to_string(pos + 1);
+	}
+
+	void skipSpace() {
+		while (pos < src.size() && std::isspace((unsigned char)src[pos])) ++pos;
+	}
+
+	bool accept(const char* token) {
+		skipSpace();
+		const size_t n = std::char_traits<char>::length(token);
+		if (src.compare(pos, n, token) != 0) return false;
+		// Keywords must not run into an identifier
+		if (std::isalpha((unsigned char)token[0]) && pos + n < src.size() && (std::isalnum((unsigned char)src[pos + n]) || src[pos + n] == '_')) return false;
+		pos += n;
+		return true;
+	}
+
+	int binary(Op op, int a, int b) {
+		Node n{ op };
+		n.a = a;
+		n.b = b;
+		return add(std::move(n));
+	}
+
+	int parseOr(std::string& error) {
+		int left = parseAnd(error);
+		while (error.empty() && (accept("||") || accept("or"))) left = binary(Op::Or, left, parseAnd(error));
+		return left;
+	}
+
+	int parseAnd(std::string& error) {
+		int left = parseNot(error);
+		while (error.empty() && (accept("&&") || accept("and"))) left = binary(Op::And, left, parseNot(error));
+		return left;
+	}
+
+	int parseNot(std::string& error) {
+		if (accept("not") || (skipSpace(), src.compare(pos, 2, "!=") != 0 && accept("!"))) return binary(Op::Not, parseNot(error), -1);
+		return parseCompare(error);
+	}
+
+	int parseCompare(std::string& error) {
+		int left = parseSum(error);
+		static const struct { const char* token; Op op; } ops[] = {
+			{ "==", Op::Eq }, { "!=", Op::Ne }, { "<=", Op::Le }, { ">=", Op::Ge }, { "<", Op::Lt }, { ">", Op::Gt }, { "~", Op::Glob },
+		};
+		for (const auto& o : ops)
+			if (error.empty() && accept(o.token)) return binary(o.op, left, parseSum(error));
+		return left;
+	}
+
+	int parseSum(std::string& error) {
+		int left = parseProduct(error);
+		for (;;) {
+			if (!error.empty()) return left;
+			if (accept("+")) left = binary(Op::Add, left, parseProduct(error));
+			else if (accept("-")) left = binary(Op::Sub, left, parseProduct(error));
+			else return left;
+		}
+	}
+
+	int parseProduct(std::string& error) {
+		int left = parseUnary(error);
+		for (;;) {
+			if (!error.empty()) return left;
+			if (accept("*")) left = binary(Op::Mul, left, parseUnary(error));
+			else if (accept("/")) left = binary(Op::Div, left, parseUnary(error));
+			else return left;
+		}
+	}
+
+	int parseUnary(std::string& error) {
+		if (accept("-")) return binary(Op::Neg, parseUnary(error), -1);
+		return parsePrimary(error);
+	}
+
+	int parsePrimary(std::string& error) {
+		skipSpace();
+		if (pos == src.size()) {
+			fail(error, "unexpected end");
+			return -1;
+		}
+		const char c = src[pos];
+		if (accept("(")) {
+			const int inner = parseOr(error);
+			if (error.empty() && !accept(")")) fail(error, "expected ')'");
+			return inner;
+		}
+		if (c == '"') {
+			Node n{ Op::Str };
+			for (++pos; pos < src.size() && src[pos] != '"'; ++pos) {
+				if (src[pos] == '\\' && pos + 1 < src.size()) ++pos;
+				n.str += src[pos];
+			}
+			if (pos == src.size()) {
+				fail(error, "unterminated string");
+				return -1;
+			}
+			++pos;
+			return add(std::move(n));
+		}
+		if (std::isdigit((unsigned char)c) || c == '.') {
+			char* end = nullptr;
+			Node n{ Op::Num };
+			n.num = std::strtod(src.c_str() + pos, &end);
+			pos = end - src.c_str();
+			return add(std::move(n));
+		}
+		if (std::isalpha((unsigned char)c) || c == '_') {
+			const size_t start = pos;
+			while (pos < src.size() && (std::isalnum((unsigned char)src[pos]) || src[pos] == '_')) ++pos;
+			const std::string word = src.substr(start, pos - start);
+			if (accept("(")) return parseCall(word, start, error);
+			for (int t = 0; t < (int)PrimType::Count; ++t)
+				if (word == primTypeName(PrimType(t)) + 4) {   // "triangle", "line", ... without "draw"
+					Node n{ Op::Str };
+					n.str = word;
+					return add(std::move(n));
+				}
+			for (int f = 0; f < (int)Field::Count; ++f)
+				if (word == kFieldNames[f]) {
+					Node n{ Op::Field };
+					n.index = f;
+					return add(std::move(n));
+				}
+			pos = start;
+			fail(error, ("unknown name '" + word + "'").c_str());
+			return -1;
+		}
+		fail(error, "unexpected character");
+		return -1;
+	}
+
+	int parseCall(const std::string& word, size_t start, std::string& error) {
+		Node n{ Op::Call };
+		n.index = -1;
+		for (size_t k = 0; k < sizeof(kFuncs) / sizeof(kFuncs[0]); ++k)
+			if (word == kFuncs[k].name) n.index = (int)k;
+		if (n.index < 0) {
+			pos = start;
+			fail(error, ("unknown function '" + word + "'").c_str());
+			return -1;
+		}
+		if (!accept(")")) {
+			do n.args.push_back(parseOr(error));
+			while (error.empty() && accept(","));
+			if (error.empty() && !accept(")")) fail(error, "expected ')'");
+		}
+		const FuncInfo& f = kFuncs[n.index];
+		if (error.empty() && ((int)n.args.size() < f.minArgs || (int)n.args.size() > f.maxArgs)) {
+			pos = start;
+			fail(error, ("wrong argument count for " + word).c_str());
+		}
+		return add(std::move(n));
+	}
+
+	static Value number(double v) { return Value{ v }; }
+
+	double num(int node, const Subject& s) const { return eval(node, s).num; }
+
+	Value field(Field f, const Subject& s) const {
+		const Frame& frame = *s.frame;
+		const size_t i = s.index;
+		switch (f) {
+		case Field::Type: return Value{ 0.0, &typeNames()[(int)frame.type(i)] };
+		case Field::Name: return Value{ 0.0, &frame.name(i) };
+		case Field::Frame: return number((double)s.frameNumber);
+		case Field::Index: return number((double)i);
+		case Field::Vertices: return number(frame.vertexCount(i));
+		case Field::X: case Field::Y: case Field::Z: return number(frame.centroid(i)[(int)f - (int)Field::X]);
+		case Field::MinX: case Field::MinY: case Field::MinZ: return number(frame.primitiveBounds(i).min[(int)f - (int)Field::MinX]);
+		case Field::MaxX: case Field::MaxY: case Field::MaxZ: return number(frame.primitiveBounds(i).max[(int)f - (int)Field::MaxX]);
+		case Field::Size: {
+			const AABB b = frame.primitiveBounds(i);
+			return number(glm::length(b.max - b.min));
+		}
+		case Field::Area: return number(frame.type(i) == PrimType::Triangle ? triangleArea(frame.positions(i)) : 0.0);
+		case Field::Length: {
+			const glm::vec3* p = frame.positions(i);
+			return number(frame.type(i) == PrimType::Line ? glm::length(p[1] - p[0]) : 0.0);
+		}
+		case Field::R: case Field::G: case Field::B: case Field::A: return number(frame.color(i)[(int)f - (int)Field::R]);
+		case Field::Degenerate: return number(isDegenerate(frame, i) ? 1.0 : 0.0);
+		default: return Value{};
+		}
+	}
+
+	Value call(const Node& n, const Subject& s) const {
+		const Frame& frame = *s.frame;
+		auto arg = [&](size_t k) { return num(n.args[k], s); };
+		switch (kFuncs[n.index].func) {
+		case Func::Contains: {
+			const glm::vec3 p((float)arg(0), (float)arg(1), (float)arg(2));
+			const double eps = n.args.size() > 3 ? arg(3) : 0.0;
+			return number(frame.primitiveBounds(s.index).distance2(p) <= eps * eps ? 1.0 : 0.0);
+		}
+		case Func::Overlaps: {
+			AABB box;
+			box.expand(glm::vec3((float)arg(0), (float)arg(1), (float)arg(2)));
+			box.expand(glm::vec3((float)arg(3), (float)arg(4), (float)arg(5)));
+			return number(frame.primitiveBounds(s.index).overlaps(box) ? 1.0 : 0.0);
+		}
+		case Func::Dist: return number(primitiveDistance(frame, s.index, glm::vec3((float)arg(0), (float)arg(1), (float)arg(2))));
+		case Func::Abs: return number(std::fabs(arg(0)));
+		case Func::Sqrt: return number(std::sqrt(arg(0)));
+		case Func::Min: return number(std::min(arg(0), arg(1)));
+		case Func::Max: return number(std::max(arg(0), arg(1)));
+		}
+		return Value{};
+	}
+
+	// Strings compare as strings, numbers as numbers; mixed operands are never equal.
+	static Value compare(Op op, const Value& l, const Value& r) {
+		int order;
+		if (l.isString() != r.isString()) return number(op == Op::Ne ? 1.0 : 0.0);
+		if (l.isString()) order = l.str->compare(*r.str);
+		else order = l.num < r.num ? -1 : l.num > r.num ? 1 : l.num == r.num ? 0 : 2;   // 2: NaN
+		switch (op) {
+		case Op::Eq: return number(order == 0);
+		case Op::Ne: return number(order != 0);
+		case Op::Lt: return number(order == -1);
+		case Op::Le: return number(order == -1 || order == 0);
+		case Op::Gt: return number(order == 1);
+		default: return number(order == 1 || order == 0);
+		}
+	}
+
+	Value eval(int node, const Subject& s) const {
+		const Node& n = nodes[node];
+		switch (n.op) {
+		case Op::Num: return number(n.num);
+		case Op::Str: return Value{ 0.0, &n.str };
+		case Op::Field: return field(Field(n.index), s);
+		case Op::Call: return call(n, s);
+		case Op::Neg: return number(-num(n.a, s));
+		case Op::Not: return number(eval(n.a, s).truthy() ? 0.0 : 1.0);
+		case Op::And: return number(eval(n.a, s).truthy() && eval(n.b, s).truthy());
+		case Op::Or: return number(eval(n.a, s).truthy() || eval(n.b, s).truthy());
+		case Op::Add: return number(num(n.a, s) + num(n.b, s));
+		case Op::Sub: return number(num(n.a, s) - num(n.b, s));
+		case Op::Mul: return number(num(n.a, s) * num(n.b, s));
+		case Op::Div: return number(num(n.a, s) / num(n.b, s));
+		case Op::Glob: {
+			const Value l = eval(n.a, s), r = eval(n.b, s);
+			return number(l.isString() && r.isString() && globMatch(*r.str, *l.str));
+		}
+		default: return compare(n.op, eval(n.a, s), eval(n.b, s));
+		}
+	}
+
+	static const std::string* typeNames() {
+		static const std::string names[(int)PrimType::Count] = { "triangle", "line", "point", "box" };
+		return names;
+	}
+
+	std::vector<Node> nodes;
+	int root = -1;
+	std::string src;
+	size_t pos = 0;
+};
+
+enum class Group { Frame, Name, Type, None };
+
+struct Aggregate {
+	enum Kind { Count, Sum, Min, Max, Avg };
+	Kind kind = Count;
+	Expr arg;
+	std::string label;
+};
+
+// Running count/sum/min/max of one aggregate's argument
+struct Accumulator {
+	uint64_t n = 0;
+	double sum = 0.0;
+	double lo = std::numeric_limits<double>::infinity();
+	double hi = -std::numeric_limits<double>::infinity();
+
+	void add(double v) {
+		++n;
+		sum += v;
+		lo = std::min(lo, v);
+		hi = std::max(hi, v);
+	}
+	void merge(const Accumulator& o) {
+		n += o.n;
+		sum += o.sum;
+		lo = std::min(lo, o.lo);
+		hi = std::max(hi, o.hi);
+	}
+	// False when the aggregate has no value (min/max/avg of nothing)
+	bool value(Aggregate::Kind kind, double& out) const {
+		switch (kind) {
+		case Aggregate::Count: out = (double)n; return true;
+		case Aggregate::Sum: out = sum; return true;
+		case Aggregate::Min: out = lo; return n > 0;
+		case Aggregate::Max: out = hi; return n > 0;
+		default: out = n ? sum / n : 0.0; return n > 0;
+		}
+	}
+};
+
+class Query {
+public:
+	// Matching primitives of one group; key is the frame number, name id or type
+	struct Row {
+		uint64_t key = 0;
+		uint64_t matches = 0;
+		std::vector<Accumulator> values;
+
+		void merge(const Row& o) {
+			matches += o.matches;
+			for (size_t k = 0; k < values.size(); ++k) values[k].merge(o.values[k]);
+		}
+	};
+
+	// `select` is a comma separated list of count, sum(e), min(e), max(e), avg(e).
+	bool compile(const std::string& where, const std::string& select, Group groupBy, std::string& error) {
+		group = groupBy;
+		aggregates.clear();
+		if (!filter.compile(where, error)) {
+			error = "--where: " + error;
+			return false;
+		}
+		for (const std::string& item : splitList(select)) {
+			Aggregate a;
+			a.label = item;
+			static const struct { const char* name; Aggregate::Kind kind; } kinds[] = {
+				{ "sum", Aggregate::Sum }, { "min", Aggregate::Min }, { "max", Aggregate::Max }, { "avg", Aggregate::Avg },
+			};
+			if (item == "count" || item == "count()") {
+				aggregates.push_back(std::move(a));
+				continue;
+			}
+			bool known = false;
+			for (const auto& k : kinds) {
+				const size_t n = std::char_traits<char>::length(k.name);
+				if (item.compare(0, n, k.name) != 0 || item.size() < n + 2 || item[n] != '(' || item.back() != ')') continue;
+				a.kind = k.kind;
+				if (!a.arg.compile(item.substr(n + 1, item.size() - n - 2), error) || a.arg.empty()) {
+					error = "--select " + item + ": " + (error.empty() ? "missing argument" : error);
+					return false;
+				}
+				known = true;
+			}
+			if (!known) {
+				error = "--select: unknown aggregate '" + item + "'";
+				return false;
+			}
+			aggregates.push_back(std::move(a));
+		}
+		if (aggregates.empty()) {
+			error = "--select: nothing to compute";
+			return false;
+		}
+		return true;
+	}
+
+	Group grouping() const { return group; }
+	const std::vector<Aggregate>& columns() const { return aggregates; }
+
+	Row emptyRow(uint64_t key) const {
+		Row r;
+		r.key = key;
+		r.values.resize(aggregates.size());
+		return r;
+	}
+
+	// Appends the rows of one frame: exactly one for Group::Frame and
+	// Group::None, one per name or type that matched otherwise.
+	void evaluate(const Frame& frame, uint64_t frameNumber, std::vector<Row>& rows) const {
+		const size_t first = rows.size();
+		std::unordered_map<uint64_t, size_t> slot;
+		if (group == Group::Frame || group == Group::None) rows.push_back(emptyRow(group == Group::Frame ? frameNumber : 0));
+
+		Subject s{ &frame, 0, frameNumber };
+		for (size_t i = 0; i < frame.size(); ++i) {
+			s.index = i;
+			if (!filter.test(s)) continue;
+			Row* row = &rows[first];
+			if (group == Group::Name || group == Group::Type) {
+				const uint64_t key = group == Group::Name ? frame.nameId(i) : (uint64_t)frame.type(i);
+				auto it = slot.find(key);
+				if (it == slot.end()) {
+					it = slot.emplace(key, rows.size()).first;
+					rows.push_back(emptyRow(key));
+				}
+				row = &rows[it->second];
+			}
+			++row->matches;
+			for (size_t k = 0; k < aggregates.size(); ++k)
+				row->values[k].add(aggregates[k].kind == Aggregate::Count ? 1.0 : aggregates[k].arg.eval(s).num);
+		}
+	}
+
+private:
+	// Splits at commas outside parentheses and strings; items are trimmed
+	static std::vector<std::string> splitList(const std::string& text) {
+		std::vector<std::string> items;
+		std::string cur;
+		int depth = 0;
+		bool quoted = false;
+		auto flush = [&] {
+			const size_t b = cur.find_first_not_of(" \t"), e = cur.find_last_not_of(" \t");
+			if (b != std::string::npos) items.push_back(cur.substr(b, e - b + 1));
+			cur.clear();
+		};
+		for (char c : text) {
+			if (c == '"') quoted = !quoted;
+			if (!quoted && c == '(') ++depth;
+			if (!quoted && c == ')') --depth;
+			if (!quoted && depth == 0 && c == ',') flush();
+			else cur += c;
+		}
+		flush();
+		return items;
+	}
+
+	Expr filter;
+	std::vector<Aggregate> aggregates;
+	Group group = Group::Frame;
+};
+
+} // namespace query
+
+#endif // PRIMITIVE_QUERY_H
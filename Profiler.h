@@ -0,0 +1,214 @@
+// Profiler.h
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Lightweight frame profiler: scoped CPU timers, GPU pass times (fed by
+// GpuTimer.h), per-frame draw/upload counters and an optional Chrome trace
+// (chrome://tracing, Perfetto). Each scope keeps a rolling window of
+// per-frame totals for the overlay panel.
+namespace profiler {
+
+static inline uint64_t nowNs() {
+	static const auto epoch = std::chrono::steady_clock::now();
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+class Profiler {
+public:
+	static constexpr size_t kHistory = 240;             // frames kept per series
+	static constexpr size_t kMaxTraceEvents = size_t(1) << 20;
+
+	// Rolling per-frame totals of one scope, GPU pass or counter
+	struct Series {
+		std::string name;
+		bool gpu = false;
+		float history[kHistory] = {};
+		size_t head = 0, filled = 0;
+		double pending = 0.0;       // accumulated in the current frame
+
+		float last() const { return filled ? history[(head + kHistory - 1) % kHistory] : 0.0f; }
+		// q in [0,1]
+		float percentile(float q) const {
+			if (!filled) return 0.0f;
+			std::vector<float> v(history, history + filled);
+			const size_t k = std::min(filled - 1, (size_t)(q * (filled - 1) + 0.5f));
+			std::nth_element(v.begin(), v.begin() + k, v.end());
+			return v[k];
+		}
+		// Oldest first, for ImGui::PlotHistogram
+		void ordered(std::vector<float>& out) const {
+			out.resize(filled);
+			for (size_t i = 0; i < filled; ++i) out[i] = history[(head + kHistory - filled + i) % kHistory];
+		}
+	};
+
+	static Profiler& shared() {
+		static Profiler instance;
+		return instance;
+	}
+
+	std::atomic<bool> enabled{ true };
+
+	void beginFrame() { frameStart = nowNs(); }
+
+	// Moves this frame's totals into the histories; scopes that did not run record 0.
+	void endFrame() {
+		if (!enabled) return;
+		std::lock_guard<std::mutex> lock(mutex);
+		const uint64_t draws = drawCalls.exchange(0), uploadCount = uploads.exchange(0), bytes = uploadBytes.exchange(0);
+		add(frameSeries(), (nowNs() - frameStart) * 1e-6);
+		add(counterSeries(0), (double)draws);
+		add(counterSeries(1), (double)uploadCount);
+		add(counterSeries(2), bytes / 1024.0);
+		++sum.frames;
+		sum.drawCalls += draws;
+		sum.uploads += uploadCount;
+		sum.uploadBytes += bytes;
+		for (Series& s : series) {
+			s.history[s.head] = (float)s.pending;
+			s.head = (s.head + 1) % kHistory;
+			s.filled = std::min(s.filled + 1, kHistory);
+			s.pending = 0.0;
+		}
+	}
+
+	// A finished CPU scope
+	void record(const char* name, uint64_t start, uint64_t end) {
+		if (!enabled) return;
+		std::lock_guard<std::mutex> lock(mutex);
+		add(find(name, false), (end - start) * 1e-6);
+		if (tracing && trace.size() < kMaxTraceEvents) trace.push_back({ name, start, end - start, threadIndex() });
+	}
+
+	// A GPU pass that was submitted at CPU time `start` (results arrive frames later)
+	void recordGpu(const char* name, uint64_t start, uint64_t durationNs) {
+		if (!enabled) return;
+		std::lock_guard<std::mutex> lock(mutex);
+		add(find(name, true), durationNs * 1e-6);
+		if (tracing && trace.size() < kMaxTraceEvents) trace.push_back({ name, start, durationNs, 0 });
+	}
+
+	void countDraw(uint32_t n = 1) { drawCalls += n; }
+	void countUpload(size_t bytes) {
+		++uploads;
+		uploadBytes += bytes;
+	}
+
+	// Snapshot for the panel: frame first, then scopes in first-seen order, counters last
+	std::vector<Series> snapshot() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return series;
+	}
+	// Counters summed over all frames ended so far
+	struct Totals {
+		uint64_t frames = 0, drawCalls = 0, uploads = 0, uploadBytes = 0;
+	};
+	Totals totals() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return sum;
+	}
+
+	static const char* counterName(int c) {
+		static const char* names[3] = { "draw calls", "buffer uploads", "uploaded KB" };
+		return names[c];
+	}
+
+	void startTrace() {
+		std::lock_guard<std::mutex> lock(mutex);
+		trace.clear();
+		tracing = true;
+	}
+	void stopTrace() { tracing = false; }
+	bool isTracing() const { return tracing; }
+	size_t traceEvents() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return trace.size();
+	}
+
+	// Chrome trace event format; GPU passes go on their own track (tid 0).
+	bool exportTrace(const std::string& path) const {
+		std::FILE* out = std::fopen(path.c_str(), "w");
+		if (!out) return false;
+		std::lock_guard<std::mutex> lock(mutex);
+		std::fprintf(out, "{\"traceEvents\":[\n");
+		std::fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}");
+		for (const TraceEvent& e : trace)
+			std::fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				e.name, e.tid, e.start * 1e-3, e.duration * 1e-3);
+		std::fprintf(out, "\n]}\n");
+		return std::fclose(out) == 0;
+	}
+
+private:
+	struct TraceEvent {
+		const char* name;       // string literal
+		uint64_t start, duration;
+		uint32_t tid;
+	};
+
+	Profiler() {
+		series.resize(4);
+		series[0].name = "frame";
+		for (int c = 0; c < 3; ++c) series[1 + c].name = counterName(c);
+	}
+
+	Series& frameSeries() { return series[0]; }
+	Series& counterSeries(int c) { return series[series.size() - 3 + c]; }
+
+	Series& find(const char* name, bool gpu) {
+		for (Series& s : series)
+			if (s.gpu == gpu && s.name == name) return s;
+		// Keep the counters at the end
+		auto at = series.insert(series.end() - 3, Series());
+		at->name = name;
+		at->gpu = gpu;
+		return *at;
+	}
+
+	static void add(Series& s, double value) { s.pending += value; }
+
+	// 1.. per thread in first-use order; 0 is the GPU track
+	static uint32_t threadIndex() {
+		static std::atomic<uint32_t> next{ 1 };
+		thread_local uint32_t index = next++;
+		return index;
+	}
+
+	mutable std::mutex mutex;
+	std::vector<Series> series;
+	std::vector<TraceEvent> trace;
+	Totals sum;
+	std::atomic<bool> tracing{ false };
+	uint64_t frameStart = 0;
+	std::atomic<uint64_t> drawCalls{ 0 }, uploads{ 0 }, uploadBytes{ 0 };
+};
+
+// Times the enclosing block; `name` must be a string literal.
+class Scope {
+public:
+	explicit Scope(const char* name) : name(name), start(nowNs()) {}
+	~Scope() { Profiler::shared().record(name, start, nowNs()); }
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+
+private:
+	const char* name;
+	uint64_t start;
+};
+
+static inline void countDraw(uint32_t n = 1) { Profiler::shared().countDraw(n); }
+static inline void countUpload(size_t bytes) { Profiler::shared().countUpload(bytes); }
+
+} // namespace profiler
+
+#endif // PROFILER_H
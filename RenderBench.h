@@ -0,0 +1,183 @@
+// RenderBench.h
+#ifndef RENDER_BENCH_H
+#define RENDER_BENCH_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Profiler.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// End-to-end viewer benchmark (--bench-render): a fixed camera script is
+// replayed frame by frame and the frame times, draw/upload counters and
+// peak memory are reported as JSON. Everything except the timings depends
+// only on the capture and the step count, so runs compare across builds.
+namespace renderbench {
+
+// Camera state and capture frame for one step
+struct Keyframe {
+	glm::vec3 target;
+	float distance, pitch, yaw;
+	int frame;
+};
+
+// Orbit, zoom in and out, then scrub through all frames, each a third of the
+// steps, around a view of the whole capture (center, distance).
+class Script {
+public:
+	Script(int steps, int frameCount, const glm::vec3& center, float distance)
+		: steps(std::max(1, steps)), frameCount(std::max(1, frameCount)), center(center), distance(distance) {}
+
+	Keyframe at(int step) const {
+		const float pi = 3.14159265f;
+		const float u = steps > 1 ? std::min(step, steps - 1) / float(steps - 1) : 0.0f;
+		Keyframe k{ center, distance, 25.0f, -90.0f, 0 };
+		if (u < 1.0f / 3.0f) {
+			const float t = u * 3.0f;
+			k.yaw = -90.0f + 360.0f * t;
+			k.pitch = 25.0f + 15.0f * std::sin(2.0f * pi * t);
+		}
+		else if (u < 2.0f / 3.0f) {
+			const float t = (u - 1.0f / 3.0f) * 3.0f;
+			k.yaw = 270.0f + 60.0f * t;
+			k.distance = distance * (1.0f - 0.85f * std::sin(pi * t));
+		}
+		else {
+			const float t = (u - 2.0f / 3.0f) * 3.0f;
+			k.yaw = 330.0f + 30.0f * t;
+			k.frame = (int)std::lround(t * (frameCount - 1));
+		}
+		return k;
+	}
+
+	int size() const { return steps; }
+
+private:
+	int steps, frameCount;
+	glm::vec3 center;
+	float distance;
+};
+
+static inline double peakRssMB() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+	return 0.0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+#if defined(__APPLE__)
+	return usage.ru_maxrss / (1024.0 * 1024.0);   // bytes
+#else
+	return usage.ru_maxrss / 1024.0;              // KB
+#endif
+#endif
+}
+
+// Context for the report
+struct RunInfo {
+	std::string capture, backend, renderer;
+	int width = 0, height = 0;
+	size_t captureFrames = 0;
+	double loadSeconds = 0.0;
+};
+
+// Drives a Script: call next() once per frame, before drawing. Frame times
+// are the intervals between calls; the first `warmup` frames hold the first
+// keyframe and are not measured.
+class Runner {
+public:
+	Runner(const Script& script, int warmup = 30) : script(script), warmup(std::max(0, warmup)) {}
+
+	// False once every step was rendered
+	bool next(Keyframe& key) {
+		const uint64_t now = profiler::nowNs();
+		if (step > warmup) times.push_back((now - last) * 1e-6);
+		if (step == warmup) {
+			start = profiler::Profiler::shared().totals();
+			startNs = now;
+		}
+		last = now;
+		if (step >= warmup + script.size()) {
+			if (!finished) {
+				end = profiler::Profiler::shared().totals();
+				seconds = (now - startNs) * 1e-9;
+				finished = true;
+			}
+			return false;
+		}
+		key = script.at(std::max(0, step - warmup));
+		++step;
+		return true;
+	}
+
+	bool done() const { return finished; }
+
+	void writeJson(std::FILE* out, const RunInfo& info) const {
+		std::vector<double> sorted = times;
+		std::sort(sorted.begin(), sorted.end());
+		auto percentile = [&](double q) {
+			if (sorted.empty()) return 0.0;
+			return sorted[std::min(sorted.size() - 1, (size_t)(q * (sorted.size() - 1) + 0.5))];
+		};
+		double mean = 0.0;
+		for (double t : sorted) mean += t;
+		if (!sorted.empty()) mean /= sorted.size();
+		const double frames = std::max<double>(1.0, (double)(end.frames - start.frames));
+
+		std::fprintf(out, "{\n");
+		std::fprintf(out, "  \"capture\": \"%s\",\n", escaped(info.capture).c_str());
+		std::fprintf(out, "  \"backend\": \"%s\",\n", escaped(info.backend).c_str());
+		std::fprintf(out, "  \"renderer\": \"%s\",\n", escaped(info.renderer).c_str());
+		std::fprintf(out, "  \"width\": %d,\n  \"height\": %d,\n", info.width, info.height);
+		std::fprintf(out, "  \"capture_frames\": %zu,\n", info.captureFrames);
+		std::fprintf(out, "  \"load_seconds\": %.3f,\n", info.loadSeconds);
+		std::fprintf(out, "  \"steps\": %zu,\n  \"warmup\": %d,\n", times.size(), warmup);
+		std::fprintf(out, "  \"seconds\": %.3f,\n  \"fps\": %.2f,\n", seconds, seconds > 0 ? times.size() / seconds : 0.0);
+		std::fprintf(out, "  \"frame_ms\": { \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n",
+			mean, percentile(0.5), percentile(0.9), percentile(0.95), percentile(0.99), sorted.empty() ? 0.0 : sorted.back());
+		std::fprintf(out, "  \"draw_calls\": %llu,\n  \"draw_calls_per_frame\": %.1f,\n",
+			(unsigned long long)(end.drawCalls - start.drawCalls), (end.drawCalls - start.drawCalls) / frames);
+		std::fprintf(out, "  \"buffer_uploads\": %llu,\n  \"uploaded_mb\": %.3f,\n",
+			(unsigned long long)(end.uploads - start.uploads), (end.uploadBytes - start.uploadBytes) / (1024.0 * 1024.0));
+		std::fprintf(out, "  \"peak_rss_mb\": %.1f\n", peakRssMB());
+		std::fprintf(out, "}\n");
+	}
+
+private:
+	static std::string escaped(const std::string& s) {
+		std::string out;
+		for (char c : s) {
+			if (c == '"' || c == '\\') out += '\\';
+			if ((unsigned char)c >= 0x20) out += c;
+		}
+		return out;
+	}
+
+	Script script;
+	int warmup;
+	int step = 0;
+	uint64_t last = 0, startNs = 0;
+	double seconds = 0.0;
+	bool finished = false;
+	std::vector<double> times;   // ms
+	profiler::Profiler::Totals start, end;
+};
+
+} // namespace renderbench
+
+#endif // RENDER_BENCH_H
@@ -0,0 +1,214 @@
+// Scene.h
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "Bounds.h"
+#include "NameTable.h"
+
+struct Vertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+};
+
+// Overlay geometry loaded from an OBJ file.
+struct Primitive {
+	std::string name;
+	std::string type; // "overlaymesh"
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices; // For indexed drawing (overlaymesh)
+	glm::vec4 color;
+	AABB bounds;
+};
+
+enum class PrimType : uint8_t { Triangle, Line, Point, Box, Count };
+
+// Positions stored per primitive: triangle corners, line ends, the point, box min/max corners.
+static constexpr uint32_t kPrimVertexCount[(int)PrimType::Count] = { 3, 2, 1, 2 };
+static const char* const kPrimTypeNames[(int)PrimType::Count] = { "drawtriangle", "drawline", "drawpoint", "drawbox" };
+
+static inline const char* primTypeName(PrimType type) { return kPrimTypeNames[(int)type]; }
+
+static inline uint32_t packColor(const glm::vec4& c) {
+	auto byte = [](float v) { return (uint32_t)(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f); };
+	return byte(c.x) | (byte(c.y) << 8) | (byte(c.z) << 16) | (byte(c.w) << 24);
+}
+
+static inline glm::vec4 unpackColor(uint32_t c) {
+	return glm::vec4(c & 0xff, (c >> 8) & 0xff, (c >> 16) & 0xff, c >> 24) * (1.0f / 255.0f);
+}
+
+// The 12 edges of an axis-aligned box as 24 line-list vertices.
+static inline void boxEdges(const glm::vec3& mn, const glm::vec3& mx, glm::vec3* out) {
+	const glm::vec3 p[8] = {
+		glm::vec3(mn.x, mn.y, mn.z), glm::vec3(mx.x, mn.y, mn.z), glm::vec3(mx.x, mx.y, mn.z), glm::vec3(mn.x, mx.y, mn.z),
+		glm::vec3(mn.x, mn.y, mx.z), glm::vec3(mx.x, mn.y, mx.z), glm::vec3(mx.x, mx.y, mx.z), glm::vec3(mn.x, mx.y, mx.z),
+	};
+	static const int edges[24] = { 0,1, 1,2, 2,3, 3,0, 4,5, 5,6, 6,7, 7,4, 0,4, 1,5, 2,6, 3,7 };
+	for (int k = 0; k < 24; ++k) out[k] = p[edges[k]];
+}
+
+// One captured frame as struct-of-arrays. Each primitive type keeps its
+// positions, packed colors and interned name ids in contiguous arrays;
+// `refs` maps the frame's primitive order (list rows, selection) to a
+// (type, slot) pair. A triangle costs about 50 bytes and no allocations.
+// All arrays share one memory resource. Captured frames are kept encoded
+// in a FrameStore; a Frame is a parse buffer or a decoded copy.
+struct Frame {
+	using Resource = std::pmr::memory_resource;
+
+	struct TypeArrays {
+		std::pmr::vector<glm::vec3> positions;   // kPrimVertexCount per slot
+		std::pmr::vector<uint32_t> colors;       // RGBA8, see packColor
+		std::pmr::vector<uint32_t> nameIds;      // into Frame::names()
+		std::pmr::vector<uint32_t> primitives;   // slot -> frame index
+
+		explicit TypeArrays(Resource* r) : positions(r), colors(r), nameIds(r), primitives(r) {}
+
+		size_t size() const { return primitives.size(); }
+		void clear() {
+			positions.clear();
+			colors.clear();
+			nameIds.clear();
+			primitives.clear();
+		}
+	};
+
+	TypeArrays byType[(int)PrimType::Count];
+	std::pmr::vector<uint32_t> refs;        // slot << 2 | type, in frame order
+	AABB bounds;
+
+	// Shared blocks the frame was assembled from (see FrameStore); empty for parse buffers
+	std::pmr::vector<uint32_t> blockIds;
+	std::pmr::vector<uint32_t> blockStart;  // first primitive of each block
+
+	Frame() : Frame(std::pmr::get_default_resource()) {}
+
+	explicit Frame(Resource* r)
+		: byType{ TypeArrays(r), TypeArrays(r), TypeArrays(r), TypeArrays(r) }, refs(r), blockIds(r), blockStart(r) {}
+
+	// Empties the frame but keeps its capacity, for reuse as a parse buffer.
+	void clear() {
+		for (auto& a : byType) a.clear();
+		refs.clear();
+		bounds = AABB();
+		blockIds.clear();
+		blockStart.clear();
+	}
+
+	// Names are interned once for all frames of the loaded captures and cleared with them.
+	static NameTable& names() {
+		static NameTable table;
+		return table;
+	}
+
+	size_t size() const { return refs.size(); }
+	bool empty() const { return refs.empty(); }
+
+	PrimType type(size_t i) const { return PrimType(refs[i] & 3); }
+	uint32_t slot(size_t i) const { return refs[i] >> 2; }
+	const TypeArrays& arrays(PrimType type) const { return byType[(int)type]; }
+
+	uint32_t vertexCount(size_t i) const { return kPrimVertexCount[refs[i] & 3]; }
+	const glm::vec3* positions(size_t i) const {
+		return &byType[refs[i] & 3].positions[(size_t)slot(i) * vertexCount(i)];
+	}
+	uint32_t nameId(size_t i) const { return byType[refs[i] & 3].nameIds[slot(i)]; }
+	const std::string& name(size_t i) const { return names().name(nameId(i)); }
+	glm::vec4 color(size_t i) const { return unpackColor(byType[refs[i] & 3].colors[slot(i)]); }
+
+	AABB primitiveBounds(size_t i) const {
+		AABB b;
+		const glm::vec3* p = positions(i);
+		for (uint32_t k = 0; k < vertexCount(i); ++k) b.expand(p[k]);
+		return b;
+	}
+
+	glm::vec3 centroid(size_t i) const {
+		glm::vec3 sum(0.0f);
+		const glm::vec3* p = positions(i);
+		for (uint32_t k = 0; k < vertexCount(i); ++k) sum += p[k];
+		return sum / float(vertexCount(i));
+	}
+
+	// `positions` holds kPrimVertexCount[type] points. Returns the new primitive's index.
+	uint32_t add(PrimType type, uint32_t nameId, const glm::vec3* positions, const glm::vec4& color) {
+		return add(type, nameId, positions, packColor(color));
+	}
+
+	uint32_t add(PrimType type, uint32_t nameId, const glm::vec3* positions, uint32_t packedColor) {
+		TypeArrays& a = byType[(int)type];
+		const uint32_t index = (uint32_t)refs.size();
+		refs.push_back(((uint32_t)a.nameIds.size() << 2) | (uint32_t)type);
+		a.positions.insert(a.positions.end(), positions, positions + kPrimVertexCount[(int)type]);
+		a.colors.push_back(packedColor);
+		a.nameIds.push_back(nameId);
+		a.primitives.push_back(index);
+		return index;
+	}
+
+	// `count` primitives sharing a name and color, from packed xyz coordinates
+	// (3 * kPrimVertexCount[type] floats per primitive).
+	void addRun(PrimType type, uint32_t nameId, const float* coords, size_t count, uint32_t packedColor) {
+		TypeArrays& a = byType[(int)type];
+		const uint32_t firstSlot = (uint32_t)a.size();
+		const uint32_t firstIndex = (uint32_t)refs.size();
+		const size_t points = count * kPrimVertexCount[(int)type];
+		const size_t oldPoints = a.positions.size();
+		a.positions.resize(oldPoints + points);
+		if (points) std::memcpy(&a.positions[oldPoints].x, coords, points * sizeof(glm::vec3));
+		a.colors.resize(a.colors.size() + count, packedColor);
+		a.nameIds.resize(a.nameIds.size() + count, nameId);
+		a.primitives.reserve(a.primitives.size() + count);
+		refs.reserve(refs.size() + count);
+		for (uint32_t k = 0; k < (uint32_t)count; ++k) {
+			a.primitives.push_back(firstIndex + k);
+			refs.push_back(((firstSlot + k) << 2) | (uint32_t)type);
+		}
+	}
+
+	// Appends every primitive of `o` in order; bounds are left to the caller.
+	void append(const Frame& o) {
+		const uint32_t first = (uint32_t)refs.size();
+		uint32_t slotBase[(int)PrimType::Count];
+		for (int t = 0; t < (int)PrimType::Count; ++t) {
+			TypeArrays& a = byType[t];
+			const TypeArrays& b = o.byType[t];
+			slotBase[t] = (uint32_t)a.size();
+			a.positions.insert(a.positions.end(), b.positions.begin(), b.positions.end());
+			a.colors.insert(a.colors.end(), b.colors.begin(), b.colors.end());
+			a.nameIds.insert(a.nameIds.end(), b.nameIds.begin(), b.nameIds.end());
+			for (uint32_t p : b.primitives) a.primitives.push_back(first + p);
+		}
+		for (uint32_t r : o.refs) refs.push_back(r + (slotBase[r & 3] << 2));
+	}
+
+	// Fills the frame bounds cache; run once per parsed frame.
+	void computeBounds() {
+		bounds = AABB();
+		for (const auto& a : byType)
+			if (!a.positions.empty())
+				bounds.merge(reduceBounds(&a.positions[0].x, a.positions.size(), sizeof(glm::vec3)));
+	}
+
+	size_t memoryUsage() const {
+		size_t bytes = sizeof(Frame) + (refs.capacity() + blockIds.capacity() + blockStart.capacity()) * sizeof(uint32_t);
+		for (const auto& a : byType)
+			bytes += a.positions.capacity() * sizeof(glm::vec3) +
+				(a.colors.capacity() + a.nameIds.capacity() + a.primitives.capacity()) * sizeof(uint32_t);
+		return bytes;
+	}
+};
+
+static inline AABB computeBounds(const std::vector<Vertex>& vertices) {
+	if (vertices.empty()) return AABB();
+	return reduceBounds(&vertices[0].position.x, vertices.size(), sizeof(Vertex));
+}
+
+#endif // SCENE_H
@@ -0,0 +1,286 @@
+// SceneGenerator.h
+#ifndef SCENE_GENERATOR_H
+#define SCENE_GENERATOR_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+
+// Synthetic captures in the text input format, for scale tests and
+// regression runs. Every frame is generated from (seed, frame index) only,
+// so output is identical for any thread count and any frame can be
+// regenerated alone. Numbers are written in fixed point with an integer
+// formatter: generation is fast enough to keep up with disk writes.
+namespace scenegen {
+
+enum class Distribution { Uniform, Clustered, Moving };
+
+static inline const char* distributionName(Distribution d) {
+	switch (d) {
+	case Distribution::Clustered: return "clustered";
+	case Distribution::Moving: return "moving";
+	default: return "uniform";
+	}
+}
+
+struct Options {
+	uint64_t seed = 1;
+	uint64_t frames = 100;
+	uint32_t primitivesPerFrame = 1000;
+	float typeMix[4] = { 1, 1, 1, 1 };   // triangle, line, point, box weights
+	Distribution distribution = Distribution::Uniform;
+	float extent = 100.0f;               // scene half size
+	float primitiveSize = 1.0f;
+	uint32_t clusters = 8;               // Clustered only
+	uint32_t names = 1000;               // distinct names; Moving keeps one trajectory per name
+	float colorFraction = 0.5f;          // share of primitives with an explicit color
+	uint32_t noiseLines = 0;             // log lines per frame that are not commands
+	int decimals = 3;                    // 0..6
+};
+
+// SplitMix64: small, seedable and good enough for geometry
+struct Rng {
+	uint64_t state;
+	explicit Rng(uint64_t seed) : state(seed) {}
+	uint64_t next() {
+		uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+	float uniform() { return (next() >> 40) * (1.0f / 16777216.0f); }   // [0,1)
+	float symmetric() { return uniform() * 2.0f - 1.0f; }               // [-1,1)
+	glm::vec3 box() { return glm::vec3(symmetric(), symmetric(), symmetric()); }
+	float normal() {   // sum of uniforms, cheap and bounded
+		return (uniform() + uniform() + uniform() + uniform() - 2.0f) * 1.7320508f;
+	}
+};
+
+static inline uint64_t mixSeed(uint64_t seed, uint64_t a, uint64_t salt) {
+	return Rng(seed ^ (a * 0xd6e8feb86659fd93ull) ^ salt).next();
+}
+
+class Writer {
+public:
+	explicit Writer(std::string& out) : out(out) {}
+
+	void text(const char* s, size_t n) { out.append(s, n); }
+	template <size_t N>
+	void text(const char (&s)[N]) { out.append(s, N - 1); }
+	void ch(char c) { out.push_back(c); }
+
+	void integer(uint64_t v) {
+		char buf[20];
+		char* p = buf + sizeof(buf);
+		do {
+			*--p = char('0' + v % 10);
+			v /= 10;
+		} while (v);
+		out.append(p, buf + sizeof(buf) - p);
+	}
+
+	void fixed(float v, int decimals) {
+		static const uint32_t scales[7] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+		const uint32_t scale = scales[decimals];
+		if (v < 0) {
+			ch('-');
+			v = -v;
+		}
+		const uint64_t q = (uint64_t)((double)v * scale + 0.5);
+		integer(q / scale);
+		if (decimals == 0) return;
+		ch('.');
+		char buf[8];
+		uint64_t frac = q % scale;
+		for (int i = decimals - 1; i >= 0; --i) {
+			buf[i] = char('0' + frac % 10);
+			frac /= 10;
+		}
+		out.append(buf, decimals);
+	}
+
+	void vec(const glm::vec3& p, int decimals) {
+		ch('[');
+		fixed(p.x, decimals);
+		ch(',');
+		fixed(p.y, decimals);
+		ch(',');
+		fixed(p.z, decimals);
+		ch(']');
+	}
+
+private:
+	std::string& out;
+};
+
+class Generator {
+public:
+	explicit Generator(const Options& options) : opt(options) {
+		opt.decimals = std::clamp(opt.decimals, 0, 6);
+		opt.names = std::max(1u, opt.names);
+		opt.clusters = std::max(1u, opt.clusters);
+		float total = 0;
+		for (int t = 0; t < 4; ++t) total += std::max(0.0f, opt.typeMix[t]);
+		float acc = 0;
+		for (int t = 0; t < 4; ++t) {
+			acc += total > 0 ? std::max(0.0f, opt.typeMix[t]) / total : 0.25f;
+			cumulative[t] = acc;
+		}
+		cumulative[3] = 1.0f;
+		Rng rng(mixSeed(opt.seed, 0, 0xc1u));
+		for (uint32_t c = 0; c < opt.clusters; ++c) centers.push_back(rng.box() * opt.extent * 0.8f);
+	}
+
+	const Options& options() const { return opt; }
+
+	// Appends frame f (framestart() .. frameend() plus its noise lines) to `out`.
+	void frame(uint64_t f, std::string& out) const {
+		Writer w(out);
+		Rng rng(mixSeed(opt.seed, f + 1, 0xf7u));
+		uint32_t noiseLeft = opt.noiseLines;
+		const uint32_t noiseEvery = opt.noiseLines ? std::max(1u, opt.primitivesPerFrame / opt.noiseLines) : 0;
+
+		w.text("framestart()\n");
+		for (uint32_t i = 0; i < opt.primitivesPerFrame; ++i) {
+			if (noiseLeft && i % noiseEvery == 0) {
+				noise(w, rng, f, i);
+				--noiseLeft;
+			}
+			primitive(w, rng, f);
+		}
+		while (noiseLeft--) noise(w, rng, f, opt.primitivesPerFrame);
+		w.text("frameend()\n");
+	}
+
+	// Frames [first, first + count) in order, generated in parallel batches of
+	// about `batchBytes`. sink(const std::string&) receives whole frames in
+	// order and returns false to stop. Returns the number of bytes produced.
+	template <class Sink>
+	uint64_t run(uint64_t first, uint64_t count, Sink&& sink, size_t batchBytes = size_t(8) << 20) const {
+		ThreadPool& pool = ThreadPool::shared();
+		const size_t lanes = std::max<size_t>(1, pool.size());
+		// Frames per lane so one batch is about batchBytes
+		const size_t perFrame = std::max<size_t>(1, estimateFrameBytes());
+		const size_t framesPerLane = std::max<size_t>(1, batchBytes / lanes / perFrame);
+		std::vector<std::string> parts(lanes);
+		uint64_t produced = 0;
+
+		for (uint64_t at = first; at < first + count;) {
+			const uint64_t batch = std::min<uint64_t>(first + count - at, (uint64_t)lanes * framesPerLane);
+			const size_t used = (size_t)((batch + framesPerLane - 1) / framesPerLane);
+			pool.parallelFor(used, 1, [&](size_t begin, size_t end) {
+				for (size_t lane = begin; lane < end; ++lane) {
+					parts[lane].clear();
+					const uint64_t lo = at + lane * framesPerLane;
+					const uint64_t hi = std::min(at + batch, lo + framesPerLane);
+					for (uint64_t f = lo; f < hi; ++f) frame(f, parts[lane]);
+				}
+			});
+			for (size_t lane = 0; lane < used; ++lane) {
+				produced += parts[lane].size();
+				if (!sink(parts[lane])) return produced;
+			}
+			at += batch;
+		}
+		return produced;
+	}
+
+	size_t estimateFrameBytes() const {
+		return 32 + (size_t)opt.primitivesPerFrame * (60 + 3 * 12 * (opt.decimals + 5)) + (size_t)opt.noiseLines * 90;
+	}
+
+private:
+	void primitive(Writer& w, Rng& rng, uint64_t f) const {
+		const float pick = rng.uniform();
+		int type = 0;
+		while (type < 3 && pick >= cumulative[type]) ++type;
+		const uint32_t name = (uint32_t)(rng.next() % opt.names);
+		const glm::vec3 p = anchor(rng, name, f);
+		const float s = opt.primitiveSize;
+
+		static const char* const commands[4] = { "drawtriangle \"", "drawline \"", "drawpoint \"", "drawbox \"" };
+		static const size_t lengths[4] = { 14, 10, 11, 9 };
+		w.text(commands[type], lengths[type]);
+		w.text("n");
+		w.integer(name);
+		w.text("\" ");
+		switch (type) {
+		case 0:
+			w.vec(p, opt.decimals);
+			w.vec(p + rng.box() * s, opt.decimals);
+			w.vec(p + rng.box() * s, opt.decimals);
+			break;
+		case 1:
+			w.vec(p, opt.decimals);
+			w.vec(p + rng.box() * s, opt.decimals);
+			break;
+		case 2:
+			w.vec(p, opt.decimals);
+			break;
+		default: {
+			const glm::vec3 half = glm::abs(rng.box()) * s * 0.5f + glm::vec3(1e-3f);
+			w.vec(p - half, opt.decimals);
+			w.vec(p + half, opt.decimals);
+			break;
+		}
+		}
+		if (rng.uniform() < opt.colorFraction) {
+			w.text(" [");
+			w.fixed(rng.uniform(), 2);
+			w.ch(',');
+			w.fixed(rng.uniform(), 2);
+			w.ch(',');
+			w.fixed(rng.uniform(), 2);
+			w.text(",1]");
+		}
+		w.ch('\n');
+	}
+
+	glm::vec3 anchor(Rng& rng, uint32_t name, uint64_t f) const {
+		switch (opt.distribution) {
+		case Distribution::Clustered: {
+			const glm::vec3& c = centers[rng.next() % centers.size()];
+			const float sigma = opt.extent * 0.05f;
+			return c + glm::vec3(rng.normal(), rng.normal(), rng.normal()) * sigma;
+		}
+		case Distribution::Moving: {
+			// Each name drifts along its own direction and wraps inside the extent
+			Rng own(mixSeed(opt.seed, name + 1, 0x5eu));
+			const glm::vec3 start = own.box() * opt.extent;
+			const glm::vec3 velocity = own.box() * (opt.extent * 0.01f);
+			glm::vec3 p = start + velocity * (float)f;
+			p = glm::mod(p + glm::vec3(opt.extent), glm::vec3(2.0f * opt.extent)) - glm::vec3(opt.extent);
+			return p;
+		}
+		default:
+			return rng.box() * opt.extent;
+		}
+	}
+
+	void noise(Writer& w, Rng& rng, uint64_t f, uint32_t i) const {
+		static const char* const levels[3] = { "INFO", "DEBUG", "WARN" };
+		w.text("[frame ");
+		w.integer(f);
+		w.text("] ");
+		const char* level = levels[rng.next() % 3];
+		w.text(level, std::char_traits<char>::length(level));
+		w.text(" solver step ");
+		w.integer(i);
+		w.text(" residual ");
+		w.fixed(rng.uniform(), 6);
+		w.text(" took ");
+		w.integer(rng.next() % 1000);
+		w.text("us\n");
+	}
+
+	Options opt;
+	float cumulative[4] = {};
+	std::vector<glm::vec3> centers;
+};
+
+} // namespace scenegen
+
+#endif // SCENE_GENERATOR_H
@@ -0,0 +1,199 @@
+// SceneLabels.h
+#ifndef SCENE_LABELS_H
+#define SCENE_LABELS_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "imgui.h"
+#include "Profiler.h"
+#include "Scene.h"
+
+// Primitive names drawn at their centroids. Anchors are projected on the
+// CPU, those beyond `maxDistance` from the eye are dropped and the rest are
+// placed nearest first on a coarse screen grid, skipping labels that would
+// overlap one already placed. The placed labels become quads of the ImGui
+// font atlas written into a single reservation of the draw list, so they
+// cost one batched draw instead of an AddText call each.
+class SceneLabels {
+public:
+	static constexpr size_t kMaxLabels = 20000;   // safety cap on a huge display
+
+	struct Stats {
+		size_t candidates = 0;   // anchors in range and on screen
+		size_t drawn = 0;
+		double ms = 0.0;
+	};
+
+	// Labels for a view of `size` pixels at `origin` on the draw list; `selected` (or -1) is placed first and highlighted.
+	void draw(ImDrawList* list, const Frame& frame, const glm::mat4& viewProjection, const glm::vec3& eye,
+		float maxDistance, ImVec2 origin, ImVec2 size, int selected) {
+		profiler::Scope scope("labels");
+		const auto t0 = std::chrono::steady_clock::now();
+		stats = Stats();
+		ImFont* font = ImGui::GetFont();
+		if (!font || size.x <= 0.0f || size.y <= 0.0f || maxDistance <= 0.0f) return;
+		if (font != layoutFont) {
+			layouts.clear();
+			layoutFont = font;
+		}
+		if (layouts.size() < Frame::names().size()) layouts.resize(Frame::names().size());   // placed labels point into it
+		const float scale = ImGui::GetFontSize() / font->FontSize;
+		const float height = ImGui::GetFontSize();
+
+		// Centroids straight from the per-type arrays; bucketed by distance, so placement runs nearest first without a sort
+		candidates.clear();
+		std::fill(std::begin(bucketStart), std::end(bucketStart), 0u);
+		const float maxDistance2 = maxDistance * maxDistance;
+		for (int t = 0; t < (int)PrimType::Count; ++t) {
+			const Frame::TypeArrays& a = frame.byType[t];
+			const uint32_t vertices = kPrimVertexCount[t];
+			for (size_t slot = 0; slot < a.size(); ++slot) {
+				const glm::vec3* p = &a.positions[slot * vertices];
+				glm::vec3 c = p[0];
+				for (uint32_t k = 1; k < vertices; ++k) c += p[k];
+				c /= float(vertices);
+				const glm::vec3 d = c - eye;
+				const float distance2 = glm::dot(d, d);
+				if (distance2 > maxDistance2) continue;
+				const glm::vec4 clip = viewProjection * glm::vec4(c, 1.0f);
+				if (clip.w <= 0.0f) continue;
+				const float x = (clip.x / clip.w * 0.5f + 0.5f) * size.x;
+				const float y = (0.5f - clip.y / clip.w * 0.5f) * size.y;
+				if (x < 0.0f || y < 0.0f || x >= size.x || y >= size.y) continue;
+				const uint32_t prim = a.primitives[slot];
+				const uint32_t bucket = (int)prim == selected ? 0 : std::min(kBuckets - 1, 1 + (uint32_t)(std::sqrt(distance2 / maxDistance2) * (kBuckets - 1)));
+				candidates.push_back({ x, y, prim, a.nameIds[slot], bucket });
+				++bucketStart[bucket + 1];
+			}
+		}
+		stats.candidates = candidates.size();
+		for (uint32_t b = 1; b <= kBuckets; ++b) bucketStart[b] += bucketStart[b - 1];
+		ordered.resize(candidates.size());
+		for (const Candidate& c : candidates) ordered[bucketStart[c.bucket]++] = c;
+
+		// Overlap test on a grid of kCell pixel cells; a label takes every cell it touches
+		const int gridW = (int)std::ceil(size.x / kCell), gridH = (int)std::ceil(size.y / kCell);
+		occupied.assign((size_t)gridW * gridH, 0);
+		placed.clear();
+		size_t glyphs = 0;
+		for (const Candidate& c : ordered) {
+			const float x0 = c.x + 4.0f, y0 = c.y - height * 0.5f;
+			if (occupied[(size_t)(int)(c.y / kCell) * gridW + std::min(gridW - 1, (int)(x0 / kCell))]) continue;   // cheap reject before the layout
+			const Layout& layout = layoutOf(c.nameId, font);
+			if (layout.glyphs.empty()) continue;
+			const int cx0 = std::max(0, (int)(x0 / kCell)), cx1 = std::min(gridW - 1, (int)((x0 + layout.width * scale) / kCell));
+			const int cy0 = std::max(0, (int)(y0 / kCell)), cy1 = std::min(gridH - 1, (int)((y0 + height) / kCell));
+			bool free = true;
+			for (int cy = cy0; cy <= cy1 && free; ++cy)
+				for (int cx = cx0; cx <= cx1 && free; ++cx) free = !occupied[(size_t)cy * gridW + cx];
+			if (!free) continue;
+			for (int cy = cy0; cy <= cy1; ++cy)
+				std::fill(occupied.begin() + (size_t)cy * gridW + cx0, occupied.begin() + (size_t)cy * gridW + cx1 + 1, 1);
+			placed.push_back({ ImVec2(std::floor(origin.x + x0), std::floor(origin.y + y0)), &layout, (int)c.prim == selected });
+			glyphs += layout.glyphs.size();
+			if (placed.size() >= kMaxLabels) break;
+		}
+		stats.drawn = placed.size();
+
+		// Reserved in chunks that fit the draw list's 16-bit indices
+		size_t left = 0, emitted = 0;
+		for (const Placed& p : placed) {
+			const ImU32 color = p.selected ? IM_COL32(255, 255, 60, 255) : IM_COL32(235, 235, 235, 255);
+			for (const Glyph& g : p.layout->glyphs) {
+				if (left == 0) {
+					left = std::min(kChunkGlyphs, glyphs - emitted);
+					list->PrimReserve((int)left * 6, (int)left * 4);
+				}
+				const ImFontGlyph* glyph = g.glyph;
+				const float x = p.pos.x + g.x * scale, y = p.pos.y;
+				list->PrimRectUV(ImVec2(x + glyph->X0 * scale, y + glyph->Y0 * scale), ImVec2(x + glyph->X1 * scale, y + glyph->Y1 * scale),
+					ImVec2(glyph->U0, glyph->V0), ImVec2(glyph->U1, glyph->V1), glyph->Colored ? IM_COL32_WHITE : color);
+				--left;
+				++emitted;
+			}
+		}
+		stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	const Stats& lastStats() const { return stats; }
+
+	// Drops the cached layouts; call when Frame::names() is cleared.
+	void clear() { layouts.clear(); }
+
+private:
+	static constexpr uint32_t kBuckets = 64;       // bucket 0: the selection
+	static constexpr float kCell = 8.0f;
+	static constexpr size_t kChunkGlyphs = 8192;   // 32768 vertices
+
+	struct Candidate {
+		float x, y;
+		uint32_t prim, nameId, bucket;
+	};
+
+	struct Glyph {
+		const ImFontGlyph* glyph;
+		float x;   // pen position, unscaled
+	};
+
+	// Visible glyphs of a name, laid out once per font
+	struct Layout {
+		bool valid = false;
+		float width = 0.0f;
+		std::vector<Glyph> glyphs;
+	};
+
+	struct Placed {
+		ImVec2 pos;
+		const Layout* layout;
+		bool selected;
+	};
+
+	const Layout& layoutOf(uint32_t nameId, ImFont* font) {
+		Layout& layout = layouts[nameId];
+		if (layout.valid) return layout;
+		layout.valid = true;
+		const std::string& name = Frame::names().name(nameId);
+		const char* p = name.data();
+		const char* end = p + name.size();
+		while (p < end) {
+			const unsigned c = decodeUtf8(p, end);
+			if (c == '\n' || c == '\r') break;
+			const ImFontGlyph* glyph = font->FindGlyph((ImWchar)(c <= 0xFFFF ? c : 0xFFFD));
+			if (!glyph) continue;
+			if (glyph->Visible) layout.glyphs.push_back({ glyph, layout.width });
+			layout.width += glyph->AdvanceX;
+		}
+		return layout;
+	}
+
+	// Next code point; malformed bytes decode as U+FFFD
+	static unsigned decodeUtf8(const char*& p, const char* end) {
+		const unsigned char c = (unsigned char)*p++;
+		if (c < 0x80) return c;
+		const int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : -1;
+		if (extra < 0 || end - p < extra) return 0xFFFD;
+		unsigned code = c & (0x3F >> extra);
+		for (int k = 0; k < extra; ++k) {
+			const unsigned char next = (unsigned char)*p;
+			if ((next & 0xC0) != 0x80) return 0xFFFD;
+			code = code << 6 | (next & 0x3F);
+			++p;
+		}
+		return code;
+	}
+
+	std::vector<Layout> layouts;   // by name id
+	ImFont* layoutFont = nullptr;
+	std::vector<Candidate> candidates, ordered;
+	uint32_t bucketStart[kBuckets + 1] = {};
+	std::vector<uint8_t> occupied;
+	std::vector<Placed> placed;
+	Stats stats;
+};
+
+#endif // SCENE_LABELS_H
@@ -0,0 +1,614 @@
+// SceneParser.cpp
+#include "SceneParser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include "BulkPayload.h"
+#include "CommandScan.h"
+#include "Palette.h"
+#include "Profiler.h"
+
+void parseOBJData(const std::string& data, std::vector<Primitive>& overlay) {
+	profiler::Scope scope("parseOBJData");
+
+	std::istringstream stream(data);
+	std::string line;
+
+	std::vector<Vertex> vertices; // Combined positions and normals
+	std::vector<unsigned int> indices;
+
+	std::vector<glm::vec3> objPositions; // Positions from 'v' lines
+	std::vector<unsigned int> faceIndices; // Indices of all faces, back to back
+	std::vector<size_t> faceStart;         // Offset of each face in faceIndices
+
+	// Clear previous overlay data
+	overlay.clear();
+
+	while (std::getline(stream, line)) {
+		// Remove comments
+		size_t commentPos = line.find('#');
+		if (commentPos != std::string::npos) {
+			line = line.substr(0, commentPos);
+		}
+
+		std::istringstream linestream(line);
+		std::string prefix;
+		linestream >> prefix;
+
+		if (prefix == "v") {
+			// Vertex position
+			float x, y, z;
+			linestream >> x >> y >> z;
+			objPositions.push_back(glm::vec3(x, y, z));
+		}
+		else if (prefix == "f") {
+			// Face definition
+			faceStart.push_back(faceIndices.size());
+			std::string vertexStr;
+			while (linestream >> vertexStr) {
+				std::istringstream vertexStream(vertexStr);
+				std::string indexStr;
+				std::getline(vertexStream, indexStr, '/');
+				int index = std::stoi(indexStr);
+				faceIndices.push_back(index - 1); // OBJ indices start at 1
+			}
+		}
+		// Ignore other prefixes (e.g., 'vn', 'vt')
+	}
+
+	// Calculate normals and build the vertex and index arrays
+	faceStart.push_back(faceIndices.size());
+	for (size_t f = 0; f + 1 < faceStart.size(); ++f) {
+		const unsigned int* face = faceIndices.data() + faceStart[f];
+		const size_t faceSize = faceStart[f + 1] - faceStart[f];
+		if (faceSize < 3) continue; // Skip degenerate faces
+
+		// Triangulate faces with more than 3 vertices
+		for (size_t i = 1; i < faceSize - 1; ++i) {
+			// Get vertex positions
+			glm::vec3 v0 = objPositions[face[0]];
+			glm::vec3 v1 = objPositions[face[i]];
+			glm::vec3 v2 = objPositions[face[i + 1]];
+
+			// Calculate face normal
+			glm::vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
+
+			// Create vertices with positions and normals
+			Vertex vertex0 = { v0, normal };
+			Vertex vertex1 = { v1, normal };
+			Vertex vertex2 = { v2, normal };
+
+			// Add vertices and indices
+			unsigned int indexOffset = vertices.size();
+			vertices.push_back(vertex0);
+			vertices.push_back(vertex1);
+			vertices.push_back(vertex2);
+
+			indices.push_back(indexOffset);
+			indices.push_back(indexOffset + 1);
+			indices.push_back(indexOffset + 2);
+		}
+	}
+
+	// Store the mesh data in the overlay (as a single primitive)
+	Primitive meshPrim;
+	meshPrim.type = "overlaymesh";
+	meshPrim.name = "Overlay Mesh";
+	meshPrim.vertices = std::move(vertices);
+	meshPrim.indices = std::move(indices); // We need to add indices to the Primitive structure
+	meshPrim.bounds = computeBounds(meshPrim.vertices);
+	// We can set a fixed color or leave it empty as we'll use lighting
+	overlay.push_back(std::move(meshPrim));
+}
+
+void parseInputData(const std::string& data, FrameStore& frames) {
+	ParseState state;
+	parseInputData(data, state, frames, true);
+}
+
+void parseInputData(std::string_view data, ParseState& state, FrameStore& frames, bool last) {
+	parseInputData(data, state, [&](const Frame& retained, bool retainedChanged, const Frame& frame) {
+		if (retainedChanged) state.retainedLayer = frames.encodeLayer(retained);
+		frames.append(frame, &state.retainedLayer);
+	}, last);
+}
+
+// Updated parseInputData to handle optional RGBA color bracket
+void parseInputData(std::string_view data, ParseState& state, const FrameCallback& onFrame, bool last) {
+	profiler::Scope scope("parseInputData");
+	auto it = data.begin();
+	Frame& currentFrame = state.currentFrame;
+	bool& inFrame = state.inFrame;
+	Frame& retained = state.retained;
+	bool& retainedDirty = state.retainedDirty;
+	bool& persistNext = state.persistNext;
+	std::vector<uint32_t>& pendingRemovals = state.pendingRemovals;
+
+	auto applyRemovals = [&]() {
+		if (pendingRemovals.empty()) return;
+		std::sort(pendingRemovals.begin(), pendingRemovals.end());
+		Frame kept;
+		for (size_t i = 0; i < retained.size(); ++i) {
+			if (std::binary_search(pendingRemovals.begin(), pendingRemovals.end(), retained.nameId(i))) continue;
+			const PrimType type = retained.type(i);
+			kept.add(type, retained.nameId(i), retained.positions(i), retained.arrays(type).colors[retained.slot(i)]);
+		}
+		if (kept.size() != retained.size()) {
+			std::swap(retained, kept);
+			retainedDirty = true;
+		}
+		pendingRemovals.clear();
+	};
+
+	auto addPrimitive = [&](PrimType type, uint32_t nameId, const glm::vec3* positions, const glm::vec4& color) {
+		if (!persistNext) {
+			currentFrame.add(type, nameId, positions, color);
+			return;
+		}
+		persistNext = false;
+		applyRemovals();
+		retained.add(type, nameId, positions, color);
+		retainedDirty = true;
+	};
+
+	auto addPrimitives = [&](PrimType type, uint32_t nameId, const float* coords, size_t count, const glm::vec4& color) {
+		Frame& target = persistNext ? retained : currentFrame;
+		if (persistNext) {
+			persistNext = false;
+			applyRemovals();
+			retainedDirty = true;
+		}
+		target.addRun(type, nameId, coords, count, packColor(color));
+	};
+
+	auto finishFrame = [&]() {
+		applyRemovals();
+		const bool retainedChanged = retainedDirty;
+		if (retainedDirty) {
+			retained.computeBounds();
+			retainedDirty = false;
+		}
+		currentFrame.computeBounds();
+		onFrame(retained, retainedChanged, currentFrame);
+	};
+
+	auto parseOptionalColor = [&](glm::vec4& color, size_t index) {
+		// Skip whitespace
+		while (it != data.end() && std::isspace(*it)) ++it;
+
+		// If the next character is '[', parse RGBA
+		if (it != data.end() && *it == '[') {
+			++it; // skip '['
+			float rgba[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			std::string numStr;
+			int component = 0;
+			while (it != data.end() && *it != ']') {
+				if ((std::isdigit(*it) || *it == '.' || *it == '-')) {
+					numStr += *it;
+				}
+				else if (*it == ',') {
+					if (!numStr.empty()) {
+						float val = std::stof(numStr);
+						rgba[component] = val;
+						numStr.clear();
+						++component;
+						if (component > 3) break; // in case too many
+					}
+				}
+				++it;
+			}
+			// Capture the last value (A)
+			if (!numStr.empty() && component < 4) {
+				float val = std::stof(numStr);
+				rgba[component] = val;
+				numStr.clear();
+			}
+			color = glm::vec4(rgba[0], rgba[1], rgba[2], rgba[3]);
+
+			if (it != data.end()) ++it; // skip ']'
+		}
+		else {
+			// No bracket found, use random color
+			color = stableColor(static_cast<uint32_t>(index));
+		}
+		};
+
+	auto parseOptionalName = [&](const std::string& fallback) {
+		while (it != data.end() && std::isspace(*it)) ++it;
+
+		if (it != data.end() && *it == '"') {
+			++it;
+			std::string name;
+			while (it != data.end() && *it != '"') {
+				name += *it;
+				++it;
+			}
+			if (it != data.end()) ++it;
+			return name;
+		}
+
+		return fallback;
+		};
+
+	auto parseBracketedVertex = [&]() {
+		Vertex vert{};
+		vert.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+
+		while (it != data.end() && *it != '[') ++it;
+		if (it == data.end()) return vert;
+		++it; // skip '['
+
+		std::string numStr;
+		int coordIndex = 0;
+		while (it != data.end() && *it != ']') {
+			if (std::isdigit(*it) || *it == '.' || *it == '-' || *it == '+' || *it == 'e' || *it == 'E') {
+				numStr += *it;
+			}
+			else if (*it == ',') {
+				if (!numStr.empty()) {
+					float val = std::stof(numStr);
+					if (coordIndex == 0) vert.position.x = val;
+					else if (coordIndex == 1) vert.position.y = val;
+					numStr.clear();
+					++coordIndex;
+				}
+			}
+			++it;
+		}
+		if (!numStr.empty()) {
+			float val = std::stof(numStr);
+			if (coordIndex == 0) vert.position.x = val;
+			else if (coordIndex == 1) vert.position.y = val;
+			else vert.position.z = val;
+			numStr.clear();
+		}
+		if (it != data.end()) ++it; // skip ']'
+
+		return vert;
+		};
+
+	// Bulk commands: one name, one flat payload (see BulkPayload.h), one optional color
+	std::vector<float> bulkCoords, meshCoords;
+	std::vector<uint32_t> meshIndices;
+	auto readList = [&](auto& out) {
+		const char* p = data.data() + (it - data.begin());
+		p = bulk::parseList(p, data.data() + data.size(), out);
+		it = data.begin() + (p - data.data());
+	};
+
+	auto parseBulk = [&](PrimType type, const char* fallbackName) {
+		const uint32_t nameId = Frame::names().intern(parseOptionalName(fallbackName));
+		readList(bulkCoords);
+		glm::vec4 color;
+		parseOptionalColor(color, currentFrame.size());
+		const size_t count = bulkCoords.size() / (3 * kPrimVertexCount[(int)type]);
+		addPrimitives(type, nameId, bulkCoords.data(), count, color);
+	};
+
+	// drawmesh "name" <vertex xyz list> <index list> [color]: stored as plain triangles
+	auto parseMesh = [&]() {
+		const uint32_t nameId = Frame::names().intern(parseOptionalName("Unnamed Mesh"));
+		readList(meshCoords);
+		readList(meshIndices);
+		glm::vec4 color;
+		parseOptionalColor(color, currentFrame.size());
+
+		const size_t vertexCount = meshCoords.size() / 3;
+		bulkCoords.clear();
+		bulkCoords.reserve(meshIndices.size() * 3);
+		for (size_t t = 0; t + 2 < meshIndices.size(); t += 3) {
+			const uint32_t* tri = &meshIndices[t];
+			if (tri[0] >= vertexCount || tri[1] >= vertexCount || tri[2] >= vertexCount) continue;
+			for (int k = 0; k < 3; ++k)
+				bulkCoords.insert(bulkCoords.end(), &meshCoords[3 * (size_t)tri[k]], &meshCoords[3 * (size_t)tri[k]] + 3);
+		}
+		addPrimitives(PrimType::Triangle, nameId, bulkCoords.data(), bulkCoords.size() / 9, color);
+	};
+
+	// persist/remove are plain words that log text uses too ("persistent", "removed"):
+	// they must stand alone, preceded by a non-word character and followed by whitespace
+	auto standalone = [&](size_t length) {
+		auto isWordChar = [](char c) { return std::isalnum((unsigned char)c) || c == '_'; };
+		return (it == data.begin() || !isWordChar(it[-1])) && std::distance(it, data.end()) > (std::ptrdiff_t)length
+			&& std::isspace((unsigned char)it[length]);
+	};
+	auto quotedAfter = [&](size_t length) {
+		auto p = it + length;
+		while (p != data.end() && std::isspace((unsigned char)*p)) ++p;
+		return p != data.end() && *p == '"';
+	};
+
+	while (it != data.end()) {
+		// Skip whitespace
+		while (it != data.end() && std::isspace(*it)) ++it;
+
+		// Check for framestart()
+		if (std::distance(it, data.end()) >= 11 && std::equal(it, it + 11, "framestart(")) {
+			inFrame = true;
+			currentFrame.clear();
+			it += 11;
+		}
+		// Check for frameend()
+		else if (std::distance(it, data.end()) >= 9 && std::equal(it, it + 9, "frameend(")) {
+			if (inFrame) {
+				finishFrame();
+				currentFrame.clear();
+				inFrame = false;
+			}
+			it += 9;
+		}
+		// `persist` applies to the draw command that follows it
+		else if (std::distance(it, data.end()) >= 7 && std::equal(it, it + 7, "persist") && standalone(7)) {
+			it += 7;
+			persistNext = true;
+		}
+		// Check for remove "name" (retained primitives only)
+		else if (std::distance(it, data.end()) >= 6 && std::equal(it, it + 6, "remove") && standalone(6) && quotedAfter(6)) {
+			it += 6;
+			const std::string name = parseOptionalName("");
+			const uint32_t id = Frame::names().find(name);
+			if (id != UINT32_MAX) pendingRemovals.push_back(id);
+		}
+		// Bulk commands, matched before their single-primitive prefixes
+		else if (std::distance(it, data.end()) >= 13 && std::equal(it, it + 13, "drawtriangles")) {
+			it += 13;
+			parseBulk(PrimType::Triangle, "Unnamed Triangles");
+		}
+		else if (std::distance(it, data.end()) >= 9 && std::equal(it, it + 9, "drawlines")) {
+			it += 9;
+			parseBulk(PrimType::Line, "Unnamed Lines");
+		}
+		else if (std::distance(it, data.end()) >= 10 && std::equal(it, it + 10, "drawpoints")) {
+			it += 10;
+			parseBulk(PrimType::Point, "Unnamed Points");
+		}
+		else if (std::distance(it, data.end()) >= 8 && std::equal(it, it + 8, "drawmesh")) {
+			it += 8;
+			parseMesh();
+		}
+		// Check for drawtriangle
+		else if (std::distance(it, data.end()) >= 12 && std::equal(it, it + 12, "drawtriangle")) {
+			it += 12; // Move iterator past "drawtriangle"
+			std::string primName;
+
+			// Skip whitespace
+			while (it != data.end() && std::isspace(*it)) ++it;
+
+			// Parse name (optional quotes)
+			if (it != data.end() && *it == '"') {
+				++it; // skip quote
+				std::string name;
+				while (it != data.end() && *it != '"') {
+					name += *it;
+					++it;
+				}
+				if (it != data.end()) ++it; // skip closing quote
+				primName = name;
+			}
+			else {
+				primName = "Unnamed Triangle";
+			}
+
+			// Parse 3 vertices
+			std::vector<Vertex> vertices;
+			for (int i = 0; i < 3; ++i) {
+				while (it != data.end() && *it != '[') ++it;
+				if (it == data.end()) break;
+				++it; // skip '['
+
+				Vertex vert{};
+				std::string numStr;
+				int coordIndex = 0;
+				while (it != data.end() && *it != ']') {
+					if (std::isdigit(*it) || *it == '.' || *it == '-') {
+						numStr += *it;
+					}
+					else if (*it == ',') {
+						if (!numStr.empty()) {
+							float val = std::stof(numStr);
+							if (coordIndex == 0) vert.position.x = val;
+							else if (coordIndex == 1) vert.position.y = val;
+							numStr.clear();
+							++coordIndex;
+						}
+					}
+					++it;
+				}
+				// last coordinate
+				if (!numStr.empty()) {
+					float val = std::stof(numStr);
+					vert.position.z = val;
+					numStr.clear();
+				}
+				vertices.push_back(vert);
+
+				if (it != data.end()) ++it; // skip ']'
+			}
+			vertices.resize(3); // a truncated command keeps zeroed corners
+
+			// Parse optional color
+			glm::vec4 color;
+			parseOptionalColor(color, currentFrame.size());
+
+			const glm::vec3 corners[3] = { vertices[0].position, vertices[1].position, vertices[2].position };
+			addPrimitive(PrimType::Triangle, Frame::names().intern(primName), corners, color);
+		}
+		// Check for drawbox
+		else if (std::distance(it, data.end()) >= 7 && std::equal(it, it + 7, "drawbox")) {
+			it += 7;
+			const uint32_t nameId = Frame::names().intern(parseOptionalName("Unnamed Box"));
+
+			// Stored as min/max corners; the 12 edges are generated when drawn
+			Vertex cornerA = parseBracketedVertex();
+			Vertex cornerB = parseBracketedVertex();
+			const glm::vec3 corners[2] = {
+				glm::min(cornerA.position, cornerB.position),
+				glm::max(cornerA.position, cornerB.position),
+			};
+
+			// Parse optional color
+			glm::vec4 color;
+			parseOptionalColor(color, currentFrame.size());
+
+			addPrimitive(PrimType::Box, nameId, corners, color);
+		}
+		// Check for drawline
+		else if (std::distance(it, data.end()) >= 8 && std::equal(it, it + 8, "drawline")) {
+			it += 8;
+			std::string primName;
+
+			// Skip whitespace
+			while (it != data.end() && std::isspace(*it)) ++it;
+
+			// Parse name
+			if (it != data.end() && *it == '"') {
+				++it;
+				std::string name;
+				while (it != data.end() && *it != '"') {
+					name += *it;
+					++it;
+				}
+				if (it != data.end()) ++it;
+				primName = name;
+			}
+			else {
+				primName = "Unnamed Line";
+			}
+
+			// Parse 2 vertices
+			std::vector<Vertex> vertices;
+			for (int i = 0; i < 2; ++i) {
+				while (it != data.end() && *it != '[') ++it;
+				if (it == data.end()) break;
+				++it; // skip '['
+
+				Vertex vert{};
+				std::string numStr;
+				int coordIndex = 0;
+				while (it != data.end() && *it != ']') {
+					if (std::isdigit(*it) || *it == '.' || *it == '-') {
+						numStr += *it;
+					}
+					else if (*it == ',') {
+						if (!numStr.empty()) {
+							float val = std::stof(numStr);
+							if (coordIndex == 0) vert.position.x = val;
+							else if (coordIndex == 1) vert.position.y = val;
+							numStr.clear();
+							++coordIndex;
+						}
+					}
+					++it;
+				}
+				// last coordinate
+				if (!numStr.empty()) {
+					float val = std::stof(numStr);
+					vert.position.z = val;
+					numStr.clear();
+				}
+				vertices.push_back(vert);
+
+				if (it != data.end()) ++it; // skip ']'
+			}
+			vertices.resize(2);
+
+			// Parse optional color
+			glm::vec4 color;
+			parseOptionalColor(color, currentFrame.size());
+
+			const glm::vec3 ends[2] = { vertices[0].position, vertices[1].position };
+			addPrimitive(PrimType::Line, Frame::names().intern(primName), ends, color);
+		}
+		// Check for drawpoint
+		else if (std::distance(it, data.end()) >= 9 && std::equal(it, it + 9, "drawpoint")) {
+			it += 9;
+			std::string primName;
+
+			// Skip whitespace
+			while (it != data.end() && std::isspace(*it)) ++it;
+
+			// Parse name
+			if (it != data.end() && *it == '"') {
+				++it;
+				std::string name;
+				while (it != data.end() && *it != '"') {
+					name += *it;
+					++it;
+				}
+				if (it != data.end()) ++it;
+				primName = name;
+			}
+			else {
+				primName = "Unnamed Point";
+			}
+
+			// Parse single vertex
+			while (it != data.end() && *it != '[') ++it;
+			if (it != data.end()) ++it; // skip '['
+
+			Vertex vtx{};
+			{
+				std::string numStr;
+				int coordIndex = 0;
+				while (it != data.end() && *it != ']') {
+					if (std::isdigit(*it) || *it == '.' || *it == '-') {
+						numStr += *it;
+					}
+					else if (*it == ',') {
+						if (!numStr.empty()) {
+							float val = std::stof(numStr);
+							if (coordIndex == 0) vtx.position.x = val;
+							else if (coordIndex == 1) vtx.position.y = val;
+							numStr.clear();
+							++coordIndex;
+						}
+					}
+					++it;
+				}
+				// last coordinate
+				if (!numStr.empty()) {
+					float val = std::stof(numStr);
+					vtx.position.z = val;
+					numStr.clear();
+				}
+			}
+			vtx.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+			if (it != data.end()) ++it; // skip ']'
+
+			// Parse optional color
+			glm::vec4 color;
+			parseOptionalColor(color, currentFrame.size());
+
+			addPrimitive(PrimType::Point, Frame::names().intern(primName), &vtx.position, color);
+		}
+		// framestart / frameend or unknown text
+		else {
+			if (it != data.end()) ++it;
+			// Log noise: jump to the next position that can start a keyword
+			const char* next = cmdscan::nextCandidate(data.data() + (it - data.begin()), data.data() + data.size());
+			it = data.begin() + (next - data.data());
+		}
+	}
+
+	if (last && inFrame) {
+		// If there's an unclosed frame, push it at the end (optional)
+		finishFrame();
+		inFrame = false;
+	}
+}
+
+bool parseCaptureStream(CaptureStream& stream, FrameStore& frames) {
+	ParseState state;
+	std::string pending, chunk;
+	while (stream.next(chunk)) {
+		pending += chunk;   // the carried tail has no frameend(), so a marker split across chunks is found here
+		size_t cut = pending.rfind("frameend(");
+		if (cut == std::string::npos) continue;
+		cut += 9;
+		parseInputData(std::string_view(pending).substr(0, cut), state, frames, false);
+		pending.erase(0, cut);
+	}
+	parseInputData(pending, state, frames, true);
+	return stream.error().empty();
+}
@@ -0,0 +1,52 @@
+// SceneParser.h
+#ifndef SCENE_PARSER_H
+#define SCENE_PARSER_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Scene.h"
+#include "FrameStore.h"
+#include "CaptureLoader.h"
+
+// Text input formats: the frame command log (see README) and OBJ overlays.
+// No GL or GUI dependencies; the app and the benchmarks share this code.
+
+// Parser state carried between the chunks of a streamed capture
+struct ParseState {
+	// Parse buffer: keeps its capacity across frames, each finished frame is encoded into the store
+	Frame currentFrame;
+	bool inFrame = false;
+
+	// Retained set: `persist` primitives stay in every later frame until a `remove "name"`.
+	// It is re-encoded only at frames where it changed; its blocks are shared by the rest.
+	Frame retained;
+	FrameStore::Layer retainedLayer;
+	bool retainedDirty = false;
+	bool persistNext = false;
+	std::vector<uint32_t> pendingRemovals;   // name ids, applied in order before the next persist or frame end
+};
+
+// Parses a whole log, appending its frames to `frames`.
+void parseInputData(const std::string& data, FrameStore& frames);
+
+// Parses one chunk of a log. Chunks must end between commands; `last`
+// closes a frame left open.
+void parseInputData(std::string_view data, ParseState& state, FrameStore& frames, bool last);
+
+// Receives each finished frame: the retained set in force (`retainedChanged`
+// when it differs from the previous frame's) and the frame's own primitives.
+using FrameCallback = std::function<void(const Frame& retained, bool retainedChanged, const Frame& frame)>;
+
+// As above, but hands frames to `onFrame` as parsed instead of storing them.
+void parseInputData(std::string_view data, ParseState& state, const FrameCallback& onFrame, bool last);
+
+// Parses a CaptureStream as it is decoded, cutting the text after the last
+// frameend() received so far. False when the stream ended with an error.
+bool parseCaptureStream(CaptureStream& stream, FrameStore& frames);
+
+// Replaces `overlay` with the triangulated mesh of an OBJ file.
+void parseOBJData(const std::string& data, std::vector<Primitive>& overlay);
+
+#endif // SCENE_PARSER_H
@@ -0,0 +1,214 @@
+// SearchIndex.h
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Scene.h"
+#include "FrameStore.h"
+
+// Glob match supporting '*' (any run) and '?' (any single char).
+static inline bool globMatch(std::string_view pattern, std::string_view text) {
+	size_t p = 0, t = 0;
+	size_t starP = std::string_view::npos, starT = 0;
+	while (t < text.size()) {
+		if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+			++p; ++t;
+		}
+		else if (p < pattern.size() && pattern[p] == '*') {
+			starP = p++;
+			starT = t;
+		}
+		else if (starP != std::string_view::npos) {
+			p = starP + 1;
+			t = ++starT;
+		}
+		else {
+			return false;
+		}
+	}
+	while (p < pattern.size() && pattern[p] == '*') ++p;
+	return p == pattern.size();
+}
+
+struct SearchHit {
+	uint32_t frame;
+	uint32_t primitive;
+	uint32_t entry;       // the index's record of the primitive (see SearchIndex::name)
+};
+
+struct SearchQuery {
+	std::string namePattern;    // empty = any name; '*' and '?' wildcards
+	unsigned typeMask = ~0u;    // bit per PrimType
+	bool useRegion = false;     // keep primitives whose AABB overlaps [regionMin, regionMax]
+	glm::vec3 regionMin = glm::vec3(0.0f);
+	glm::vec3 regionMax = glm::vec3(0.0f);
+};
+
+// Load-time index over the distinct blocks of a FrameStore (frames are lists
+// of shared blocks, so geometry repeated across frames is indexed once):
+//  - name id, type and AABB per entry (a primitive of a distinct block), so
+//    result rows and region queries never decode a frame,
+//  - name id (Frame::names()) -> entry postings, stored CSR style.
+// A query marks the matching entries, then walks each frame's block list to
+// turn them into (frame, primitive) hits. Region queries test the frame AABB
+// first. Name patterns are matched against the distinct names only, never per
+// primitive.
+class SearchIndex {
+public:
+	static constexpr int TypeCount = (int)PrimType::Count;
+
+	void clear() {
+		distinctNames = 0;
+		totalPrimitives = 0;
+		frameCount = 0;
+		postingStart = {};
+		postings = {};
+		blockStart = {};
+		nameOf = {};
+		typeOf = {};
+		entryBounds = {};
+		broken = {};
+	}
+
+	void build(const FrameStore& frames) {
+		clear();
+
+		// Pass 1: decode each distinct block once, recording its entries and counting postings per name
+		const size_t nameIds = Frame::names().size();
+		std::vector<uint32_t> counts(nameIds, 0);
+		std::vector<bool> corrupt(frames.distinctBlocks());
+		blockStart.resize(frames.distinctBlocks() + 1);
+		size_t entries = 0;
+		for (uint32_t b = 0; b < frames.distinctBlocks(); ++b) entries += frames.blockPrimitives(b);
+		nameOf.reserve(entries);
+		typeOf.reserve(entries);
+		entryBounds.reserve(entries);
+		Frame block;
+		for (uint32_t b = 0; b < frames.distinctBlocks(); ++b) {
+			blockStart[b] = (uint32_t)nameOf.size();
+			if (!frames.decodeBlock(b, block)) {
+				corrupt[b] = true;
+				continue;
+			}
+			for (size_t i = 0; i < block.size(); ++i) {
+				nameOf.push_back(block.nameId(i));
+				typeOf.push_back((uint8_t)block.type(i));
+				entryBounds.push_back(block.primitiveBounds(i));
+				++counts[block.nameId(i)];
+			}
+		}
+		blockStart[frames.distinctBlocks()] = (uint32_t)nameOf.size();
+
+		// A block that fails to decode leaves its frames empty when decoded; they never match
+		frameCount = frames.size();
+		broken.resize(frameCount);
+		for (size_t f = 0; f < frameCount; ++f) {
+			totalPrimitives += frames.primitiveCount(f);
+			for (size_t k = 0; k < frames.frameBlockCount(f); ++k)
+				if (corrupt[frames.frameBlockIds(f)[k]]) broken[f] = true;
+		}
+
+		// Pass 2: prefix sum + scatter (entries are visited in order, so each list stays sorted)
+		postingStart.assign(nameIds + 1, 0);
+		for (size_t id = 0; id < nameIds; ++id) {
+			postingStart[id + 1] = postingStart[id] + counts[id];
+			if (counts[id]) ++distinctNames;
+		}
+		postings.resize(nameOf.size());
+		std::vector<uint32_t> cursor(postingStart.begin(), postingStart.end() - 1);
+		for (uint32_t e = 0; e < (uint32_t)nameOf.size(); ++e) postings[cursor[nameOf[e]]++] = e;
+	}
+
+	// Hits are returned sorted by (frame, primitive).
+	std::vector<SearchHit> query(const FrameStore& frames, const SearchQuery& q) const {
+		std::vector<SearchHit> hits;
+		if (frames.size() != frameCount || frames.distinctBlocks() + 1 != blockStart.size()) return hits; // index is stale
+
+		AABB region;
+		region.min = q.regionMin;
+		region.max = q.regionMax;
+
+		std::vector<uint64_t> marked((nameOf.size() + 63) / 64, 0);
+		bool any = false;
+		auto mark = [&](uint32_t e) {
+			if (!(q.typeMask & (1u << typeOf[e]))) return;
+			if (q.useRegion && !entryBounds[e].overlaps(region)) return;
+			marked[e >> 6] |= 1ull << (e & 63);
+			any = true;
+		};
+
+		if (!q.namePattern.empty()) {
+			// Names interned after build() have no postings here
+			const NameTable& names = Frame::names();
+			const uint32_t indexedNames = static_cast<uint32_t>(postingStart.size() - 1);
+			if (q.namePattern.find_first_of("*?") == std::string::npos) {
+				uint32_t id = names.find(q.namePattern);
+				if (id < indexedNames)
+					for (uint32_t k = postingStart[id]; k < postingStart[id + 1]; ++k) mark(postings[k]);
+			}
+			else {
+				for (uint32_t id = 0; id < indexedNames; ++id)
+					if (postingStart[id] != postingStart[id + 1] && globMatch(q.namePattern, names.name(id)))
+						for (uint32_t k = postingStart[id]; k < postingStart[id + 1]; ++k) mark(postings[k]);
+			}
+		}
+		else {
+			for (uint32_t e = 0; e < (uint32_t)nameOf.size(); ++e) mark(e);
+		}
+		if (!any) return hits;
+
+		// Blocks with a marked entry, so frames skip the others by their count alone
+		std::vector<bool> blockMarked(blockStart.size() - 1);
+		for (size_t b = 0; b + 1 < blockStart.size(); ++b)
+			for (uint32_t e = blockStart[b]; e < blockStart[b + 1] && !blockMarked[b]; ++e)
+				blockMarked[b] = (marked[e >> 6] >> (e & 63)) & 1;
+
+		for (uint32_t f = 0; f < (uint32_t)frames.size(); ++f) {
+			if (broken[f] || (q.useRegion && !frames.bounds(f).overlaps(region))) continue;
+			const uint32_t* ids = frames.frameBlockIds(f);
+			uint32_t offset = 0;
+			for (size_t k = 0; k < frames.frameBlockCount(f); ++k) {
+				const uint32_t b = ids[k];
+				if (blockMarked[b]) {
+					for (uint32_t e = blockStart[b]; e < blockStart[b + 1]; ++e)
+						if (marked[e >> 6] & (1ull << (e & 63))) hits.push_back({ f, offset + (e - blockStart[b]), e });
+				}
+				offset += blockStart[b + 1] - blockStart[b];
+			}
+		}
+		return hits;
+	}
+
+	// Row data for a hit of the last query(), taken from the index instead of the frame
+	const std::string& name(const SearchHit& h) const { return Frame::names().name(nameOf[h.entry]); }
+	PrimType type(const SearchHit& h) const { return (PrimType)typeOf[h.entry]; }
+	const AABB& bounds(const SearchHit& h) const { return entryBounds[h.entry]; }
+
+	uint64_t primitiveCount() const { return totalPrimitives; }
+	size_t nameCount() const { return distinctNames; }
+
+	size_t memoryBytes() const {
+		return postingStart.capacity() * sizeof(uint32_t) + postings.capacity() * sizeof(uint32_t) +
+			blockStart.capacity() * sizeof(uint32_t) + nameOf.capacity() * sizeof(uint32_t) + typeOf.capacity() +
+			entryBounds.capacity() * sizeof(AABB) + broken.capacity() / 8;
+	}
+
+private:
+	size_t distinctNames = 0;
+	uint64_t totalPrimitives = 0;
+	size_t frameCount = 0;
+	std::vector<uint32_t> postingStart;   // CSR offsets, name ids + 1
+	std::vector<uint32_t> postings;       // entries by name
+	std::vector<uint32_t> blockStart;     // first entry of each FrameStore block, blocks + 1
+	std::vector<uint32_t> nameOf;         // name id by entry
+	std::vector<uint8_t> typeOf;          // PrimType by entry
+	std::vector<AABB> entryBounds;        // primitive AABB by entry
+	std::vector<bool> broken;             // frames with a block that failed to decode
+};
+
+#endif // SEARCH_INDEX_H
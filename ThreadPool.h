@@ -0,0 +1,172 @@
+// ThreadPool.h
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a FIFO of tasks. One process-wide
+// instance (shared()) backs all background analysis so the app never
+// oversubscribes the cores.
+class ThreadPool {
+public:
+	explicit ThreadPool(unsigned threads = 0) {
+		if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned i = 0; i < threads; ++i)
+			workers.emplace_back([this] { run(); });
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto& t : workers) t.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	static ThreadPool& shared() {
+		static ThreadPool pool;
+		return pool;
+	}
+
+	unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+	void submit(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push_back(std::move(task));
+		}
+		wake.notify_one();
+	}
+
+	// Runs fn(begin, end) over [0, count) in chunks of `grain` and blocks until
+	// all chunks are done. The calling thread works too, so nesting is safe.
+	template <class Fn>
+	void parallelFor(size_t count, size_t grain, Fn&& fn) {
+		if (count == 0) return;
+		grain = std::max<size_t>(1, grain);
+		const size_t chunks = (count + grain - 1) / grain;
+		if (chunks == 1) {
+			fn(size_t(0), count);
+			return;
+		}
+
+		struct Shared {
+			std::atomic<size_t> next{ 0 };
+			std::atomic<size_t> done{ 0 };
+			std::mutex m;
+			std::condition_variable cv;
+		};
+		auto state = std::make_shared<Shared>();
+
+		auto drain = [state, chunks, grain, count, &fn] {
+			size_t c;
+			while ((c = state->next.fetch_add(1)) < chunks) {
+				fn(c * grain, std::min(count, (c + 1) * grain));
+				if (state->done.fetch_add(1) + 1 == chunks) {
+					std::lock_guard<std::mutex> lock(state->m);
+					state->cv.notify_all();
+				}
+			}
+		};
+
+		const size_t helpers = std::min<size_t>(size(), chunks - 1);
+		for (size_t i = 0; i < helpers; ++i) submit(drain);
+		drain();
+
+		std::unique_lock<std::mutex> lock(state->m);
+		state->cv.wait(lock, [&] { return state->done.load() == chunks; });
+	}
+
+private:
+	void run() {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+				if (stopping && tasks.empty()) return;
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+};
+
+// One-shot job on a pool whose result the UI thread polls each frame.
+template <class T>
+class BackgroundTask {
+public:
+	~BackgroundTask() { wait(); }
+
+	template <class Fn>
+	void start(ThreadPool& pool, Fn fn) {
+		wait();
+		auto s = std::make_shared<State>();
+		state = s;
+		pool.submit([s, fn]() mutable {
+			T value = fn();
+			std::lock_guard<std::mutex> lock(s->m);
+			s->value = std::move(value);
+			s->done = true;
+			s->cv.notify_all();
+		});
+	}
+
+	bool running() const {
+		if (!state) return false;
+		std::lock_guard<std::mutex> lock(state->m);
+		return !state->done;
+	}
+
+	// True once; the result is moved into `out`.
+	bool poll(T& out) {
+		if (!state) return false;
+		{
+			std::lock_guard<std::mutex> lock(state->m);
+			if (!state->done) return false;
+			out = std::move(state->value);
+		}
+		state.reset();
+		return true;
+	}
+
+	// Blocks until the job (if any) finished; its result is discarded.
+	void wait() {
+		if (!state) return;
+		std::unique_lock<std::mutex> lock(state->m);
+		state->cv.wait(lock, [this] { return state->done; });
+		lock.unlock();
+		state.reset();
+	}
+
+private:
+	struct State {
+		std::mutex m;
+		std::condition_variable cv;
+		bool done = false;
+		T value;
+	};
+	std::shared_ptr<State> state;
+};
+
+#endif // THREAD_POOL_H
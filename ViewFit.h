@@ -0,0 +1,44 @@
+// ViewFit.h
+#ifndef VIEW_FIT_H
+#define VIEW_FIT_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+#include "Bounds.h"
+#include "Scene.h"
+#include "FrameStore.h"
+
+// Bounds of what is on screen: one frame (or all frames) plus the overlay, from the caches
+static inline AABB sceneBounds(const FrameStore& frames, int frame, bool allFrames, const AABB& allFramesBounds,
+	const std::vector<Primitive>& overlay) {
+	AABB bounds;
+	if (!frames.empty())
+		bounds = allFrames ? allFramesBounds : frames.bounds(frame);
+	for (const auto& prim : overlay)
+		bounds.merge(prim.bounds);
+	return bounds;
+}
+
+// Orbit target and distance that show all of `bounds`; false (unchanged) when empty.
+static inline bool fitBounds(const AABB& bounds, glm::vec3& target, float& distance) {
+	if (!bounds.valid()) return false;
+	target = bounds.center();
+	distance = std::max(bounds.radius(), 1.0f) * 2.0f;
+	return true;
+}
+
+// Near/far planes around the bounding sphere of `bounds` seen from `eye`.
+static inline bool clipPlanesFor(const AABB& bounds, const glm::vec3& eye, float& nearPlane, float& farPlane) {
+	if (!bounds.valid()) return false;
+
+	float radius = std::max(bounds.radius(), 1e-3f) * 1.05f;
+	float dist = glm::length(eye - bounds.center());
+
+	farPlane = dist + radius;
+	// Keep the near/far ratio bounded so depth precision survives when the camera is inside the bounds
+	nearPlane = std::max(dist - radius, farPlane * 1e-5f);
+	return true;
+}
+
+#endif // VIEW_FIT_H
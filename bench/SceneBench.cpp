@@ -0,0 +1,232 @@
+// SceneBench.cpp
+// Micro-benchmarks of the GL-free core over fixed synthetic inputs, so runs
+// are comparable between builds and machines. Each case reports the best
+// of N repeats: scenedebugger_bench [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SceneParser.h"
+#include "FrameStore.h"
+#include "Picking.h"
+#include "ViewFit.h"
+
+namespace {
+
+int g_Repeats = 5;
+
+template <class F>
+double bestSeconds(F&& run) {
+	double best = 1e30;
+	for (int r = 0; r < g_Repeats; ++r) {
+		const auto t0 = std::chrono::steady_clock::now();
+		run();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+	}
+	return best;
+}
+
+// One result row; zero columns are left blank.
+void report(const char* name, double seconds, double bytes, double items, const char* itemUnit) {
+	char mbs[32] = "", rate[48] = "", ns[32] = "";
+	if (bytes > 0) std::snprintf(mbs, sizeof(mbs), "%10.1f MB/s", bytes / seconds / (1 << 20));
+	if (items > 0) {
+		std::snprintf(rate, sizeof(rate), "%12.3g %s/s", items / seconds, itemUnit);
+		std::snprintf(ns, sizeof(ns), "%9.1f ns/%s", seconds * 1e9 / items, itemUnit);
+	}
+	std::printf("%-24s %9.3f ms %15s %22s %18s\n", name, seconds * 1e3, mbs, rate, ns);
+}
+
+std::mt19937 rng(12345);
+float uniform(float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); }
+
+std::string vec(const glm::vec3& p) {
+	char buf[96];
+	std::snprintf(buf, sizeof(buf), "[%.6f,%.6f,%.6f]", p.x, p.y, p.z);
+	return buf;
+}
+
+glm::vec3 randomPoint() { return glm::vec3(uniform(-100, 100), uniform(-100, 100), uniform(-100, 100)); }
+
+// Single-primitive commands of every type, half of them with a color
+std::string textLog(int frames, int perFrame, size_t& primitives) {
+	std::string out;
+	primitives = 0;
+	for (int f = 0; f < frames; ++f) {
+		out += "framestart()\n";
+		for (int i = 0; i < perFrame; ++i, ++primitives) {
+			const glm::vec3 p = randomPoint();
+			const std::string name = "\"obj" + std::to_string(i) + "\" ";
+			switch (i % 4) {
+			case 0: out += "drawtriangle " + name + vec(p) + vec(p + glm::vec3(1, 0, 0)) + vec(p + glm::vec3(0, 1, 0)); break;
+			case 1: out += "drawline " + name + vec(p) + vec(p + glm::vec3(0, 0, 2)); break;
+			case 2: out += "drawpoint " + name + vec(p); break;
+			default: out += "drawbox " + name + vec(p) + vec(p + glm::vec3(1)); break;
+			}
+			if (i % 2) out += " [0.2,0.4,0.8,1]";
+			out += "\n";
+		}
+		out += "frameend()\n";
+	}
+	return out;
+}
+
+std::string base64(const void* data, size_t size) {
+	static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	std::string out;
+	out.reserve((size + 2) / 3 * 4);
+	for (size_t i = 0; i < size; i += 3) {
+		const uint32_t v = (p[i] << 16) | (i + 1 < size ? p[i + 1] << 8 : 0) | (i + 2 < size ? p[i + 2] : 0);
+		out += alphabet[(v >> 18) & 63];
+		out += alphabet[(v >> 12) & 63];
+		out += i + 1 < size ? alphabet[(v >> 6) & 63] : '=';
+		out += i + 2 < size ? alphabet[v & 63] : '=';
+	}
+	return out;
+}
+
+// One drawtriangles command per frame with a base64 payload
+std::string bulkLog(int frames, int trianglesPerFrame, size_t& primitives) {
+	std::string out;
+	std::vector<float> coords;
+	primitives = 0;
+	for (int f = 0; f < frames; ++f) {
+		coords.clear();
+		for (int t = 0; t < trianglesPerFrame * 9; ++t) coords.push_back(uniform(-100, 100));
+		out += "framestart()\ndrawtriangles \"terrain\" b64:" + base64(coords.data(), coords.size() * sizeof(float)) + "\nframeend()\n";
+		primitives += trianglesPerFrame;
+	}
+	return out;
+}
+
+// Application log lines with an occasional command
+std::string noisyLog(size_t bytes, size_t& primitives) {
+	std::string out;
+	primitives = 0;
+	int line = 0;
+	while (out.size() < bytes) {
+		if (line % 50 == 0) out += "framestart()\n";
+		if (line % 10 == 0) {
+			out += "drawpoint \"probe\" " + vec(randomPoint()) + "\n";
+			++primitives;
+		}
+		out += "2024-05-01 12:00:00.123 INFO [solver] iteration " + std::to_string(line) + " residual 0.000123 converged=false\n";
+		if (line % 50 == 49) out += "frameend()\n";
+		++line;
+	}
+	out += "frameend()\n";
+	return out;
+}
+
+// n x n vertex grid as quads
+std::string objGrid(int n, size_t& triangles) {
+	std::string out;
+	char buf[128];
+	for (int y = 0; y < n; ++y)
+		for (int x = 0; x < n; ++x) {
+			std::snprintf(buf, sizeof(buf), "v %d %d %.4f\n", x, y, uniform(0, 1));
+			out += buf;
+		}
+	for (int y = 0; y + 1 < n; ++y)
+		for (int x = 0; x + 1 < n; ++x) {
+			const int i = y * n + x + 1;
+			std::snprintf(buf, sizeof(buf), "f %d %d %d %d\n", i, i + 1, i + n + 1, i + n);
+			out += buf;
+		}
+	triangles = size_t(n - 1) * (n - 1) * 2;
+	return out;
+}
+
+void benchParse(const char* name, const std::string& text, size_t primitives) {
+	FrameStore frames;
+	const double s = bestSeconds([&] {
+		frames.clear();
+		parseInputData(text, frames);
+	});
+	report(name, s, (double)text.size(), (double)primitives, "prim");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	if (argc > 1) g_Repeats = std::max(1, std::atoi(argv[1]));
+	std::printf("%-24s %12s %15s %22s %18s\n", "case", "best", "throughput", "rate", "per item");
+
+	size_t primitives = 0;
+	const std::string text = textLog(100, 5000, primitives);
+	benchParse("parse text commands", text, primitives);
+
+	const std::string bulk = bulkLog(50, 20000, primitives);
+	benchParse("parse bulk base64", bulk, primitives);
+
+	const std::string noise = noisyLog(size_t(64) << 20, primitives);
+	benchParse("parse noisy log", noise, primitives);
+
+	size_t triangles = 0;
+	const std::string obj = objGrid(700, triangles);
+	std::vector<Primitive> overlay;
+	report("parse OBJ", bestSeconds([&] { parseOBJData(obj, overlay); }), (double)obj.size(), (double)triangles, "tri");
+
+	// Frame decode with nothing cached
+	FrameStore frames;
+	parseInputData(text, frames);
+	frames.setBudget(0);
+	const double decodeSeconds = bestSeconds([&] {
+		for (size_t f = 0; f < frames.size(); ++f) frames[f];
+	});
+	report("frame decode", decodeSeconds, (double)frames.stats().rawBytes, (double)frames.size(), "frame");
+
+	// Bounds of a large frame
+	Frame big;
+	for (int i = 0; i < 1000000; ++i) {
+		const glm::vec3 p = randomPoint();
+		const glm::vec3 tri[3] = { p, p + glm::vec3(1, 0, 0), p + glm::vec3(0, 1, 0) };
+		big.add(PrimType::Triangle, 0, tri, glm::vec4(1));
+	}
+	report("frame bounds", bestSeconds([&] { big.computeBounds(); }), 0, (double)big.size(), "prim");
+
+	AABB all;
+	for (size_t f = 0; f < frames.size(); ++f) all.merge(frames.bounds(f));
+	glm::vec3 target;
+	float distance = 0;
+	volatile float sink = 0;
+	const int fits = 1000000;
+	report("fit view", bestSeconds([&] {
+		for (int i = 0; i < fits; ++i) {
+			fitBounds(sceneBounds(frames, i % (int)frames.size(), false, all, overlay), target, distance);
+			sink = sink + distance;
+		}
+	}), 0, fits, "query");
+
+	// Picking math over fixed random rays and primitives
+	const int queries = 2000000;
+	std::vector<glm::vec3> origins(1024), dirs(1024), verts(3 * 1024);
+	for (int i = 0; i < 1024; ++i) {
+		origins[i] = randomPoint();
+		dirs[i] = glm::normalize(randomPoint() - origins[i]);
+		for (int k = 0; k < 3; ++k) verts[3 * i + k] = randomPoint();
+	}
+	int hits = 0;
+	report("rayTriangleIntersect", bestSeconds([&] {
+		for (int q = 0; q < queries; ++q) {
+			const int r = q & 1023, t = (q * 7) & 1023;
+			float tHit;
+			hits += rayTriangleIntersect(origins[r], dirs[r], verts[3 * t], verts[3 * t + 1], verts[3 * t + 2], tHit);
+		}
+	}), 0, queries, "query");
+	float acc = 0;
+	report("raySegmentDist2", bestSeconds([&] {
+		for (int q = 0; q < queries; ++q) {
+			const int r = q & 1023, t = (q * 7) & 1023;
+			acc += raySegmentDist2(origins[r], dirs[r], verts[3 * t], verts[3 * t + 1]);
+		}
+	}), 0, queries, "query");
+	sink = sink + acc + (float)hits;
+	return 0;
+}
@@ -3,6 +3,7 @@ out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
+in vec4 VertexColor;
 
 uniform vec4 primitiveColor;
 uniform vec3 lightPos;
@@ -10,9 +11,16 @@ uniform vec3 viewPos;
 
 // NEW: Controls whether to apply lighting or not
 uniform bool useLighting;
+// Color from the vertex instead of primitiveColor (point clouds)
+uniform bool useVertexColor;
 
 void main()
 {
+	if (useVertexColor) {
+		FragColor = VertexColor;
+		return;
+	}
+
 	if (!useLighting) {
 		// No lighting, just use the RGBA color as-is
 		FragColor = primitiveColor;
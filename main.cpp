@@ -10,6 +10,12 @@
 #include <cfloat>
 #include <cmath>
 #include <random>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
 
 // Include ImGui
 #include "imgui.h"
@@ -23,17 +29,37 @@
 // Include custom headers
 #include "Camera.h"
 #include "Shader.h"
+#include "Scene.h"
+#include "SearchIndex.h"
+#include "IdentityTracker.h"
+#include "FrameDiff.h"
+#include "Intersections.h"
+#include "Clearance.h"
+#include "FrameDrawBuffer.h"
+#include "FrameStore.h"
+#include "SceneParser.h"
+#include "Picking.h"
+#include "Palette.h"
+#include "ViewFit.h"
+#include "SceneGenerator.h"
+#include "Profiler.h"
+#include "GpuTimer.h"
+#include "HeadlessContext.h"
+#include "RenderBench.h"
+#include "Playback.h"
+#include "PositionBuffer.h"
+#include "OnionSkin.h"
+#include "PointCloud.h"
+#include "SceneLabels.h"
 
 // Forward declarations
 void processInput(GLFWwindow* window);
 void renderScene(Shader& shaderProgram);
-void parseInputData(const std::string& data);
-void parseOBJData(const std::string& data);
+bool loadCaptureFile(const std::string& path);
+bool loadCompareFile(const std::string& path);
 void renderGUI();
 void fitDataIntoView();
-bool rayTriangleIntersect(const glm::vec3& orig, const glm::vec3& dir,
-	const glm::vec3& v0, const glm::vec3& v1,
-	const glm::vec3& v2, float& tOut);
+void updateClipPlanes();
 
 void mouse_button_callback(GLFWwindow* window,
 	int button, int action, int mods);
@@ -45,37 +71,68 @@ struct Vector3 {
 	float x, y, z;
 };
 
-struct Vertex {
-	glm::vec3 position;
-	glm::vec3 normal;
-};
-
-struct Primitive {
-	std::string name;
-	std::string type; // "drawtriangle", "drawline", "drawpoint", "drawbox", "overlaymesh"
-	std::string displayCoords;
-	std::vector<Vertex> vertices;
-	std::vector<unsigned int> indices; // For indexed drawing (overlaymesh)
-	glm::vec4 color;
-};
-
-void renderPrimitives(Shader& shaderProgram, const std::vector<Primitive>& primitives, int selectedIndex);
-
-struct Frame {
-	std::vector<Primitive> primitives;
-};
-
-std::vector<Frame> frames;
+void renderOverlayPrimitives(Shader& shaderProgram, const std::vector<Primitive>& primitives);
+void renderFramePrimitives(Shader& shaderProgram, const FrameStore::FramePtr& frame, int selectedIndex);
+void renderPointCloud(Shader& shaderProgram, const FrameStore::FramePtr& frame, int selectedIndex);
+void renderFrameDiff(Shader& shaderProgram, const std::shared_ptr<const FrameDiffResult>& diff);
+void renderIntersections(Shader& shaderProgram);
+void renderClearance(Shader& shaderProgram);
+void renderMeasurement(Shader& shaderProgram);
+void renderLabels(SceneLabels& labels, const Frame& frame, int selectedIndex);
+void renderComparePane(Shader& shaderProgram);
+void renderTrajectory(Shader& shaderProgram);
+
+// Every captured frame, compressed; frames[i] decodes on demand (see FrameStore.h).
+FrameStore frames;
+static int g_FrameBudgetMB = 512;      // decoded frames kept in memory
+static int g_PositionBits = framecodec::kLosslessBits;   // position quantization for newly loaded frames; 32 = exact
+static std::string g_LoadStatus;       // result of the last file load
 std::vector<Primitive> overlayPrimitives;
 int currentFrameIndex = 0;
 Camera camera;
 bool fitView = true;
+bool fitAllFrames = false;       // with fitView: frame the union of every frame instead of the current one
+bool autoClipPlanes = true;      // derive near/far from the cached scene bounds each frame
+AABB allFramesBounds;            // union of all frame bounds, refreshed on load
 bool depthTestNonOverlay = true;
 int g_SelectedPrimitive = -1;   // index within current frame, -1 = none
 static int  g_PrevSelected = -1;
 static bool g_RequestScrollToSelection = false;
 static bool g_PrimitiveListActive = false;
 
+// Cross-frame identity of the selection, followed when the frame changes
+IdentityTracker identityTracker;
+static PrimitiveIdentity g_TrackedIdentity;
+static bool g_KeepSelectionAcrossFrames = true;
+static bool g_ShowTrajectory = false;
+// Centroid path of the tracked identity over the frames indexed so far (see updateTrajectory)
+static std::vector<glm::vec3> g_TrajectoryPath;
+static AABB g_TrajectoryBounds;                  // of g_TrajectoryPath, for the clip planes
+static PrimitiveIdentity g_TrajectoryIdentity;   // identity the path follows
+static size_t g_TrajectoryFrames = 0;            // frames the path covers
+static size_t g_TrajectoryUploaded = 0;          // points in g_TrajectoryDraw
+static PositionBuffer g_TrajectoryDraw;
+
+static void clearTrajectory() {
+	g_TrajectoryPath.clear();
+	g_TrajectoryBounds = AABB();
+	g_TrajectoryIdentity = PrimitiveIdentity();
+	g_TrajectoryFrames = g_TrajectoryUploaded = 0;
+}
+
+// Restarts the path when the tracked identity changes and extends it over the
+// frames indexed since the last call; both read the tracker's centroids only.
+static void updateTrajectory() {
+	const PrimitiveIdentity& id = g_TrackedIdentity;
+	if (id.valid != g_TrajectoryIdentity.valid || id.nameId != g_TrajectoryIdentity.nameId || id.duplicate != g_TrajectoryIdentity.duplicate) {
+		clearTrajectory();
+		g_TrajectoryIdentity = id;
+	}
+	const size_t known = g_TrajectoryPath.size();
+	g_TrajectoryFrames = identityTracker.extendTrajectory(g_TrajectoryIdentity, g_TrajectoryFrames, g_TrajectoryPath);
+	for (size_t k = known; k < g_TrajectoryPath.size(); ++k) g_TrajectoryBounds.expand(g_TrajectoryPath[k]);
+}
+
 // whenever you set g_SelectedPrimitive (from picking or list click), do:
 auto setSelection = [](int idx) {
 	g_PrevSelected = g_SelectedPrimitive;
@@ -83,162 +140,265 @@ auto setSelection = [](int idx) {
 		g_SelectedPrimitive = idx;
 		g_RequestScrollToSelection = true;   // ask GUI to scroll next frame
 	}
+	g_TrackedIdentity = frames.empty() ? PrimitiveIdentity() :
+		IdentityTracker::identify(*frames[currentFrameIndex], idx);
 	};
 
-// Create a random number generator and distribution
-std::mt19937 rng(std::random_device{}());
-std::uniform_real_distribution<float> colorDist(0.0f, 1.0f);
-
-// --- Stable "random" color from an integer id -------------------------------
-static inline uint32_t pcg_hash(uint32_t x) {
-	// PCG-inspired integer hash. Fast and decent distribution.
-	x ^= x >> 16;
-	x *= 0x7feb352dU;
-	x ^= x >> 15;
-	x *= 0x846ca68bU;
-	x ^= x >> 16;
-	return x;
+// Timed playback; the frames after the current one are prepared ahead while playing
+static PlaybackClock g_Playback;
+static FramePrefetcher g_Prefetcher;
+static int g_PrefetchFrames = 8;
+static double g_PlaybackLastTime = 0.0;
+static size_t g_PlaybackShown = 0, g_PlaybackMisses = 0;   // frames shown / shown before they were prepared
+
+// Switch frames; the tracked primitive stays selected if it exists in the new frame.
+static void setCurrentFrame(int idx) {
+	currentFrameIndex = idx;
+	frames.pin(currentFrameIndex, 1, std::max<size_t>(1, g_Prefetcher.window()));
+	if (!g_KeepSelectionAcrossFrames) {
+		setSelection(-1);
+		return;
+	}
+	int located = identityTracker.locate(frames, currentFrameIndex, g_TrackedIdentity);
+	g_PrevSelected = g_SelectedPrimitive;
+	if (located != g_SelectedPrimitive) {
+		g_SelectedPrimitive = located;   // keeps g_TrackedIdentity even when absent here
+		g_RequestScrollToSelection = true;
+	}
 }
 
-static inline void hsv2rgb(float H, float S, float V, float& r, float& g, float& b) {
-	// H in [0,1), S,V in [0,1]
-	float h = H * 6.0f;
-	int i = (int)h;
-	float f = h - i;
-	float p = V * (1.0f - S);
-	float q = V * (1.0f - S * f);
-	float t = V * (1.0f - S * (1.0f - f));
-	switch (i % 6) {
-	case 0: r = V; g = t; b = p; break;
-	case 1: r = q; g = V; b = p; break;
-	case 2: r = p; g = V; b = t; break;
-	case 3: r = p; g = q; b = V; break;
-	case 4: r = t; g = p; b = V; break;
-	case 5: r = V; g = p; b = q; break;
+static void togglePlayback() {
+	if (!g_Playback.playing()) {
+		if (!g_Playback.loop && currentFrameIndex + 1 >= (int)frames.size()) setCurrentFrame(0);
+		g_PlaybackShown = g_PlaybackMisses = 0;
+		g_PlaybackLastTime = glfwGetTime();
 	}
+	g_Playback.toggle();
 }
 
-// Optional: tweak to taste. Lower S gives more pastel, higher V gives brighter.
-static inline ImVec4 stableColorFromId(uint32_t id, float S = 0.65f, float V = 1.0f, float A = 1.0f) {
-	uint32_t h = pcg_hash(id);
-	// Use different hashed bits for hue/sat/val slight jitter (keeps variety)
-	float H = (h & 0xFFFFu) / 65535.0f;                 // hue in [0,1)
-	float sJit = ((h >> 16) & 0xFFu) / 255.0f * 0.10f;  // +/- 0.05 jitter
-	float vJit = ((h >> 24) & 0xFFu) / 255.0f * 0.10f;  // +/- 0.05 jitter
-	float r, g, b;
-	hsv2rgb(H, std::clamp(S - 0.05f + sJit, 0.3f, 0.9f),
-		std::clamp(V - 0.05f + vJit, 0.6f, 1.0f), r, g, b);
-	return ImVec4(r, g, b, A);
+// Once per UI frame: advance the playback clock, then prepare the frames after the new one.
+static void updatePlayback() {
+	const double now = glfwGetTime();
+	const double elapsed = now - g_PlaybackLastTime;
+	g_PlaybackLastTime = now;
+	if (!g_Playback.playing() || frames.empty()) {
+		if (g_Prefetcher.active()) {
+			g_Prefetcher.reset();
+			frames.pin(currentFrameIndex);
+		}
+		return;
+	}
+	const int next = g_Playback.advance(elapsed, currentFrameIndex, (int)frames.size());
+	if (next != currentFrameIndex) {
+		++g_PlaybackShown;
+		if (!g_Prefetcher.ready(next)) ++g_PlaybackMisses;
+		setCurrentFrame(next);
+	}
+	g_Prefetcher.update(frames, currentFrameIndex, g_PrefetchFrames, g_Playback.loop);
 }
 
-static inline std::string formatVec3(const glm::vec3& v) {
-	return "[" + std::to_string(v.x) + "," + std::to_string(v.y) + "," + std::to_string(v.z) + "]";
+// Name/type/region search over all loaded frames
+SearchIndex searchIndex;
+static char g_SearchPattern[256] = "";
+static bool g_SearchTypes[SearchIndex::TypeCount] = { true, true, true, true };
+static bool g_SearchUseRegion = false;
+static float g_SearchRegionMin[3] = { 0.0f, 0.0f, 0.0f };
+static float g_SearchRegionMax[3] = { 0.0f, 0.0f, 0.0f };
+static std::vector<SearchHit> g_SearchHits;
+static double g_SearchMillis = 0.0;
+
+// The frame cache gets "Frame cache (MB)" less what the capture's indexes
+// hold, but never under a quarter of it.
+static void applyFrameBudget() {
+	const size_t total = size_t(g_FrameBudgetMB) << 20;
+	const size_t indexes = identityTracker.memoryBytes() + searchIndex.memoryBytes();
+	const size_t budget = std::max(total / 4, total > indexes ? total - indexes : 0);
+	if (budget != frames.budget()) frames.setBudget(budget);
 }
 
-// If you want separation by primitive type too, combine like this:
-template <class T>
-static inline uint32_t hashCombine32(uint32_t a, T b) {
-	return pcg_hash(a ^ (uint32_t)pcg_hash((uint32_t)b + 0x9e3779b9u + (a << 6) + (a >> 2)));
+// Diff of the current frame against the previous one
+FrameDiffCache frameDiffCache(ThreadPool::shared());
+static bool g_ShowDiff = false;
+static bool g_DiffHideUnchanged = false;
+static float g_DiffQuantum = 1e-4f;   // vertex snap size; smaller moves count as unchanged
+
+static const glm::vec4 kDiffColors[(int)DiffState::Count] = {
+	glm::vec4(0.4f, 0.4f, 0.4f, 1.0f),    // Unchanged
+	glm::vec4(1.0f, 0.6f, 0.1f, 1.0f),    // Moved
+	glm::vec4(0.2f, 0.9f, 0.2f, 1.0f),    // Added
+	glm::vec4(0.9f, 0.15f, 0.15f, 1.0f),  // Removed
+};
+static const char* kDiffTags[(int)DiffState::Count] = { "=", "~", "+", "-" };
+
+// Triangle-triangle intersection analysis of the current frame
+static BackgroundTask<IntersectionReport> g_IntersectionTask;
+static IntersectionReport g_Intersections;
+static bool g_HasIntersections = false;
+static bool g_IntersectWithOverlay = true;
+static bool g_ShowIntersections = true;
+static std::vector<uint32_t> g_IntersectingPrims;           // sorted, unique
+static std::vector<glm::vec3> g_IntersectingOverlayTris;    // 3 positions per triangle
+static uint32_t g_IntersectionsVersion = 0;                 // bumped per report; the highlight is built once per version
+static uint32_t g_IntersectionsUploaded = UINT32_MAX;       // version in g_IntersectionOverlayDraw
+static FrameDrawBuffer g_IntersectionDraw;
+static PositionBuffer g_IntersectionOverlayDraw;
+
+// Overlay triangles as a BVH, built on first use; analysis jobs keep their own reference.
+static std::shared_ptr<const TriangleBvh> g_OverlayBvh;
+
+static std::shared_ptr<const TriangleBvh> overlayBvh() {
+	if (!g_OverlayBvh) g_OverlayBvh = buildMeshBvh(overlayPrimitives);
+	return g_OverlayBvh;
 }
 
+static void clearIntersections() {
+	g_HasIntersections = false;
+	g_Intersections = IntersectionReport();
+	g_IntersectingPrims.clear();
+	g_IntersectingOverlayTris.clear();
+	g_IntersectionDraw.invalidate();
+	g_IntersectionOverlayDraw.release();
+	g_IntersectionsUploaded = UINT32_MAX;
+}
 
-void parseOBJData(const std::string& data) {
-
-	// At the beginning of parseOBJData()
-	static GLuint overlayVAO = 0, overlayVBO = 0, overlayEBO = 0;
-
-	if (overlayVAO != 0) {
-		glDeleteVertexArrays(1, &overlayVAO);
-		glDeleteBuffers(1, &overlayVBO);
-		glDeleteBuffers(1, &overlayEBO);
-		overlayVAO = overlayVBO = overlayEBO = 0;
-	}
-
-
-	std::istringstream stream(data);
-	std::string line;
-
-	std::vector<Vertex> vertices; // Combined positions and normals
-	std::vector<unsigned int> indices;
-
-	std::vector<glm::vec3> objPositions; // Positions from 'v' lines
-	std::vector<std::vector<unsigned int>> faceIndices; // Indices for each face
+// Clearance between frame primitives and the overlay mesh
+static bool g_MeasureSelection = true;
+static ClearanceResult g_SelectionClearance;
+static int g_MeasuredFrame = -1, g_MeasuredPrimitive = -1;
+static BackgroundTask<ClearanceReport> g_ClearanceTask;
+static ClearanceReport g_Clearance;
+static uint32_t g_ClearanceVersion = 0;   // bumped per report, so its colors are baked once
+static bool g_HasClearance = false;
+static bool g_ShowClearance = true;
+static float g_ClearanceRange = 1.0f;   // distance at the far (blue) end of the color ramp
+
+static void clearClearance() {
+	g_SelectionClearance = ClearanceResult();
+	g_MeasuredFrame = g_MeasuredPrimitive = -1;
+	g_HasClearance = false;
+	g_Clearance = ClearanceReport();
+}
 
-	// Clear previous overlay data
-	overlayPrimitives.clear();
+// Call releaseOverlayIndices() before mutating `overlayPrimitives`.
+static void releaseOverlayIndices() {
+	g_IntersectionTask.wait();
+	g_ClearanceTask.wait();
+	g_OverlayBvh.reset();
+	clearIntersections();
+	clearClearance();
+}
 
-	while (std::getline(stream, line)) {
-		// Remove comments
-		size_t commentPos = line.find('#');
-		if (commentPos != std::string::npos) {
-			line = line.substr(0, commentPos);
-		}
+// Current frame (and its predecessor, for the diff view) on the GPU; g_AnalysisDraw
+// holds the current frame recolored by the diff or clearance view
+static FrameDrawBuffer g_FrameDraw, g_PreviousFrameDraw, g_AnalysisDraw;
+
+// Split view: the current frame on the left, on the right the frame
+// g_CompareOffset away in this capture or in a second one (e.g. a re-run).
+// Both panes are seen through the same camera; frames of one capture share
+// their GPU blocks, so a block common to both panes is uploaded once.
+static bool g_SplitView = false;
+static bool g_CompareOtherCapture = false;
+static int g_CompareOffset = 1;
+static FrameStore g_CompareFrames;
+static FrameDrawBuffer g_CompareFrameDraw;
+static std::string g_CompareStatus;
+static constexpr uint32_t kCompareBlockIdBase = 1u << 31;   // keeps its blocks apart from the main capture's
+
+// The right pane's capture, or null when it has no frames
+static FrameStore* compareStore() {
+	FrameStore* store = g_CompareOtherCapture && !g_CompareFrames.empty() ? &g_CompareFrames : &frames;
+	return store->empty() ? nullptr : store;
+}
 
-		std::istringstream linestream(line);
-		std::string prefix;
-		linestream >> prefix;
+static int compareFrameIndex(const FrameStore& store) {
+	return std::clamp(currentFrameIndex + g_CompareOffset, 0, (int)store.size() - 1);
+}
 
-		if (prefix == "v") {
-			// Vertex position
-			float x, y, z;
-			linestream >> x >> y >> z;
-			objPositions.push_back(glm::vec3(x, y, z));
-		}
-		else if (prefix == "f") {
-			// Face definition
-			std::vector<unsigned int> face;
-			std::string vertexStr;
-			while (linestream >> vertexStr) {
-				std::istringstream vertexStream(vertexStr);
-				std::string indexStr;
-				std::getline(vertexStream, indexStr, '/');
-				int index = std::stoi(indexStr);
-				face.push_back(index - 1); // OBJ indices start at 1
-			}
-			faceIndices.push_back(face);
-		}
-		// Ignore other prefixes (e.g., 'vn', 'vt')
-	}
+static void closeCompareCapture() {
+	g_CompareFrameDraw.invalidate();
+	FrameDrawBuffer::releaseBlocksFrom(kCompareBlockIdBase);
+	g_CompareFrames.clear();
+	g_CompareOtherCapture = false;
+}
 
-	// Calculate normals and build the vertex and index arrays
-	for (const auto& face : faceIndices) {
-		if (face.size() < 3) continue; // Skip degenerate faces
+// Picking in split view maps the cursor into the left pane; both panes show the same view.
+static void pickViewport(double& mx, int& w) {
+	if (!g_SplitView) return;
+	w = std::max(1, w / 2);
+	if (mx >= w) mx -= w;
+}
 
-		// Triangulate faces with more than 3 vertices
-		for (size_t i = 1; i < face.size() - 1; ++i) {
-			// Get vertex positions
-			glm::vec3 v0 = objPositions[face[0]];
-			glm::vec3 v1 = objPositions[face[i]];
-			glm::vec3 v2 = objPositions[face[i + 1]];
+// Neighbouring frames ghosted around the current one
+static OnionSkin g_OnionSkin;
+static bool g_ShowOnionSkin = false;
+static int g_OnionFrames = 3;
+static float g_OnionAlpha = 0.4f;
+
+// Point-cloud mode: frames with many points draw them from an LOD octree,
+// built on the pool for the current frame
+static bool g_PointCloudLod = true;
+static int g_PointCloudMinPoints = 200000;
+static float g_PointCloudPointSize = 2.0f;
+static PointCloudRenderer g_PointCloud;
+static BackgroundTask<std::shared_ptr<const PointOctree>> g_OctreeTask;
+static int g_OctreeTaskFrame = -1;
+
+// Primitive names at their centroids, up to g_LabelRange camera distances from the eye
+static SceneLabels g_Labels, g_CompareLabels;
+static bool g_ShowLabels = false;
+static float g_LabelRange = 3.0f;
+
+static bool isPointCloud(const Frame& frame) {
+	return g_PointCloudLod && frame.arrays(PrimType::Point).size() >= (size_t)g_PointCloudMinPoints;
+}
 
-			// Calculate face normal
-			glm::vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
+// Call releaseFrameIndices() before mutating `frames` and rebuildFrameIndices() after.
+static void releaseFrameIndices() {
+	g_Prefetcher.reset();
+	g_FrameDraw.invalidate();
+	g_PreviousFrameDraw.invalidate();
+	g_AnalysisDraw.invalidate();
+	g_IntersectionDraw.invalidate();
+	g_CompareFrameDraw.invalidate();
+	g_OnionSkin.release();
+	FrameDrawBuffer::releaseBlocks();
+	g_OctreeTask.wait();
+	g_PointCloud.release();
+	identityTracker.stop();
+	clearTrajectory();
+	frameDiffCache.reset();
+	g_IntersectionTask.wait();
+	g_ClearanceTask.wait();
+	clearIntersections();
+	clearClearance();
+}
 
-			// Create vertices with positions and normals
-			Vertex vertex0 = { v0, normal };
-			Vertex vertex1 = { v1, normal };
-			Vertex vertex2 = { v2, normal };
+// Names are interned per capture: the table (shared with the compare capture,
+// which goes too) is reset with the store, so it never outgrows what is loaded.
+static void clearFrames() {
+	closeCompareCapture();
+	frames.clear();
+	Frame::names().clear();
+	g_Labels.clear();
+	g_CompareLabels.clear();
+	frames.setPositionBits(g_PositionBits);
+}
 
-			// Add vertices and indices
-			unsigned int indexOffset = vertices.size();
-			vertices.push_back(vertex0);
-			vertices.push_back(vertex1);
-			vertices.push_back(vertex2);
+static void rebuildFrameIndices() {
+	allFramesBounds = AABB();
+	for (size_t f = 0; f < frames.size(); ++f) allFramesBounds.merge(frames.bounds(f));
+	frames.pin(currentFrameIndex);
+	g_SearchHits.clear();
+	searchIndex.build(frames);
+	identityTracker.start(frames);
+}
 
-			indices.push_back(indexOffset);
-			indices.push_back(indexOffset + 1);
-			indices.push_back(indexOffset + 2);
-		}
-	}
+// Create a random number generator and distribution
+std::mt19937 rng(std::random_device{}());
+std::uniform_real_distribution<float> colorDist(0.0f, 1.0f);
 
-	// Store the mesh data in the overlayPrimitives (as a single primitive)
-	Primitive meshPrim;
-	meshPrim.type = "overlaymesh";
-	meshPrim.name = "Overlay Mesh";
-	meshPrim.vertices = vertices;
-	meshPrim.indices = indices; // We need to add indices to the Primitive structure
-	// We can set a fixed color or leave it empty as we'll use lighting
-	overlayPrimitives.push_back(meshPrim);
+static inline std::string formatVec3(const glm::vec3& v) {
+	return "[" + std::to_string(v.x) + "," + std::to_string(v.y) + "," + std::to_string(v.z) + "]";
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
@@ -257,6 +417,7 @@ static void makePickRay(GLFWwindow* window, const Camera& cam, glm::vec3& rayOri
 	double mx, my; glfwGetCursorPos(window, &mx, &my);
 	int w, h;      glfwGetFramebufferSize(window, &w, &h);
 	if (h <= 0) { rayOrig = glm::vec3(0); rayDir = glm::vec3(0, 0, -1); return; }
+	pickViewport(mx, w);
 
 	float nx = (2.0f * float(mx) / float(w)) - 1.0f;
 	float ny = 1.0f - (2.0f * float(my) / float(h));
@@ -273,59 +434,6 @@ static void makePickRay(GLFWwindow* window, const Camera& cam, glm::vec3& rayOri
 	rayDir = glm::normalize(glm::vec3(pFar) - rayOrig);
 }
 
-// Distance from ray to segment (squared)
-static float raySegmentDist2(const glm::vec3& ro, const glm::vec3& rd,
-	const glm::vec3& a, const glm::vec3& b)
-{
-	// Based on closest points between two lines (ray and segment), clamped to segment.
-	const glm::vec3 u = rd;                 // normalized
-	const glm::vec3 v = b - a;              // segment direction
-	const glm::vec3 w0 = ro - a;
-	float aUU = glm::dot(u, u);             // =1, but keep general
-	float bUV = glm::dot(u, v);
-	float cVV = glm::dot(v, v);
-	float dUW0 = glm::dot(u, w0);
-	float eVW0 = glm::dot(v, w0);
-
-	float denom = aUU * cVV - bUV * bUV;
-	float sc = 0.f, tc = 0.f;
-	if (denom > 1e-12f) {
-		sc = (bUV * eVW0 - cVV * dUW0) / denom;   // along ray
-		tc = (aUU * eVW0 - bUV * dUW0) / denom;   // along segment
-	}
-	else {
-		// nearly parallel: project a→ray and clamp tc
-		sc = -dUW0 / aUU;
-		tc = 0.f;
-	}
-	tc = glm::clamp(tc, 0.f, 1.f);
-	// closest points
-	glm::vec3 Pc = ro + sc * u;
-	glm::vec3 Qc = a + tc * v;
-	return glm::dot(Pc - Qc, Pc - Qc);
-}
-
-// Distance from ray to point (squared)
-static float rayPointDist2(const glm::vec3& ro, const glm::vec3& rd, const glm::vec3& p)
-{
-	glm::vec3 w = p - ro;
-	float t = glm::dot(w, rd);          // along ray
-	glm::vec3 closest = ro + t * rd;
-	glm::vec3 d = p - closest;
-	return glm::dot(d, d);
-}
-
-// Convert a constant pixel radius to world units at depth d.
-// Assumes 45° vertical FOV like Camera::getProjectionMatrix.
-static float pixelRadiusToWorld(float pixels, float depth, int viewportHeight)
-{
-	// size of 1 pixel at depth d: (2 * d * tan(fov/2)) / H
-	const float fovY_deg = 45.0f;
-	const float fovY = glm::radians(fovY_deg);
-	float pixelWorld = (2.0f * depth * tanf(fovY * 0.5f)) / float(std::max(1, viewportHeight));
-	return pixels * pixelWorld;
-}
-
 void mouse_button_callback(GLFWwindow* window,
 	int button, int action, int /*mods*/)
 {
@@ -353,6 +461,7 @@ void mouse_button_callback(GLFWwindow* window,
 
 			if (dt <= maxClickTime && drag2 <= maxDrag2) {
 				// Perform picking
+				profiler::Scope scope("picking");
 				int w, h; glfwGetFramebufferSize(window, &w, &h);
 				if (h > 0 && !frames.empty()) {
 					Camera* cam = static_cast<Camera*>(glfwGetWindowUserPointer(window));
@@ -363,60 +472,56 @@ void mouse_button_callback(GLFWwindow* window,
 					float depthGuess = glm::length(cam->getPosition() - cam->target);
 					float pickRadius = pixelRadiusToWorld(6.0f, depthGuess, h); // ~6px
 
-					const auto& f = frames[currentFrameIndex];
+					const auto current = frames[currentFrameIndex];
+					const Frame& f = *current;
 					int bestIdx = -1;
 					float bestMetric = 1e30f; // smaller is better
 
 					// Triangles: normal ray-triangle hit (use t as metric)
-					for (size_t i = 0; i < f.primitives.size(); ++i) {
-						const auto& prim = f.primitives[i];
-						if (prim.type == "drawtriangle" && prim.vertices.size() >= 3) {
-							float t;
-							if (rayTriangleIntersect(ro, rd,
-								prim.vertices[0].position,
-								prim.vertices[1].position,
-								prim.vertices[2].position, t))
-							{
-								if (t < bestMetric) {
-									bestMetric = t;
-									bestIdx = (int)i;
-								}
-							}
+					const auto& tris = f.arrays(PrimType::Triangle);
+					for (size_t s = 0; s < tris.size(); ++s) {
+						const glm::vec3* v = &tris.positions[3 * s];
+						float t;
+						if (rayTriangleIntersect(ro, rd, v[0], v[1], v[2], t) && t < bestMetric) {
+							bestMetric = t;
+							bestIdx = (int)tris.primitives[s];
 						}
 					}
 
 					// Lines/boxes: ray-to-segment distance < pickRadius
-					for (size_t i = 0; i < f.primitives.size(); ++i) {
-						const auto& prim = f.primitives[i];
-						if ((prim.type == "drawline" || prim.type == "overlayline" || prim.type == "drawbox") && prim.vertices.size() >= 2) {
-							for (size_t j = 0; j + 1 < prim.vertices.size(); j += 2) {
-								float d2 = raySegmentDist2(ro, rd,
-									prim.vertices[j].position,
-									prim.vertices[j + 1].position);
-								if (d2 < pickRadius * pickRadius) {
-									// Use distance along ray to a midpoint as tie-breaker
-									glm::vec3 mid = 0.5f * (prim.vertices[j].position + prim.vertices[j + 1].position);
-									float t = glm::dot((mid - ro), rd);
-									if (t > 0.0f && t < bestMetric) {
-										bestMetric = t;
-										bestIdx = (int)i;
-									}
-								}
+					auto trySegment = [&](const glm::vec3& a, const glm::vec3& b, uint32_t prim) {
+						float d2 = raySegmentDist2(ro, rd, a, b);
+						if (d2 < pickRadius * pickRadius) {
+							// Use distance along ray to a midpoint as tie-breaker
+							glm::vec3 mid = 0.5f * (a + b);
+							float t = glm::dot((mid - ro), rd);
+							if (t > 0.0f && t < bestMetric) {
+								bestMetric = t;
+								bestIdx = (int)prim;
 							}
 						}
+						};
+					const auto& lines = f.arrays(PrimType::Line);
+					for (size_t s = 0; s < lines.size(); ++s)
+						trySegment(lines.positions[2 * s], lines.positions[2 * s + 1], lines.primitives[s]);
+					const auto& boxes = f.arrays(PrimType::Box);
+					for (size_t s = 0; s < boxes.size(); ++s) {
+						glm::vec3 edges[24];
+						boxEdges(boxes.positions[2 * s], boxes.positions[2 * s + 1], edges);
+						for (int j = 0; j < 24; j += 2)
+							trySegment(edges[j], edges[j + 1], boxes.primitives[s]);
 					}
 
 					// Points: ray-to-point distance < pickRadius
-					for (size_t i = 0; i < f.primitives.size(); ++i) {
-						const auto& prim = f.primitives[i];
-						if (prim.type == "drawpoint" && !prim.vertices.empty()) {
-							float d2 = rayPointDist2(ro, rd, prim.vertices[0].position);
-							if (d2 < pickRadius * pickRadius) {
-								float t = glm::dot((prim.vertices[0].position - ro), rd);
-								if (t > 0.0f && t < bestMetric) {
-									bestMetric = t;
-									bestIdx = (int)i;
-								}
+					const auto& points = f.arrays(PrimType::Point);
+					for (size_t s = 0; s < points.size(); ++s) {
+						const glm::vec3& p = points.positions[s];
+						float d2 = rayPointDist2(ro, rd, p);
+						if (d2 < pickRadius * pickRadius) {
+							float t = glm::dot((p - ro), rd);
+							if (t > 0.0f && t < bestMetric) {
+								bestMetric = t;
+								bestIdx = (int)points.primitives[s];
 							}
 						}
 					}
@@ -448,6 +553,7 @@ void mouse_button_callback(GLFWwindow* window,
 	double mx, my; glfwGetCursorPos(window, &mx, &my);
 	int w, h;      glfwGetFramebufferSize(window, &w, &h);
 	if (h == 0) return;
+	pickViewport(mx, w);
 
 	// Get camera from window user-ptr
 	Camera* cam = static_cast<Camera*>(glfwGetWindowUserPointer(window));
@@ -495,12 +601,10 @@ void mouse_button_callback(GLFWwindow* window,
 
 	// 2) triangles in the current frame
 	if (!frames.empty()) {
-		const Frame& f = frames[currentFrameIndex];
-		for (const auto& prim : f.primitives)
-			if (prim.type == "drawtriangle")
-				tryTriangle(prim.vertices[0].position,
-					prim.vertices[1].position,
-					prim.vertices[2].position);
+		const auto frame = frames[currentFrameIndex];
+		const auto& tris = frame->arrays(PrimType::Triangle);
+		for (size_t i = 0; i + 2 < tris.positions.size(); i += 3)
+			tryTriangle(tris.positions[i], tris.positions[i + 1], tris.positions[i + 2]);
 	}
 
 	//--------------------------------------------------------------  
@@ -511,12 +615,12 @@ void mouse_button_callback(GLFWwindow* window,
 }
 
 void key_callback(GLFWwindow* /*window*/, int key, int /*scancode*/,
-	int action, int /*mods*/)
+	int action, int mods)
 {
 	if (action != GLFW_PRESS && action != GLFW_REPEAT) return;   // only react to press / repeat
 
 	if (!frames.empty() && g_PrimitiveListActive && (key == GLFW_KEY_UP || key == GLFW_KEY_DOWN)) {
-		const int primitiveCount = static_cast<int>(frames[currentFrameIndex].primitives.size());
+		const int primitiveCount = static_cast<int>(frames.primitiveCount(currentFrameIndex));
 		if (primitiveCount > 0) {
 			int selected = g_SelectedPrimitive;
 			if (selected < 0) {
@@ -538,26 +642,321 @@ void key_callback(GLFWwindow* /*window*/, int key, int /*scancode*/,
 
 	if (frames.empty()) return;
 
-	if (key == GLFW_KEY_RIGHT || key == GLFW_KEY_PERIOD) {
+	if (key == GLFW_KEY_SPACE) {
+		if (action == GLFW_PRESS) togglePlayback();
+	}
+	else if (key == GLFW_KEY_RIGHT || key == GLFW_KEY_PERIOD) {
 		if (currentFrameIndex < static_cast<int>(frames.size()) - 1)
 		{
-			++currentFrameIndex;
-			setSelection(-1);
+			setCurrentFrame(currentFrameIndex + 1);
 		}
 	}
 	else if (key == GLFW_KEY_LEFT || key == GLFW_KEY_COMMA) {
 		if (currentFrameIndex > 0)
 		{
-			--currentFrameIndex;
-			setSelection(-1);
+			setCurrentFrame(currentFrameIndex - 1);
 		}
 	}
 	else if (key == GLFW_KEY_F) {
 		fitView = true;
+		fitAllFrames = (mods & GLFW_MOD_SHIFT) != 0;
+	}
+}
+
+void drop_callback(GLFWwindow* /*window*/, int count, const char** paths) {
+	if (count > 0) loadCaptureFile(paths[0]);
+}
+
+// Camera matrices and lighting for a width x height target
+static void setCameraUniforms(Shader& shaderProgram, int width, int height) {
+	if (height == 0) height = 1; // Prevent division by zero
+	float aspectRatio = width / (float)height;
+
+	if (autoClipPlanes)
+		updateClipPlanes();
+
+	glm::mat4 projection = camera.getProjectionMatrix(aspectRatio, camera.nearPlane, camera.farPlane);
+	glm::mat4 view = camera.getViewMatrix();
+	glm::mat4 model = glm::mat4(1.0f); // Identity matrix
+
+	shaderProgram.setMat4("projection", projection);
+	shaderProgram.setMat4("view", view);
+	shaderProgram.setMat4("model", model);
+
+	// Set lighting uniforms
+	glm::vec3 lightPos = camera.target + glm::vec3(0.0f, 10.0f, 10.0f);
+	glm::vec3 viewPos = camera.getPosition();
+	shaderProgram.setVec3("lightPos", lightPos);
+	shaderProgram.setVec3("viewPos", viewPos);
+}
+
+// Split view draws the current frame into the left half and the compare
+// frame into the right one, under the same camera.
+static void renderViews(Shader& shaderProgram, int width, int height) {
+	if (!g_SplitView) {
+		setCameraUniforms(shaderProgram, width, height);
+		renderScene(shaderProgram);
+		return;
+	}
+	const int left = width / 2;
+	glEnable(GL_SCISSOR_TEST);
+	glViewport(0, 0, left, height);
+	glScissor(0, 0, left, height);
+	setCameraUniforms(shaderProgram, left, height);
+	renderScene(shaderProgram);
+
+	glViewport(left, 0, width - left, height);
+	glScissor(left, 0, width - left, height);
+	setCameraUniforms(shaderProgram, width - left, height);
+	renderComparePane(shaderProgram);
+	glDisable(GL_SCISSOR_TEST);
+	glViewport(0, 0, width, height);
+
+	// Divider and pane captions
+	const ImVec2 display = ImGui::GetIO().DisplaySize;
+	const float x = display.x * left / std::max(1, width);
+	ImDrawList* list = ImGui::GetBackgroundDrawList();
+	list->AddLine(ImVec2(x, 0.0f), ImVec2(x, display.y), IM_COL32(90, 90, 90, 255), 2.0f);
+	char caption[64];
+	if (!frames.empty()) {
+		snprintf(caption, sizeof(caption), "Frame %d", currentFrameIndex);
+		list->AddText(ImVec2(8.0f, display.y - 22.0f), IM_COL32(200, 200, 200, 255), caption);
+	}
+	if (const FrameStore* store = compareStore()) {
+		snprintf(caption, sizeof(caption), "%s %d", store == &g_CompareFrames ? "Compare capture, frame" : "Frame", compareFrameIndex(*store));
+		list->AddText(ImVec2(x + 8.0f, display.y - 22.0f), IM_COL32(200, 200, 200, 255), caption);
+	}
+}
+
+// Command line:
+//   SceneDebugger [capture]
+//   SceneDebugger --headless capture [--out dir] [--size WxH] [--frames a:b]
+//                 [--camera x,y,z,distance,pitch,yaw | --fit-each]
+//   SceneDebugger --bench-render capture [--headless] [--size WxH] [--steps N] [--json file]
+struct LaunchOptions {
+	std::string capture;
+	bool headless = false;
+	std::string outDir = ".";
+	int width = 1280, height = 720;
+	int firstFrame = 0, lastFrame = -1;   // inclusive; -1 is the last frame
+	bool fixedCamera = false;             // else fit the first frame (or each with fitEach)
+	glm::vec3 target = glm::vec3(0.0f);
+	float distance = 10.0f, pitch = 0.0f, yaw = -90.0f;
+	bool fitEach = false;
+	bool benchRender = false;
+	int benchSteps = 600;
+	std::string jsonPath;                 // bench report; stdout when empty
+};
+
+static void printUsage() {
+	std::cerr << "usage: SceneDebugger [capture]\n"
+		"       SceneDebugger --headless capture [--out dir] [--size WxH] [--frames a:b]\n"
+		"                     [--camera x,y,z,distance,pitch,yaw | --fit-each]\n"
+		"       SceneDebugger --bench-render capture [--headless] [--size WxH] [--steps N] [--json file]\n";
+}
+
+static bool parseLaunchOptions(int argc, char** argv, LaunchOptions& opt) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (arg == "--headless")
+			opt.headless = true;
+		else if (arg == "--fit-each")
+			opt.fitEach = true;
+		else if (arg == "--bench-render")
+			opt.benchRender = true;
+		else if (arg == "--steps" && value) {
+			opt.benchSteps = std::atoi(value);
+			if (opt.benchSteps <= 0) return false;
+			++i;
+		}
+		else if (arg == "--json" && value) {
+			opt.jsonPath = value;
+			++i;
+		}
+		else if (arg == "--out" && value) {
+			opt.outDir = value;
+			++i;
+		}
+		else if (arg == "--size" && value) {
+			if (std::sscanf(value, "%dx%d", &opt.width, &opt.height) != 2 || opt.width <= 0 || opt.height <= 0) return false;
+			++i;
+		}
+		else if (arg == "--frames" && value) {
+			if (std::sscanf(value, "%d:%d", &opt.firstFrame, &opt.lastFrame) < 1 || opt.firstFrame < 0) return false;
+			++i;
+		}
+		else if (arg == "--camera" && value) {
+			glm::vec3& t = opt.target;
+			if (std::sscanf(value, "%f,%f,%f,%f,%f,%f", &t.x, &t.y, &t.z, &opt.distance, &opt.pitch, &opt.yaw) != 6) return false;
+			opt.fixedCamera = true;
+			++i;
+		}
+		else if (arg.rfind("--", 0) == 0 || !opt.capture.empty())
+			return false;
+		else
+			opt.capture = arg;
+	}
+	return !(opt.headless || opt.benchRender) || !opt.capture.empty();
+}
+
+// --bench-render: the script orbits a view of all frames
+static renderbench::Runner startBenchRun(const LaunchOptions& opt) {
+	fitAllFrames = true;
+	fitDataIntoView();
+	fitView = false;
+	fitAllFrames = false;
+	return renderbench::Runner(renderbench::Script(opt.benchSteps, (int)frames.size(), camera.target, camera.distance));
+}
+
+static void applyKeyframe(const renderbench::Keyframe& key) {
+	camera.target = key.target;
+	camera.distance = key.distance;
+	camera.pitch = key.pitch;
+	camera.yaw = key.yaw;
+	if (key.frame != currentFrameIndex && key.frame < (int)frames.size())
+		setCurrentFrame(key.frame);
+}
+
+static bool writeBenchReport(const renderbench::Runner& bench, const LaunchOptions& opt, const char* backend, int width, int height, double loadSeconds) {
+	renderbench::RunInfo info;
+	info.capture = opt.capture;
+	info.backend = backend;
+	const GLubyte* renderer = glGetString(GL_RENDERER);
+	info.renderer = renderer ? (const char*)renderer : "";
+	info.width = width;
+	info.height = height;
+	info.captureFrames = frames.size();
+	info.loadSeconds = loadSeconds;
+
+	std::FILE* out = opt.jsonPath.empty() ? stdout : std::fopen(opt.jsonPath.c_str(), "w");
+	if (!out) {
+		std::cerr << "Cannot write " << opt.jsonPath << "\n";
+		return false;
+	}
+	bench.writeJson(out, info);
+	return out == stdout ? std::fflush(out) == 0 : std::fclose(out) == 0;
+}
+
+// --headless: renders frames of a capture offscreen through renderScene and
+// writes them as out/frame_NNNNNN.png. Readback and PNG encoding overlap
+// with rendering of the following frames. With --bench-render the camera
+// script runs offscreen instead and nothing is written.
+static int runHeadless(const LaunchOptions& opt) {
+	HeadlessContext context;
+	std::string error;
+	if (!context.create(error)) {
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	glewExperimental = GL_TRUE;
+	GLenum err = glewInit();
+	glGetError();
+	// A GLX build of GLEW cannot find an X display under EGL; GL entry points are loaded anyway
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	if (err == GLEW_ERROR_NO_GLX_DISPLAY) err = GLEW_OK;
+#endif
+	if (err != GLEW_OK) {
+		std::cerr << "Failed to initialize GLEW.\n";
+		return 1;
+	}
+
+	glEnable(GL_DEPTH_TEST);
+	Shader shaderProgram("vertex_shader.glsl", "fragment_shader.glsl");
+	OffscreenRenderer target;
+	if (!target.create(opt.width, opt.height, error)) {
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	const auto loadStart = std::chrono::steady_clock::now();
+	const bool loaded = loadCaptureFile(opt.capture);
+	const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+	std::cerr << g_LoadStatus << "\n";
+	if (!loaded && frames.empty()) return 1;
+
+	if (opt.benchRender) {
+		renderbench::Runner bench = startBenchRun(opt);
+		renderbench::Keyframe key;
+		for (;;) {
+			profiler::Profiler::shared().beginFrame();
+			if (!bench.next(key)) break;
+			applyKeyframe(key);
+			glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			shaderProgram.use();
+			setCameraUniforms(shaderProgram, opt.width, opt.height);
+			renderScene(shaderProgram);
+			glFinish();   // no swap to wait on; count the GPU work in the frame
+			profiler::Profiler::shared().endFrame();
+		}
+		const bool written = writeBenchReport(bench, opt, context.backend(), opt.width, opt.height, loadSeconds);
+		profiler::GpuTimer::shared().release();
+		return written ? 0 : 1;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(opt.outDir, ec);
+	if (ec) {
+		std::cerr << "Cannot create " << opt.outDir << ": " << ec.message() << "\n";
+		return 1;
 	}
+
+	if (opt.fixedCamera) {
+		camera.target = opt.target;
+		camera.distance = opt.distance;
+		camera.pitch = opt.pitch;
+		camera.yaw = opt.yaw;
+		fitView = false;
+	}
+
+	const int last = opt.lastFrame < 0 ? (int)frames.size() - 1 : std::min(opt.lastFrame, (int)frames.size() - 1);
+	const auto t0 = std::chrono::steady_clock::now();
+	int rendered = 0;
+	for (int f = opt.firstFrame; f <= last; ++f, ++rendered) {
+		profiler::Profiler::shared().beginFrame();
+		setCurrentFrame(f);
+		if (opt.fitEach) fitView = true;
+		// Fit before the matrices are set; renderScene would apply it one frame late
+		if (fitView) {
+			fitDataIntoView();
+			fitView = false;
+		}
+
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		shaderProgram.use();
+		setCameraUniforms(shaderProgram, opt.width, opt.height);
+		renderScene(shaderProgram);
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "frame_%06d.png", f);
+		target.capture((std::filesystem::path(opt.outDir) / name).string());
+		profiler::Profiler::shared().endFrame();
+	}
+	target.finish();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	std::cerr << target.imagesWritten() << " of " << rendered << " frames written to " << opt.outDir
+		<< " in " << seconds << " s (" << (seconds > 0 ? rendered / seconds : 0.0) << " frames/s, "
+		<< context.backend() << ")\n";
+	profiler::GpuTimer::shared().release();
+	target.release();
+	return target.imagesFailed() == 0 ? 0 : 1;
 }
 
-int main() {
+int main(int argc, char** argv) {
+	LaunchOptions options;
+	if (!parseLaunchOptions(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+	if (options.headless)
+		return runHeadless(options);
+	std::unique_ptr<renderbench::Runner> bench;
+	double loadSeconds = 0.0;
+
 	// Initialize GLFW
 	if (!glfwInit()) {
 		std::cerr << "Failed to initialize GLFW.\n";
@@ -581,7 +980,7 @@ int main() {
 		return -1;
 	}
 	glfwMakeContextCurrent(window);
-	glfwSwapInterval(1); // Enable vsync
+	glfwSwapInterval(options.benchRender ? 0 : 1); // vsync, except when benchmarking
 
 	// Set viewport
 	glViewport(0, 0, 1280, 720);
@@ -599,6 +998,8 @@ int main() {
 
 	glfwSetKeyCallback(window, key_callback);
 
+	glfwSetDropCallback(window, drop_callback);
+
 	// Initialize GLEW
 	glewExperimental = GL_TRUE;
 	GLenum err = glewInit();
@@ -627,10 +1028,28 @@ int main() {
 	// Load shaders
 	Shader shaderProgram("vertex_shader.glsl", "fragment_shader.glsl");
 
+	const auto loadStart = std::chrono::steady_clock::now();
+	if (!options.capture.empty() && !loadCaptureFile(options.capture))
+		std::cerr << g_LoadStatus << "\n";
+	loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+	if (options.benchRender)
+		bench = std::make_unique<renderbench::Runner>(startBenchRun(options));
+
 	// Main loop
 	while (!glfwWindowShouldClose(window)) {
+		profiler::Profiler::shared().beginFrame();
+
 		// Input handling
 		processInput(window);
+		updatePlayback();
+		applyFrameBudget();
+		if (bench) {
+			renderbench::Keyframe key;
+			if (bench->next(key))
+				applyKeyframe(key);
+			else
+				glfwSetWindowShouldClose(window, true);
+		}
 
 		// Start ImGui frame
 		ImGui_ImplOpenGL3_NewFrame();
@@ -647,37 +1066,30 @@ int main() {
 		// Use shader program
 		shaderProgram.use();
 
-		// Set camera matrices
+		// Set camera matrices and render the 3D scene, once per pane
 		int width, height;
 		glfwGetFramebufferSize(window, &width, &height);
-		if (height == 0) height = 1; // Prevent division by zero
-		float aspectRatio = width / (float)height;
-
-		glm::mat4 projection = camera.getProjectionMatrix(aspectRatio, camera.nearPlane, camera.farPlane);
-		glm::mat4 view = camera.getViewMatrix();
-		glm::mat4 model = glm::mat4(1.0f); // Identity matrix
-
-		shaderProgram.setMat4("projection", projection);
-		shaderProgram.setMat4("view", view);
-		shaderProgram.setMat4("model", model);
-
-		// Set lighting uniforms
-		glm::vec3 lightPos = camera.target + glm::vec3(0.0f, 10.0f, 10.0f);
-		glm::vec3 viewPos = camera.getPosition();
-		shaderProgram.setVec3("lightPos", lightPos);
-		shaderProgram.setVec3("viewPos", viewPos);
-
-		// Render 3D scene
-		renderScene(shaderProgram);
+		renderViews(shaderProgram, width, height);
 
 		// Render ImGui
 		ImGui::Render();
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		{
+			profiler::GpuScope pass("imgui");
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		}
 
 		// Swap buffers and poll events
 		glfwSwapBuffers(window);
 		glfwPollEvents();
+		profiler::Profiler::shared().endFrame();
 	}
+	int exitCode = 0;
+	if (bench && bench->done()) {
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		exitCode = writeBenchReport(*bench, options, "glfw", width, height, loadSeconds) ? 0 : 1;
+	}
+	profiler::GpuTimer::shared().release();
 
 	// Cleanup ImGui and GLFW
 	ImGui_ImplOpenGL3_Shutdown();
@@ -685,7 +1097,7 @@ int main() {
 	ImGui::DestroyContext();
 	glfwDestroyWindow(window);
 	glfwTerminate();
-	return 0;
+	return exitCode;
 }
 
 // Process input
@@ -696,37 +1108,494 @@ void processInput(GLFWwindow* window) {
 	camera.processInput(window);
 }
 
+static void renderSearchGUI() {
+	if (!ImGui::CollapsingHeader("Search")) return;
+
+	bool run = ImGui::InputText("Name", g_SearchPattern, sizeof(g_SearchPattern), ImGuiInputTextFlags_EnterReturnsTrue);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Exact name or glob pattern ('*', '?'); empty matches every name");
+
+	static const char* typeLabels[SearchIndex::TypeCount] = { "triangle", "line", "point", "box" };
+	for (int s = 0; s < SearchIndex::TypeCount; ++s) {
+		if (s > 0) ImGui::SameLine();
+		run |= ImGui::Checkbox(typeLabels[s], &g_SearchTypes[s]);
+	}
+
+	run |= ImGui::Checkbox("Region", &g_SearchUseRegion);
+	if (g_SearchUseRegion) {
+		run |= ImGui::InputFloat3("Min", g_SearchRegionMin, "%.3f", ImGuiInputTextFlags_EnterReturnsTrue);
+		run |= ImGui::InputFloat3("Max", g_SearchRegionMax, "%.3f", ImGuiInputTextFlags_EnterReturnsTrue);
+	}
+
+	run |= ImGui::Button("Find");
+	if (run) {
+		SearchQuery q;
+		q.namePattern = g_SearchPattern;
+		q.typeMask = 0;
+		for (int s = 0; s < SearchIndex::TypeCount; ++s)
+			if (g_SearchTypes[s]) q.typeMask |= 1u << s;
+		q.useRegion = g_SearchUseRegion;
+		q.regionMin = glm::min(glm::vec3(g_SearchRegionMin[0], g_SearchRegionMin[1], g_SearchRegionMin[2]),
+			glm::vec3(g_SearchRegionMax[0], g_SearchRegionMax[1], g_SearchRegionMax[2]));
+		q.regionMax = glm::max(glm::vec3(g_SearchRegionMin[0], g_SearchRegionMin[1], g_SearchRegionMin[2]),
+			glm::vec3(g_SearchRegionMax[0], g_SearchRegionMax[1], g_SearchRegionMax[2]));
+
+		auto t0 = std::chrono::steady_clock::now();
+		g_SearchHits = searchIndex.query(frames, q);
+		g_SearchMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	ImGui::SameLine();
+	ImGui::Text("%zu hits (%.2f ms) | %llu primitives, %zu names indexed", g_SearchHits.size(), g_SearchMillis,
+		(unsigned long long)searchIndex.primitiveCount(), searchIndex.nameCount());
+
+	if (g_SearchHits.empty()) return;
+
+	ImGui::BeginChild("SearchResults", ImVec2(0, 160), true);
+	ImGuiListClipper clipper;
+	clipper.Begin((int)g_SearchHits.size());
+	while (clipper.Step()) {
+		for (int r = clipper.DisplayStart; r < clipper.DisplayEnd; ++r) {
+			const SearchHit& hit = g_SearchHits[r];
+			const bool current = (int)hit.frame == currentFrameIndex && (int)hit.primitive == g_SelectedPrimitive;
+			std::string label = "frame " + std::to_string(hit.frame) + ": " + searchIndex.name(hit) + " " +
+				std::to_string(hit.primitive) + " (" + primTypeName(searchIndex.type(hit)) + ")##hit" + std::to_string(r);
+			if (ImGui::Selectable(label.c_str(), current)) {
+				setCurrentFrame((int)hit.frame);
+				setSelection((int)hit.primitive);
+				g_RequestScrollToSelection = true; // same index in another frame still needs a scroll
+			}
+		}
+	}
+	ImGui::EndChild();
+}
+
+// Collects what the highlight pass needs once a report arrives
+static void acceptIntersections(IntersectionReport&& report) {
+	g_Intersections = std::move(report);
+	++g_IntersectionsVersion;
+	g_HasIntersections = true;
+
+	g_IntersectingPrims.clear();
+	for (const auto& p : g_Intersections.framePairs) {
+		g_IntersectingPrims.push_back(p.a);
+		g_IntersectingPrims.push_back(p.b);
+	}
+	for (const auto& p : g_Intersections.overlayPairs)
+		g_IntersectingPrims.push_back(p.a);
+	std::sort(g_IntersectingPrims.begin(), g_IntersectingPrims.end());
+	g_IntersectingPrims.erase(std::unique(g_IntersectingPrims.begin(), g_IntersectingPrims.end()), g_IntersectingPrims.end());
+
+	// Overlay triangles are numbered in index order across overlay meshes, as in buildMeshBvh()
+	std::vector<uint32_t> wanted;
+	for (const auto& p : g_Intersections.overlayPairs) wanted.push_back(p.b);
+	std::sort(wanted.begin(), wanted.end());
+	wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+	g_IntersectingOverlayTris.clear();
+	uint32_t tri = 0;
+	size_t w = 0;
+	for (const auto& prim : overlayPrimitives) {
+		if (prim.type != "overlaymesh") continue;
+		for (size_t i = 0; i + 2 < prim.indices.size() && w < wanted.size(); i += 3, ++tri) {
+			if (tri != wanted[w]) continue;
+			for (int k = 0; k < 3; ++k)
+				g_IntersectingOverlayTris.push_back(prim.vertices[prim.indices[i + k]].position);
+			++w;
+		}
+	}
+}
+
+// Closest points between the selection and the overlay, recomputed when either changes
+static void updateSelectionClearance() {
+	if (!g_MeasureSelection || frames.empty() || overlayPrimitives.empty() || g_SelectedPrimitive < 0 ||
+		g_SelectedPrimitive >= (int)frames.primitiveCount(currentFrameIndex)) {
+		g_SelectionClearance = ClearanceResult();
+		g_MeasuredFrame = g_MeasuredPrimitive = -1;
+		return;
+	}
+	if (g_MeasuredFrame == currentFrameIndex && g_MeasuredPrimitive == g_SelectedPrimitive) return;
+	g_MeasuredFrame = currentFrameIndex;
+	g_MeasuredPrimitive = g_SelectedPrimitive;
+	g_SelectionClearance = primitiveClearance(*frames[currentFrameIndex], g_SelectedPrimitive, *overlayBvh());
+}
+
+static void renderClearanceGUI() {
+	if (overlayPrimitives.empty()) {
+		ImGui::TextDisabled("Load an overlay mesh to measure clearance.");
+		return;
+	}
+
+	ImGui::Checkbox("Measure selection", &g_MeasureSelection);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Closest distance from the selected primitive to the overlay mesh");
+	if (g_MeasureSelection) {
+		if (g_SelectionClearance.valid)
+			ImGui::Text("Selection clearance: %.6g (overlay tri %u)", g_SelectionClearance.distance, g_SelectionClearance.meshTriangle);
+		else
+			ImGui::TextDisabled(g_SelectedPrimitive < 0 ? "Select a primitive to measure." : "No overlay triangles.");
+	}
+
+	const bool running = g_ClearanceTask.running();
+	if (running) ImGui::BeginDisabled();
+	if (ImGui::Button("Frame Clearance")) {
+		std::shared_ptr<const TriangleBvh> overlay = overlayBvh();
+		FrameStore::FramePtr frame = frames[currentFrameIndex];
+		const size_t frameIndex = currentFrameIndex;
+		g_ClearanceTask.start(ThreadPool::shared(), [frame, frameIndex, overlay] {
+			ClearanceReport report = frameClearance(*frame, *overlay, ThreadPool::shared());
+			report.frame = frameIndex;
+			return report;
+		});
+	}
+	if (running) ImGui::EndDisabled();
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Clearance of every primitive in the current frame to the overlay mesh");
+	ImGui::SameLine();
+	ImGui::Checkbox("Color by clearance", &g_ShowClearance);
+
+	if (running) {
+		ImGui::TextDisabled("measuring...");
+		return;
+	}
+	if (!g_HasClearance) return;
+
+	const ClearanceReport& r = g_Clearance;
+	if (r.closest < 0) {
+		ImGui::Text("Frame %zu: no primitives to measure", r.frame);
+		return;
+	}
+	ImGui::Text("Frame %zu: min %.6g at primitive %d, max %.6g (%.3f s)",
+		r.frame, r.minDistance, r.closest, r.maxDistance, r.seconds);
+	if (ImGui::Button("Select Closest")) {
+		if ((int)r.frame != currentFrameIndex) setCurrentFrame((int)r.frame);
+		setSelection(r.closest);
+	}
+	ImGui::SameLine();
+	ImGui::DragFloat("Color range", &g_ClearanceRange, std::max(r.maxDistance, 1e-6f) * 0.005f, 0.0f, FLT_MAX, "%.4g");
+}
+
+static void renderIntersectionGUI() {
+	const bool running = g_IntersectionTask.running();
+	if (running) ImGui::BeginDisabled();
+	if (ImGui::Button("Find Intersections")) {
+		std::shared_ptr<const TriangleBvh> overlay;
+		if (g_IntersectWithOverlay && !overlayPrimitives.empty())
+			overlay = overlayBvh();
+		FrameStore::FramePtr frame = frames[currentFrameIndex];
+		const size_t frameIndex = currentFrameIndex;
+		g_IntersectionTask.start(ThreadPool::shared(), [frame, frameIndex, overlay] {
+			IntersectionReport report = findTriangleIntersections(*frame, overlay.get(), ThreadPool::shared());
+			report.frame = frameIndex;
+			return report;
+		});
+	}
+	if (running) ImGui::EndDisabled();
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Find every pair of interpenetrating drawtriangle primitives in the current frame");
+	ImGui::SameLine();
+	ImGui::Checkbox("Against overlay", &g_IntersectWithOverlay);
+	ImGui::SameLine();
+	ImGui::Checkbox("Highlight", &g_ShowIntersections);
+
+	if (running) {
+		ImGui::TextDisabled("analyzing...");
+		return;
+	}
+	if (!g_HasIntersections) return;
+
+	const IntersectionReport& r = g_Intersections;
+	ImGui::Text("Frame %zu: %zu triangles, %zu intersecting pairs, %zu with overlay (%.3f s)",
+		r.frame, r.triangles, r.framePairs.size(), r.overlayPairs.size(), r.seconds);
+	if (r.framePairs.empty() && r.overlayPairs.empty()) return;
+
+	const size_t rows = r.framePairs.size() + r.overlayPairs.size();
+	ImGui::BeginChild("IntersectionList", ImVec2(0, 140), true);
+	ImGuiListClipper clipper;
+	clipper.Begin((int)rows);
+	while (clipper.Step()) {
+		for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+			const bool withOverlay = row >= (int)r.framePairs.size();
+			const TrianglePair& p = withOverlay ? r.overlayPairs[row - r.framePairs.size()] : r.framePairs[row];
+			std::string label = "tri " + std::to_string(p.a) + " x " + (withOverlay ? "overlay tri " : "tri ") +
+				std::to_string(p.b) + "##isect" + std::to_string(row);
+			if (ImGui::Selectable(label.c_str(), (int)r.frame == currentFrameIndex && (int)p.a == g_SelectedPrimitive)) {
+				if ((int)r.frame != currentFrameIndex) setCurrentFrame((int)r.frame);
+				setSelection((int)p.a);
+			}
+		}
+	}
+	ImGui::EndChild();
+}
+
+static void renderCompareGUI() {
+	if (!ImGui::CollapsingHeader("Compare")) return;
+
+	ImGui::Checkbox("Split view", &g_SplitView);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Current frame on the left, the compare frame on the right, through the same camera");
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(100.0f);
+	ImGui::InputInt("Frame offset", &g_CompareOffset);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("The right pane shows the current frame plus this offset, and steps along with it");
+
+	static char comparePath[1024] = "";
+	ImGui::InputText("##comparepath", comparePath, sizeof(comparePath));
+	ImGui::SameLine();
+	if (ImGui::Button("Open compare capture") && comparePath[0]) {
+		loadCompareFile(comparePath);
+		g_SplitView = true;
+	}
+	if (!g_CompareFrames.empty()) {
+		ImGui::Checkbox("Right pane from compare capture", &g_CompareOtherCapture);
+		ImGui::SameLine();
+		if (ImGui::SmallButton("Close##compare")) {
+			closeCompareCapture();
+			g_CompareStatus.clear();
+		}
+	}
+	if (!g_CompareStatus.empty()) ImGui::TextWrapped("%s", g_CompareStatus.c_str());
+	if (const FrameStore* store = compareStore())
+		ImGui::Text("Right pane: frame %d of %zu (%s)", compareFrameIndex(*store), store->size(),
+			store == &g_CompareFrames ? "compare capture" : "this capture");
+}
+
+static void renderMemoryGUI() {
+	if (!ImGui::CollapsingHeader("Memory")) return;
+
+	ImGui::SetNextItemWidth(160.0f);
+	if (ImGui::DragInt("Frame cache (MB)", &g_FrameBudgetMB, 4.0f, 16, 1 << 20))
+		applyFrameBudget();
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Decoded frames and the capture's indexes kept in memory; the current frame and its neighbours always are");
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::SliderInt("Position bits", &g_PositionBits, 12, framecodec::kLosslessBits,
+		g_PositionBits >= framecodec::kLosslessBits ? "lossless" : "%d");
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Quantization of positions over each frame's bounds; applies to the next paste. Off (lossless) at 32");
+
+	const FrameStore::Stats st = frames.stats();
+	if (st.frames == 0) {
+		ImGui::TextDisabled("No frames loaded.");
+		return;
+	}
+	const double MB = 1.0 / (1 << 20);
+	ImGui::Text("%zu frames: %.1f MB decoded, %.1f MB compressed (%.2fx)", st.frames,
+		st.rawBytes * MB, st.packedBytes * MB, st.packedBytes ? double(st.rawBytes) / st.packedBytes : 0.0);
+	ImGui::Text("Blocks: %zu distinct for %zu references (%.1fx shared)", st.blocks, st.blockRefs,
+		st.blocks ? double(st.blockRefs) / st.blocks : 0.0);
+	ImGui::Text("Resident: %zu frames, %.1f MB", st.residentFrames, st.residentBytes * MB);
+	ImGui::Text("Indexes: %.1f MB identity, %.1f MB search", identityTracker.memoryBytes() * MB, searchIndex.memoryBytes() * MB);
+	ImGui::Text("GPU: %zu blocks, %.1f MB (%zu pages, %.1f MB allocated)", FrameDrawBuffer::sharedBlockCount(), FrameDrawBuffer::sharedBlockBytes() * MB,
+		FrameDrawBuffer::sharedPageCount(), FrameDrawBuffer::sharedPageBytes() * MB);
+	ImGui::Text("Decodes: %llu, avg %.3f ms, max %.3f ms", (unsigned long long)st.decodes,
+		st.decodes ? st.decodeSeconds * 1e3 / st.decodes : 0.0, st.maxDecodeSeconds * 1e3);
+}
+
+static void renderProfilerGUI() {
+	if (!ImGui::CollapsingHeader("Profiler")) return;
+	auto& prof = profiler::Profiler::shared();
+
+	bool enabled = prof.enabled;
+	if (ImGui::Checkbox("Enabled", &enabled)) prof.enabled = enabled;
+
+	// Per-frame totals over the last frames; click a row to plot it
+	static std::string plotted = "frame (ms)";
+	static std::vector<float> plot;
+	const auto series = prof.snapshot();
+	auto labelOf = [&](size_t i) {
+		const bool counter = i + 3 >= series.size();
+		return (series[i].gpu ? "GPU " : "") + series[i].name + (counter ? "" : " (ms)");
+	};
+	for (size_t i = 0; i < series.size(); ++i) {
+		if (labelOf(i) != plotted) continue;
+		series[i].ordered(plot);
+		ImGui::PlotHistogram("##profplot", plot.data(), (int)plot.size(), 0, plotted.c_str(), 0.0f, FLT_MAX, ImVec2(0, 60));
+	}
+
+	if (ImGui::BeginTable("##profiler", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+		ImGui::TableSetupColumn("Scope");
+		ImGui::TableSetupColumn("Last");
+		ImGui::TableSetupColumn("p50");
+		ImGui::TableSetupColumn("p95");
+		ImGui::TableSetupColumn("p99");
+		ImGui::TableSetupColumn("Max");
+		ImGui::TableHeadersRow();
+		for (size_t i = 0; i < series.size(); ++i) {
+			const auto& s = series[i];
+			const bool counter = i + 3 >= series.size();
+			const char* fmt = counter ? "%.0f" : "%.3f";
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			const std::string label = labelOf(i);
+			if (ImGui::Selectable(label.c_str(), label == plotted, ImGuiSelectableFlags_SpanAllColumns))
+				plotted = label;
+			ImGui::TableNextColumn(); ImGui::Text(fmt, s.last());
+			ImGui::TableNextColumn(); ImGui::Text(fmt, s.percentile(0.5f));
+			ImGui::TableNextColumn(); ImGui::Text(fmt, s.percentile(0.95f));
+			ImGui::TableNextColumn(); ImGui::Text(fmt, s.percentile(0.99f));
+			ImGui::TableNextColumn(); ImGui::Text(fmt, s.percentile(1.0f));
+		}
+		ImGui::EndTable();
+	}
+
+	// Chrome trace (chrome://tracing or ui.perfetto.dev)
+	static char tracePath[512] = "scenedebugger_trace.json";
+	static std::string traceStatus;
+	if (!prof.isTracing()) {
+		if (ImGui::Button("Record trace")) {
+			prof.startTrace();
+			traceStatus.clear();
+		}
+	}
+	else {
+		if (ImGui::Button("Stop")) prof.stopTrace();
+		ImGui::SameLine();
+		ImGui::Text("%zu events", prof.traceEvents());
+	}
+	ImGui::SetNextItemWidth(220.0f);
+	ImGui::InputText("##tracepath", tracePath, sizeof(tracePath));
+	ImGui::SameLine();
+	if (ImGui::Button("Export trace"))
+		traceStatus = prof.exportTrace(tracePath) ? std::string("Wrote ") + tracePath : std::string("Cannot write ") + tracePath;
+	if (!traceStatus.empty()) ImGui::TextUnformatted(traceStatus.c_str());
+}
+
+// Debug action: replace the capture with a synthetic one (same generator as scenedebugger_gen)
+static void renderGeneratorGUI() {
+	if (!ImGui::CollapsingHeader("Generate")) return;
+
+	static scenegen::Options opt;
+	static int frameCount = 100, perFrame = 1000, names = 1000, noise = 0, seed = 1, distribution = 0;
+	static std::string status;
+	static const char* distributions[3] = { "uniform", "clustered", "moving" };
+
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragInt("Frames", &frameCount, 1.0f, 1, 1000000);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragInt("Primitives / frame", &perFrame, 10.0f, 1, 10000000);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragFloat("Triangle weight", &opt.typeMix[0], 0.01f, 0.0f, 1.0f);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragFloat("Line weight", &opt.typeMix[1], 0.01f, 0.0f, 1.0f);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragFloat("Point weight", &opt.typeMix[2], 0.01f, 0.0f, 1.0f);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragFloat("Box weight", &opt.typeMix[3], 0.01f, 0.0f, 1.0f);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::Combo("Distribution", &distribution, distributions, 3);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragFloat("Extent", &opt.extent, 1.0f, 1.0f, 1e6f);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragInt("Names", &names, 1.0f, 1, 10000000);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::SliderFloat("Colored share", &opt.colorFraction, 0.0f, 1.0f);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::DragInt("Noise lines / frame", &noise, 1.0f, 0, 1000000);
+	ImGui::SetNextItemWidth(160.0f);
+	ImGui::InputInt("Seed", &seed);
+
+	if (ImGui::Button("Generate into viewer")) {
+		opt.frames = (uint64_t)std::max(1, frameCount);
+		opt.primitivesPerFrame = (uint32_t)std::max(1, perFrame);
+		opt.names = (uint32_t)std::max(1, names);
+		opt.noiseLines = (uint32_t)std::max(0, noise);
+		opt.seed = (uint64_t)(uint32_t)seed;
+		opt.distribution = (scenegen::Distribution)distribution;
+
+		const auto t0 = std::chrono::steady_clock::now();
+		releaseFrameIndices();
+		clearFrames();
+		// Goes through the text parser like a real capture, batch by batch
+		ParseState state;
+		const uint64_t bytes = scenegen::Generator(opt).run(0, opt.frames, [&](const std::string& text) {
+			parseInputData(text, state, frames, false);
+			return true;
+		});
+		parseInputData(std::string_view(), state, frames, true);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+		currentFrameIndex = 0;
+		rebuildFrameIndices();
+		setSelection(-1);
+		fitView = true;
+
+		std::ostringstream out;
+		out << frames.size() << " frames, " << bytes / (1024 * 1024) << " MB of text in " << seconds << " s";
+		status = out.str();
+	}
+	if (!status.empty()) ImGui::TextUnformatted(status.c_str());
+}
+
+static void renderAnalysisGUI() {
+	IntersectionReport finished;
+	if (g_IntersectionTask.poll(finished))
+		acceptIntersections(std::move(finished));
+	ClearanceReport measured;
+	if (g_ClearanceTask.poll(measured)) {
+		g_Clearance = std::move(measured);
+		++g_ClearanceVersion;
+		g_HasClearance = true;
+		g_ClearanceRange = std::max(g_Clearance.maxDistance, 1e-6f);
+	}
+	updateSelectionClearance();
+
+	if (!ImGui::CollapsingHeader("Analysis")) return;
+	if (frames.empty()) {
+		ImGui::TextDisabled("Load frames to analyze.");
+		return;
+	}
+
+	renderIntersectionGUI();
+	ImGui::Separator();
+	renderClearanceGUI();
+}
+
 // Render GUI
 void renderGUI() {
+	profiler::Scope scope("renderGUI");
 	ImGui::Begin("Controls");
 
 	if (ImGui::Button("Paste from Clipboard")) {
 		const char* clipboard = glfwGetClipboardString(NULL);
 		if (clipboard) {
-			frames.clear();
-			parseInputData(std::string(clipboard));
+			releaseFrameIndices();
+			clearFrames();
+			parseInputData(std::string(clipboard), frames);
 			currentFrameIndex = 0;
+			rebuildFrameIndices();
 			setSelection(-1);
 			fitView = true;
 		}
 	}
 
+	// Plain, gzip or zstd capture logs; also by drag and drop or as the first command-line argument
+	static char capturePath[1024] = "";
+	ImGui::InputText("##capturepath", capturePath, sizeof(capturePath));
+	ImGui::SameLine();
+	if (ImGui::Button("Open File") && capturePath[0]) loadCaptureFile(capturePath);
+	if (!g_LoadStatus.empty()) ImGui::TextWrapped("%s", g_LoadStatus.c_str());
+
 	if (ImGui::Button("Paste OBJ from Clipboard as Overlay")) {
 		const char* clipboard = glfwGetClipboardString(NULL);
 		if (clipboard) {
-			parseOBJData(std::string(clipboard));
+			releaseOverlayIndices();
+			parseOBJData(std::string(clipboard), overlayPrimitives);
 			fitView = true;
 		}
 	}
 
 	if (ImGui::Button("Clear Overlay")) {
+		releaseOverlayIndices();
 		overlayPrimitives.clear();
 		fitView = true;
 	}
 
 	if (ImGui::Button("Clear Frames")) {
-		frames.clear();
+		releaseFrameIndices();
+		clearFrames();
 		currentFrameIndex = 0;
+		rebuildFrameIndices();
 		setSelection(-1);
 		fitView = true;
 	}
@@ -738,20 +1607,33 @@ void renderGUI() {
 		fitView = true;   // next render pass will call fitDataIntoView()
 	}
 	if (ImGui::IsItemHovered())
-		ImGui::SetTooltip("Compute bounds of current frame + overlay and frame the view");
+		ImGui::SetTooltip("Frame the current frame + overlay (F)");
+
+	ImGui::SameLine();
+	if (ImGui::Button("Fit All Frames")) {
+		fitView = true;
+		fitAllFrames = true;
+	}
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Frame the union of every frame + overlay (Shift+F)");
+
+	ImGui::Checkbox("Auto clip planes", &autoClipPlanes);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Fit near/far planes to the scene bounds every frame");
 
 	if (!frames.empty()) {
 		if (ImGui::ArrowButton("##frame_left", ImGuiDir_Left)) {
 			if (currentFrameIndex > 0)
 			{
-				--currentFrameIndex;
-				setSelection(-1);
+				setCurrentFrame(currentFrameIndex - 1);
 			}
 		}
 
 		ImGui::SameLine();
 
-		if (ImGui::SliderInt("Frame", &currentFrameIndex, 0, frames.size() - 1)) {
+		int sliderFrame = currentFrameIndex;
+		if (ImGui::SliderInt("Frame", &sliderFrame, 0, frames.size() - 1)) {
+			setCurrentFrame(sliderFrame);
 			// optional: fitView = true;
 		}
 
@@ -760,42 +1642,161 @@ void renderGUI() {
 		if (ImGui::ArrowButton("##frame_right", ImGuiDir_Right)) {
 			if (currentFrameIndex < static_cast<int>(frames.size()) - 1)
 			{
-				++currentFrameIndex;
-				setSelection(-1);
+				setCurrentFrame(currentFrameIndex + 1);
 			}
 		}
 
-		ImGui::Text("Primitives:");
+		if (ImGui::Button(g_Playback.playing() ? "Pause" : "Play", ImVec2(50, 0)))
+			togglePlayback();
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Play the frames at the target rate (Space)");
+		ImGui::SameLine();
+		ImGui::Checkbox("Loop", &g_Playback.loop);
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(70);
+		ImGui::DragFloat("FPS", &g_Playback.fps, 0.5f, 1.0f, 240.0f, "%.0f");
+		ImGui::SameLine();
+		static const float kSpeeds[] = { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f };
+		static const char* kSpeedNames[] = { "0.25x", "0.5x", "1x", "2x", "4x" };
+		int speed = (int)(std::find(kSpeeds, kSpeeds + 5, g_Playback.speed) - kSpeeds);
+		ImGui::SetNextItemWidth(70);
+		if (ImGui::Combo("Speed", &speed, kSpeedNames, 5))
+			g_Playback.speed = kSpeeds[speed];
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(70);
+		ImGui::SliderInt("Prefetch", &g_PrefetchFrames, 1, 32);
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Frames decoded and uploaded ahead of playback");
+		if (g_Playback.playing()) {
+			ImGui::Text("Playing %.1f fps, prepared %zu/%zu ahead, late frames %zu/%zu",
+				g_Playback.rate(), g_Prefetcher.readyCount(), g_Prefetcher.window(), g_PlaybackMisses, g_PlaybackShown);
+		}
 
-		// Give the list its own scroll area (height: choose what you like)
-		ImGui::BeginChild("PrimitiveList", ImVec2(0, 260), true, ImGuiWindowFlags_HorizontalScrollbar);
-		g_PrimitiveListActive = ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem) || ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+		ImGui::Checkbox("Keep selection across frames", &g_KeepSelectionAcrossFrames);
+		ImGui::SameLine();
+		ImGui::Checkbox("Trajectory", &g_ShowTrajectory);
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Polyline through the selected primitive's centroid in every frame");
+		if (identityTracker.indexedFrames() < identityTracker.frameCount()) {
+			ImGui::SameLine();
+			ImGui::Text("(tracking %zu/%zu frames)", identityTracker.indexedFrames(), identityTracker.frameCount());
+		}
 
-		for (size_t i = 0; i < frames[currentFrameIndex].primitives.size(); ++i) {
-			const auto& prim = frames[currentFrameIndex].primitives[i];
-			const bool selected = ((int)i == g_SelectedPrimitive);
+		ImGui::Checkbox("Onion skin", &g_ShowOnionSkin);
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Ghost the neighbouring frames: earlier in blue, later in orange");
+		if (g_ShowOnionSkin) {
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(80);
+			ImGui::SliderInt("Range##onion", &g_OnionFrames, 1, OnionSkin::kMaxFrames);
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(80);
+			ImGui::SliderFloat("Opacity##onion", &g_OnionAlpha, 0.05f, 1.0f, "%.2f");
+		}
 
-			std::string coords;
-			if (!prim.displayCoords.empty()) {
-				coords = prim.displayCoords;
+		ImGui::Checkbox("Labels", &g_ShowLabels);
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Primitive names in the scene, nearest first; overlapping labels are skipped");
+		if (g_ShowLabels) {
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(80);
+			ImGui::SliderFloat("Range##labels", &g_LabelRange, 0.1f, 20.0f, "%.1fx", ImGuiSliderFlags_Logarithmic);
+			if (ImGui::IsItemHovered())
+				ImGui::SetTooltip("Labels farther from the eye than this many camera distances are hidden");
+			const SceneLabels::Stats& ls = g_Labels.lastStats();
+			ImGui::SameLine();
+			ImGui::Text("%zu of %zu in range, %.2f ms", ls.drawn, ls.candidates, ls.ms);
+		}
+
+		ImGui::Checkbox("Point cloud LOD", &g_PointCloudLod);
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Frames with at least this many points draw them from a level-of-detail octree");
+		if (g_PointCloudLod) {
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(100);
+			ImGui::InputInt("Min points##pointcloud", &g_PointCloudMinPoints, 10000, 100000);
+			g_PointCloudMinPoints = std::max(1, g_PointCloudMinPoints);
+			if (isPointCloud(*frames[currentFrameIndex])) {
+				int budget = (int)(g_PointCloud.pointBudget / 100000);
+				ImGui::SetNextItemWidth(100);
+				if (ImGui::SliderInt("Point budget (x100k)", &budget, 1, 200))
+					g_PointCloud.pointBudget = (size_t)budget * 100000;
+				ImGui::SameLine();
+				ImGui::SetNextItemWidth(80);
+				ImGui::SliderFloat("Max error px", &g_PointCloud.maxErrorPx, 0.5f, 8.0f, "%.1f");
+				ImGui::SameLine();
+				ImGui::SetNextItemWidth(80);
+				ImGui::SliderFloat("Point size", &g_PointCloudPointSize, 1.0f, 8.0f, "%.0f");
+				const PointCloudRenderer::Stats& pc = g_PointCloud.lastStats();
+				if (g_PointCloud.frame() != currentFrameIndex)
+					ImGui::Text("Building octree...");
+				else
+					ImGui::Text("%zu nodes, %.2fM of %.2fM points, %zu streaming, %.0f MB on GPU", pc.nodes, pc.points / 1e6,
+						g_PointCloud.tree()->pointCount() / 1e6, pc.missing, pc.residentBytes / (1024.0 * 1024.0));
+			}
+		}
+
+		ImGui::Checkbox("Diff vs previous frame", &g_ShowDiff);
+		if (g_ShowDiff) {
+			ImGui::SameLine();
+			ImGui::Checkbox("Hide unchanged", &g_DiffHideUnchanged);
+			ImGui::SetNextItemWidth(120.0f);
+			ImGui::InputFloat("Move tolerance", &g_DiffQuantum, 0.0f, 0.0f, "%g");
+			g_DiffQuantum = std::max(g_DiffQuantum, 1e-9f);
+
+			auto diff = frameDiffCache.get(frames, currentFrameIndex, g_DiffQuantum);
+			if (diff) {
+				ImGui::TextColored(ImVec4(0.2f, 0.9f, 0.2f, 1.0f), "+%zu added", diff->counts[(int)DiffState::Added]);
+				ImGui::SameLine();
+				ImGui::TextColored(ImVec4(0.9f, 0.15f, 0.15f, 1.0f), "-%zu removed", diff->counts[(int)DiffState::Removed]);
+				ImGui::SameLine();
+				ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.1f, 1.0f), "~%zu moved", diff->counts[(int)DiffState::Moved]);
+				ImGui::SameLine();
+				ImGui::Text("=%zu unchanged", diff->counts[(int)DiffState::Unchanged]);
 			}
 			else {
-				for (const auto& v : prim.vertices)
-				{
-					coords += formatVec3(v.position);
-				}
+				ImGui::TextDisabled("computing diff...");
 			}
-			std::string label = prim.name + " " + std::to_string(i) + " (" + prim.type + " " + coords + ")";
+		}
 
-			if (ImGui::Selectable(label.c_str(), selected)) {
-				setSelection((int)i);
-			}
+		ImGui::Text("Primitives:");
 
-			// After the row is submitted, if it’s the (newly) selected one, scroll it into view.
-			if (selected && g_RequestScrollToSelection) {
-				// 0.35 puts it slightly below the top; use 0.5f to center if you prefer.
-				ImGui::SetScrollHereY(0.35f);
-				g_RequestScrollToSelection = false;
+		// Give the list its own scroll area (height: choose what you like)
+		ImGui::BeginChild("PrimitiveList", ImVec2(0, 260), true, ImGuiWindowFlags_HorizontalScrollbar);
+		g_PrimitiveListActive = ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem) || ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+
+		const auto current = frames[currentFrameIndex];
+		const Frame& frame = *current;
+		auto listDiff = g_ShowDiff ? frameDiffCache.get(frames, currentFrameIndex, g_DiffQuantum) : nullptr;
+
+		// Only the visible rows (plus a selection that needs scrolling to) are formatted
+		ImGuiListClipper clipper;
+		clipper.Begin((int)frame.size());
+		if (g_RequestScrollToSelection && g_SelectedPrimitive >= 0 && g_SelectedPrimitive < (int)frame.size())
+			clipper.IncludeItemByIndex(g_SelectedPrimitive);
+		while (clipper.Step()) {
+			for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+				const size_t i = (size_t)row;
+				const bool selected = (row == g_SelectedPrimitive);
+
+				std::string coords;
+				const glm::vec3* p = frame.positions(i);
+				for (uint32_t k = 0; k < frame.vertexCount(i); ++k)
+					coords += formatVec3(p[k]);
+				std::string label = frame.name(i) + " " + std::to_string(i) + " (" + primTypeName(frame.type(i)) + " " + coords + ")";
+				if (listDiff)
+					label = std::string(kDiffTags[(int)listDiff->state[i]]) + " " + label;
+
+				if (ImGui::Selectable(label.c_str(), selected)) {
+					setSelection(row);
+				}
+
+				// After the row is submitted, if it’s the (newly) selected one, scroll it into view.
+				if (selected && g_RequestScrollToSelection) {
+					// 0.35 puts it slightly below the top; use 0.5f to center if you prefer.
+					ImGui::SetScrollHereY(0.35f);
+					g_RequestScrollToSelection = false;
+				}
 			}
 		}
 
@@ -807,22 +1808,32 @@ void renderGUI() {
 		ImGui::Text("No frames loaded.");
 	}
 
+	renderSearchGUI();
+	renderCompareGUI();
+	renderAnalysisGUI();
+	renderMemoryGUI();
+	renderProfilerGUI();
+	renderGeneratorGUI();
+
 	ImGui::End();
 }
 
 // Render the scene
 void renderScene(Shader& shaderProgram) {
+	profiler::Scope scope("renderScene");
 	if (frames.empty() && overlayPrimitives.empty()) return;
 
 	if (fitView) {
 		fitDataIntoView();
 		fitView = false;
+		fitAllFrames = false;
 	}
 
 
 	// Render overlay primitives
 	if (!overlayPrimitives.empty()) {
-		renderPrimitives(shaderProgram, overlayPrimitives, -1);
+		profiler::GpuScope pass("overlay");
+		renderOverlayPrimitives(shaderProgram, overlayPrimitives);
 	}
 
 	// Render current-frame primitives  (non-overlay)
@@ -831,20 +1842,219 @@ void renderScene(Shader& shaderProgram) {
 			glEnable(GL_DEPTH_TEST);
 		else
 			glDisable(GL_DEPTH_TEST);
-		const Frame& frame = frames[currentFrameIndex];
-		renderPrimitives(shaderProgram, frame.primitives, g_SelectedPrimitive);
+		const auto frame = frames[currentFrameIndex];
+		auto diff = g_ShowDiff ? frameDiffCache.get(frames, currentFrameIndex, g_DiffQuantum) : nullptr;
+		{
+			profiler::GpuScope pass("frame");
+			if (diff)
+				renderFrameDiff(shaderProgram, diff);
+			else if (g_ShowClearance && g_HasClearance && (int)g_Clearance.frame == currentFrameIndex)
+				renderClearance(shaderProgram);
+			else
+				renderFramePrimitives(shaderProgram, frame, g_SelectedPrimitive);
+		}
+		if (g_ShowOnionSkin && frames.size() > 1) {
+			profiler::GpuScope pass("onion");
+			g_OnionSkin.draw(shaderProgram, frames, currentFrameIndex, g_OnionFrames, g_OnionAlpha);
+		}
 		glEnable(GL_DEPTH_TEST);
+
+		profiler::GpuScope pass("annotations");
+
+		if (g_ShowIntersections && g_HasIntersections && (int)g_Intersections.frame == currentFrameIndex)
+			renderIntersections(shaderProgram);
+
+		if (g_MeasureSelection && g_SelectionClearance.valid)
+			renderMeasurement(shaderProgram);
+
+		if (g_ShowTrajectory && g_TrackedIdentity.valid)
+			renderTrajectory(shaderProgram);
+
+		if (g_ShowLabels)
+			renderLabels(g_Labels, *frame, g_SelectedPrimitive);
 	}
 }
 
-void renderPrimitives(Shader& shaderProgram, const std::vector<Primitive>& primitives, int selectedIndex) {
-	for (size_t i = 0; i < primitives.size(); ++i) {
-		const auto& prim = primitives[i];
-		if (prim.vertices.empty()) continue;
+// Right pane of the split view: the overlay and the compare frame, without the current frame's annotations
+void renderComparePane(Shader& shaderProgram) {
+	profiler::Scope scope("renderComparePane");
+	if (!overlayPrimitives.empty())
+		renderOverlayPrimitives(shaderProgram, overlayPrimitives);
+	FrameStore* store = compareStore();
+	if (!store) return;
+
+	const int f = compareFrameIndex(*store);
+	if (store == &g_CompareFrames) g_CompareFrames.pin(f);
+	const auto frame = store->get(f);
+	if (depthTestNonOverlay)
+		glEnable(GL_DEPTH_TEST);
+	else
+		glDisable(GL_DEPTH_TEST);
+	{
+		profiler::GpuScope pass("compare");
+		g_CompareFrameDraw.bind(frame);
+		g_CompareFrameDraw.drawAll(shaderProgram, -1);
+		glBindVertexArray(0);
+	}
+	glEnable(GL_DEPTH_TEST);
+
+	if (g_ShowLabels)
+		renderLabels(g_CompareLabels, *frame, -1);
+}
 
-		const bool isSelected = (int)i == selectedIndex;
+// Intersecting triangles drawn over the frame in magenta; both highlights are
+// uploaded once per report and drawn in one call each.
+void renderIntersections(Shader& shaderProgram) {
+	const glm::vec4 magenta(1.0f, 0.1f, 1.0f, 1.0f);
+	const auto frame = frames[currentFrameIndex];
+
+	glDepthFunc(GL_LEQUAL);
+	g_IntersectionDraw.bindColored(frame, g_IntersectionsVersion, [&](uint32_t i, uint32_t& color) {
+		color = packColor(magenta);
+		return std::binary_search(g_IntersectingPrims.begin(), g_IntersectingPrims.end(), i);
+	});
+	g_IntersectionDraw.drawAll(shaderProgram, -1);
+
+	const int selected = g_SelectedPrimitive;
+	if (std::binary_search(g_IntersectingPrims.begin(), g_IntersectingPrims.end(), (uint32_t)selected)) {
+		g_FrameDraw.bind(frame);
+		g_FrameDraw.draw(shaderProgram, selected, magenta, true);
+	}
+
+	if (g_IntersectionsUploaded != g_IntersectionsVersion) {
+		g_IntersectionOverlayDraw.upload(g_IntersectingOverlayTris);
+		g_IntersectionsUploaded = g_IntersectionsVersion;
+	}
+	shaderProgram.setBool("useLighting", false);
+	shaderProgram.setVec4("primitiveColor", glm::vec4(0.6f, 0.0f, 0.6f, 1.0f));
+	g_IntersectionOverlayDraw.draw(GL_TRIANGLES);
+	glBindVertexArray(0);
+	glDepthFunc(GL_LESS);
+}
+
+// Frame primitives colored by clearance: red touching, blue at g_ClearanceRange or beyond.
+// The colors are baked into a vertex buffer once per report and color range.
+void renderClearance(Shader& shaderProgram) {
+	const auto frame = frames[currentFrameIndex];
+	auto colorOf = [](size_t i) {
+		const float d = g_Clearance.distance[i];
+		glm::vec4 color(0.4f, 0.4f, 0.4f, 1.0f);
+		if (d != FLT_MAX) {
+			const float t = g_ClearanceRange > 0.0f ? std::clamp(d / g_ClearanceRange, 0.0f, 1.0f) : 1.0f;
+			hsv2rgb(t * 0.66f, 0.85f, 0.95f, color.x, color.y, color.z);
+		}
+		return color;
+	};
+	uint32_t rangeBits;
+	std::memcpy(&rangeBits, &g_ClearanceRange, sizeof(rangeBits));
+	const uint64_t key = 1ull << 63 | (uint64_t)g_ClearanceVersion << 32 | rangeBits;   // top bit: never a diff key
+	g_AnalysisDraw.bindColored(frame, key, [&](uint32_t i, uint32_t& color) {
+		color = packColor(colorOf(i));
+		return true;
+	});
+	g_AnalysisDraw.drawAll(shaderProgram, -1);
+
+	const int selected = g_SelectedPrimitive;
+	if (selected >= 0 && selected < (int)frame->size()) {
+		glDepthFunc(GL_LEQUAL);
+		g_FrameDraw.bind(frame);
+		g_FrameDraw.draw(shaderProgram, selected, colorOf(selected), true);
+		glDepthFunc(GL_LESS);
+	}
+	glBindVertexArray(0);
+}
+
+// The GL viewport (one pane in split view) in ImGui display coordinates
+static bool viewportRect(ImVec2& origin, ImVec2& size) {
+	const ImGuiIO& io = ImGui::GetIO();
+	if (io.DisplaySize.x <= 0.0f || io.DisplaySize.y <= 0.0f) return false;
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	const ImVec2 scale = io.DisplayFramebufferScale;
+	size = ImVec2(viewport[2] / scale.x, viewport[3] / scale.y);
+	origin = ImVec2(viewport[0] / scale.x, io.DisplaySize.y - (viewport[1] + viewport[3]) / scale.y);
+	return size.x > 0.0f && size.y > 0.0f;
+}
+
+// Line between the closest points of the selection and the overlay, with its length as a label
+void renderMeasurement(Shader& shaderProgram) {
+	const glm::vec3 ends[2] = { g_SelectionClearance.onPrimitive, g_SelectionClearance.onMesh };
+
+	GLuint VAO = 0, VBO = 0;
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(ends), ends, GL_STATIC_DRAW);
+	profiler::countUpload(sizeof(ends));
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glDisable(GL_DEPTH_TEST);
+	shaderProgram.setBool("useLighting", false);
+	shaderProgram.setVec4("primitiveColor", glm::vec4(1.0f, 1.0f, 0.2f, 1.0f));
+	glLineWidth(2.0f);
+	glDrawArrays(GL_LINES, 0, 2);
+	profiler::countDraw();
+	glLineWidth(1.0f);
+	glPointSize(6.0f);
+	glDrawArrays(GL_POINTS, 0, 2);
+	profiler::countDraw();
+	glPointSize(1.0f);
+	glEnable(GL_DEPTH_TEST);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glDeleteBuffers(1, &VBO);
+	glDeleteVertexArrays(1, &VAO);
+
+	// Label at the midpoint, projected the same way as the scene (no ImGui when headless)
+	ImVec2 origin, size;
+	if (!ImGui::GetCurrentContext() || !viewportRect(origin, size)) return;
+	const glm::mat4 pv = camera.getProjectionMatrix(size.x / size.y, camera.nearPlane, camera.farPlane) * camera.getViewMatrix();
+	glm::vec4 clip = pv * glm::vec4((ends[0] + ends[1]) * 0.5f, 1.0f);
+	if (clip.w <= 0.0f) return;
+	const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+	const ImVec2 pos(origin.x + (ndc.x * 0.5f + 0.5f) * size.x + 6.0f, origin.y + (0.5f - ndc.y * 0.5f) * size.y - 6.0f);
+	char label[32];
+	snprintf(label, sizeof(label), "%.6g", g_SelectionClearance.distance);
+	ImGui::GetForegroundDrawList()->AddText(pos, IM_COL32(255, 255, 60, 255), label);
+}
+
+// Name labels of the frame, batched into ImGui's background list (no ImGui when headless)
+void renderLabels(SceneLabels& labels, const Frame& frame, int selectedIndex) {
+	ImVec2 origin, size;
+	if (!ImGui::GetCurrentContext() || !viewportRect(origin, size)) return;
+	const glm::mat4 pv = camera.getProjectionMatrix(size.x / size.y, camera.nearPlane, camera.farPlane) * camera.getViewMatrix();
+	labels.draw(ImGui::GetBackgroundDrawList(), frame, pv, camera.getPosition(), camera.distance * g_LabelRange, origin, size, selectedIndex);
+}
+
+// Centroid path of the tracked primitive across all frames, as one line strip.
+// The GPU copy is refreshed only when the path has grown or restarted.
+void renderTrajectory(Shader& shaderProgram) {
+	updateTrajectory();
+	if (g_TrajectoryPath.empty()) return;
+	if (g_TrajectoryUploaded != g_TrajectoryPath.size()) {
+		g_TrajectoryDraw.upload(g_TrajectoryPath);
+		g_TrajectoryUploaded = g_TrajectoryPath.size();
+	}
+
+	shaderProgram.setBool("useLighting", false);
+	shaderProgram.setVec4("primitiveColor", glm::vec4(0.2f, 1.0f, 1.0f, 1.0f));
+	glLineWidth(2.0f);
+	g_TrajectoryDraw.draw(GL_LINE_STRIP);
+	glLineWidth(1.0f);
+	glPointSize(4.0f);
+	g_TrajectoryDraw.draw(GL_POINTS);
+	glPointSize(1.0f);
+	glBindVertexArray(0);
+}
+
+void renderOverlayPrimitives(Shader& shaderProgram, const std::vector<Primitive>& primitives) {
+	profiler::Scope scope("renderPrimitives");
+	for (const auto& prim : primitives) {
+		if (prim.vertices.empty()) continue;
 
-		// --- Overlay mesh stays as-is (never selected) ---
 		if (prim.type == "overlaymesh") {
 			static GLuint overlayVAO = 0, overlayVBO = 0, overlayEBO = 0;
 			static size_t numIndices = 0;
@@ -858,9 +2068,11 @@ void renderPrimitives(Shader& shaderProgram, const std::vector<Primitive>& primi
 
 				glBindBuffer(GL_ARRAY_BUFFER, overlayVBO);
 				glBufferData(GL_ARRAY_BUFFER, prim.vertices.size() * sizeof(Vertex), prim.vertices.data(), GL_STATIC_DRAW);
+				profiler::countUpload(prim.vertices.size() * sizeof(Vertex));
 
 				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, overlayEBO);
 				glBufferData(GL_ELEMENT_ARRAY_BUFFER, prim.indices.size() * sizeof(unsigned int), prim.indices.data(), GL_STATIC_DRAW);
+				profiler::countUpload(prim.indices.size() * sizeof(unsigned int));
 
 				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
 				glEnableVertexAttribArray(0);
@@ -877,533 +2089,181 @@ void renderPrimitives(Shader& shaderProgram, const std::vector<Primitive>& primi
 			shaderProgram.setVec4("primitiveColor", glm::vec4(0.7f, 0.7f, 0.7f, 1.0f));
 			glBindVertexArray(overlayVAO);
 			glDrawElements(GL_TRIANGLES, (GLsizei)numIndices, GL_UNSIGNED_INT, 0);
+			profiler::countDraw();
 			glBindVertexArray(0);
-			continue;
 		}
+	}
+}
+
+void renderFramePrimitives(Shader& shaderProgram, const FrameStore::FramePtr& frame, int selectedIndex) {
+	profiler::Scope scope("renderPrimitives");
+	if (isPointCloud(*frame)) {
+		renderPointCloud(shaderProgram, frame, selectedIndex);
+		return;
+	}
+	g_FrameDraw.bind(frame);
+	g_FrameDraw.drawAll(shaderProgram, selectedIndex);
+	glBindVertexArray(0);
+}
 
-		// --- Non-overlay (points/lines/triangles) ---
+// Points through the LOD octree, everything else per primitive
+void renderPointCloud(Shader& shaderProgram, const FrameStore::FramePtr& frame, int selectedIndex) {
+	g_FrameDraw.bindWithoutPoints(frame);
+	g_FrameDraw.drawAll(shaderProgram, selectedIndex);
+	glBindVertexArray(0);
+
+	// Until the current frame's octree is built the previous one stays on screen
+	std::shared_ptr<const PointOctree> built;
+	if (g_OctreeTask.poll(built))
+		g_PointCloud.setOctree(std::move(built), g_OctreeTaskFrame);
+	if (g_PointCloud.frame() != currentFrameIndex && !g_OctreeTask.running()) {
+		g_OctreeTaskFrame = currentFrameIndex;
+		g_OctreeTask.start(ThreadPool::shared(), [frame] { return std::make_shared<const PointOctree>(*frame); });
+	}
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	PointOctree::View view;
+	view.viewProjection = camera.getProjectionMatrix(viewport[2] / (float)std::max(1, viewport[3]), camera.nearPlane, camera.farPlane)
+		* camera.getViewMatrix();
+	view.eye = camera.getPosition();
+	view.pixelsPerUnit = viewport[3] / (2.0f * std::tan(glm::radians(45.0f) * 0.5f));   // Camera's fovy
+	g_PointCloud.draw(shaderProgram, view, g_PointCloudPointSize);
+
+	// The selected point, which the octree draws like any other
+	if (selectedIndex >= 0 && selectedIndex < (int)frame->size() && frame->type(selectedIndex) == PrimType::Point) {
 		GLuint VAO = 0, VBO = 0;
 		glGenVertexArrays(1, &VAO);
 		glGenBuffers(1, &VBO);
-
-		std::vector<float> positions;
-		positions.reserve(prim.vertices.size() * 3);
-		for (const auto& v : prim.vertices) {
-			positions.push_back(v.position.x);
-			positions.push_back(v.position.y);
-			positions.push_back(v.position.z);
-		}
-
 		glBindVertexArray(VAO);
 		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
-
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3), frame->positions(selectedIndex), GL_STATIC_DRAW);
+		profiler::countUpload(sizeof(glm::vec3));
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
 		glEnableVertexAttribArray(0);
-
-		shaderProgram.setBool("useLighting", false);
-
-		// Compute draw color (boost/saturate when selected)
-		auto boosted = [&](const glm::vec4& c) -> glm::vec4 {
-			// mix toward yellowish for visibility, clamp to 1
-			glm::vec3 target(1.0f, 1.0f, 0.2f);
-			glm::vec3 rgb = glm::mix(glm::vec3(c), target, 0.5f);
-			return glm::vec4(glm::min(rgb * 1.1f, glm::vec3(1.0f)), 1.0f);
-			};
-		glm::vec4 drawColor = isSelected ? boosted(prim.color) : prim.color;
-		shaderProgram.setVec4("primitiveColor", drawColor);
-
-		if (prim.type == "drawtriangle") {
-			// filled
-			glDrawArrays(GL_TRIANGLES, 0, 3);
-
-			if (isSelected) {
-				// quick outline for clarity
-				glLineWidth(2.5f);
-				shaderProgram.setVec4("primitiveColor", glm::vec4(1.0f, 1.0f, 0.2f, 1.0f));
-				glDrawArrays(GL_LINE_LOOP, 0, 3);
-				glLineWidth(1.0f);
-			}
-		}
-		else if (prim.type == "drawline" || prim.type == "overlayline" || prim.type == "drawbox") {
-			if (isSelected) glLineWidth(3.0f);
-			glDrawArrays(GL_LINES, 0, (GLsizei)prim.vertices.size());
-			if (isSelected) glLineWidth(1.0f);
-		}
-		else if (prim.type == "drawpoint") {
-			if (isSelected) glPointSize(9.0f); else glPointSize(5.0f);
-			glDrawArrays(GL_POINTS, 0, (GLsizei)prim.vertices.size());
-			glPointSize(1.0f); // restore default
-		}
-
-		// Cleanup
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		shaderProgram.setVec4("primitiveColor", glm::vec4(1.0f, 1.0f, 0.2f, 1.0f));
+		glPointSize(9.0f);
+		glDrawArrays(GL_POINTS, 0, 1);
+		profiler::countDraw();
+		glPointSize(1.0f);
 		glBindVertexArray(0);
 		glDeleteBuffers(1, &VBO);
 		glDeleteVertexArrays(1, &VAO);
 	}
 }
 
+// Current frame colored by diff state, plus the primitives removed since the previous frame.
+// The colors are baked into vertex buffers once per diff result and hide setting.
+void renderFrameDiff(Shader& shaderProgram, const std::shared_ptr<const FrameDiffResult>& diff) {
+	profiler::Scope scope("renderPrimitives");
+	static std::shared_ptr<const FrameDiffResult> baked;   // held, so a new result never reuses its address
+	static uint64_t version = 0;
+	if (diff != baked) {
+		baked = diff;
+		++version;
+	}
+	const uint64_t key = version << 1 | (g_DiffHideUnchanged ? 1 : 0);
+
+	const auto frame = frames[currentFrameIndex];
+	g_AnalysisDraw.bindColored(frame, key, [&](uint32_t i, uint32_t& color) {
+		const DiffState state = diff->state[i];
+		color = packColor(kDiffColors[(int)state]);
+		return !(g_DiffHideUnchanged && state == DiffState::Unchanged);
+	});
+	g_AnalysisDraw.drawAll(shaderProgram, -1);
+
+	if (currentFrameIndex > 0 && !diff->removed.empty()) {
+		g_PreviousFrameDraw.bindColored(frames[currentFrameIndex - 1], key, [&](uint32_t i, uint32_t& color) {
+			color = packColor(kDiffColors[(int)DiffState::Removed]);
+			return std::binary_search(diff->removed.begin(), diff->removed.end(), i);
+		});
+		g_PreviousFrameDraw.drawAll(shaderProgram, -1);
+	}
 
-// Updated parseInputData to handle optional RGBA color bracket
-void parseInputData(const std::string& data) {
-	std::string::const_iterator it = data.begin();
-	Frame currentFrame;
-	bool inFrame = false;
-
-	auto parseOptionalColor = [&](glm::vec4& color, size_t index) {
-		// Skip whitespace
-		while (it != data.end() && std::isspace(*it)) ++it;
-
-		// If the next character is '[', parse RGBA
-		if (it != data.end() && *it == '[') {
-			++it; // skip '['
-			float rgba[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-			std::string numStr;
-			int index = 0;
-			while (it != data.end() && *it != ']') {
-				if ((std::isdigit(*it) || *it == '.' || *it == '-')) {
-					numStr += *it;
-				}
-				else if (*it == ',') {
-					if (!numStr.empty()) {
-						float val = std::stof(numStr);
-						rgba[index] = val;
-						numStr.clear();
-						++index;
-						if (index > 3) break; // in case too many
-					}
-				}
-				++it;
-			}
-			// Capture the last value (A)
-			if (!numStr.empty() && index < 4) {
-				float val = std::stof(numStr);
-				rgba[index] = val;
-				numStr.clear();
-			}
-			color = glm::vec4(rgba[0], rgba[1], rgba[2], rgba[3]);
-
-			if (it != data.end()) ++it; // skip ']'
-		}
-		else {
-			// No bracket found, use random color
-			ImVec4 stableColor = stableColorFromId(static_cast<uint32_t>(index));
-			color = glm::vec4(stableColor.x, stableColor.y, stableColor.z, 1.0f);
-		}
-		};
-
-	auto parseOptionalName = [&](const std::string& fallback) {
-		while (it != data.end() && std::isspace(*it)) ++it;
-
-		if (it != data.end() && *it == '"') {
-			++it;
-			std::string name;
-			while (it != data.end() && *it != '"') {
-				name += *it;
-				++it;
-			}
-			if (it != data.end()) ++it;
-			return name;
-		}
-
-		return fallback;
-		};
-
-	auto parseBracketedVertex = [&]() {
-		Vertex vert{};
-		vert.normal = glm::vec3(0.0f, 0.0f, 1.0f);
-
-		while (it != data.end() && *it != '[') ++it;
-		if (it == data.end()) return vert;
-		++it; // skip '['
-
-		std::string numStr;
-		int coordIndex = 0;
-		while (it != data.end() && *it != ']') {
-			if (std::isdigit(*it) || *it == '.' || *it == '-' || *it == '+' || *it == 'e' || *it == 'E') {
-				numStr += *it;
-			}
-			else if (*it == ',') {
-				if (!numStr.empty()) {
-					float val = std::stof(numStr);
-					if (coordIndex == 0) vert.position.x = val;
-					else if (coordIndex == 1) vert.position.y = val;
-					numStr.clear();
-					++coordIndex;
-				}
-			}
-			++it;
-		}
-		if (!numStr.empty()) {
-			float val = std::stof(numStr);
-			if (coordIndex == 0) vert.position.x = val;
-			else if (coordIndex == 1) vert.position.y = val;
-			else vert.position.z = val;
-			numStr.clear();
-		}
-		if (it != data.end()) ++it; // skip ']'
-
-		return vert;
-		};
-
-	auto addBoxEdge = [](std::vector<Vertex>& vertices, const glm::vec3& a, const glm::vec3& b) {
-		Vertex va{};
-		Vertex vb{};
-		va.position = a;
-		vb.position = b;
-		va.normal = vb.normal = glm::vec3(0.0f, 0.0f, 1.0f);
-		vertices.push_back(va);
-		vertices.push_back(vb);
-		};
-
-	while (it != data.end()) {
-		// Skip whitespace
-		while (it != data.end() && std::isspace(*it)) ++it;
-
-		// Check for framestart()
-		if (std::distance(it, data.end()) >= 11 && std::equal(it, it + 11, "framestart(")) {
-			inFrame = true;
-			currentFrame = Frame();
-			it += 11;
-		}
-		// Check for frameend()
-		else if (std::distance(it, data.end()) >= 9 && std::equal(it, it + 9, "frameend(")) {
-			if (inFrame) {
-				frames.push_back(currentFrame);
-				currentFrame = Frame();
-				inFrame = false;
-			}
-			it += 9;
-		}
-		// Check for drawtriangle
-		else if (std::distance(it, data.end()) >= 12 && std::equal(it, it + 12, "drawtriangle")) {
-			it += 12; // Move iterator past "drawtriangle"
-			Primitive prim;
-			prim.type = "drawtriangle";
-
-			// Skip whitespace
-			while (it != data.end() && std::isspace(*it)) ++it;
-
-			// Parse name (optional quotes)
-			if (it != data.end() && *it == '"') {
-				++it; // skip quote
-				std::string name;
-				while (it != data.end() && *it != '"') {
-					name += *it;
-					++it;
-				}
-				if (it != data.end()) ++it; // skip closing quote
-				prim.name = name;
-			}
-			else {
-				prim.name = "Unnamed Triangle";
-			}
-
-			// Parse 3 vertices
-			std::vector<Vertex> vertices;
-			for (int i = 0; i < 3; ++i) {
-				while (it != data.end() && *it != '[') ++it;
-				if (it == data.end()) break;
-				++it; // skip '['
-
-				Vertex vert{};
-				std::string numStr;
-				int coordIndex = 0;
-				while (it != data.end() && *it != ']') {
-					if (std::isdigit(*it) || *it == '.' || *it == '-') {
-						numStr += *it;
-					}
-					else if (*it == ',') {
-						if (!numStr.empty()) {
-							float val = std::stof(numStr);
-							if (coordIndex == 0) vert.position.x = val;
-							else if (coordIndex == 1) vert.position.y = val;
-							numStr.clear();
-							++coordIndex;
-						}
-					}
-					++it;
-				}
-				// last coordinate
-				if (!numStr.empty()) {
-					float val = std::stof(numStr);
-					vert.position.z = val;
-					numStr.clear();
-				}
-				vertices.push_back(vert);
-
-				if (it != data.end()) ++it; // skip ']'
-			}
-			prim.vertices = vertices;
-
-			// Parse optional color
-			parseOptionalColor(prim.color, currentFrame.primitives.size());
-
-			currentFrame.primitives.push_back(prim);
-		}
-		// Check for drawbox
-		else if (std::distance(it, data.end()) >= 7 && std::equal(it, it + 7, "drawbox")) {
-			it += 7;
-			Primitive prim;
-			prim.type = "drawbox";
-			prim.name = parseOptionalName("Unnamed Box");
-
-			Vertex cornerA = parseBracketedVertex();
-			Vertex cornerB = parseBracketedVertex();
-			glm::vec3 minCorner = glm::min(cornerA.position, cornerB.position);
-			glm::vec3 maxCorner = glm::max(cornerA.position, cornerB.position);
-			prim.displayCoords = formatVec3(minCorner) + formatVec3(maxCorner);
-
-			glm::vec3 p000(minCorner.x, minCorner.y, minCorner.z);
-			glm::vec3 p100(maxCorner.x, minCorner.y, minCorner.z);
-			glm::vec3 p110(maxCorner.x, maxCorner.y, minCorner.z);
-			glm::vec3 p010(minCorner.x, maxCorner.y, minCorner.z);
-			glm::vec3 p001(minCorner.x, minCorner.y, maxCorner.z);
-			glm::vec3 p101(maxCorner.x, minCorner.y, maxCorner.z);
-			glm::vec3 p111(maxCorner.x, maxCorner.y, maxCorner.z);
-			glm::vec3 p011(minCorner.x, maxCorner.y, maxCorner.z);
-
-			addBoxEdge(prim.vertices, p000, p100);
-			addBoxEdge(prim.vertices, p100, p110);
-			addBoxEdge(prim.vertices, p110, p010);
-			addBoxEdge(prim.vertices, p010, p000);
-			addBoxEdge(prim.vertices, p001, p101);
-			addBoxEdge(prim.vertices, p101, p111);
-			addBoxEdge(prim.vertices, p111, p011);
-			addBoxEdge(prim.vertices, p011, p001);
-			addBoxEdge(prim.vertices, p000, p001);
-			addBoxEdge(prim.vertices, p100, p101);
-			addBoxEdge(prim.vertices, p110, p111);
-			addBoxEdge(prim.vertices, p010, p011);
-
-			// Parse optional color
-			parseOptionalColor(prim.color, currentFrame.primitives.size());
-
-			currentFrame.primitives.push_back(prim);
-		}
-		// Check for drawline
-		else if (std::distance(it, data.end()) >= 8 && std::equal(it, it + 8, "drawline")) {
-			it += 8;
-			Primitive prim;
-			prim.type = "drawline";
-
-			// Skip whitespace
-			while (it != data.end() && std::isspace(*it)) ++it;
-
-			// Parse name
-			if (it != data.end() && *it == '"') {
-				++it;
-				std::string name;
-				while (it != data.end() && *it != '"') {
-					name += *it;
-					++it;
-				}
-				if (it != data.end()) ++it;
-				prim.name = name;
-			}
-			else {
-				prim.name = "Unnamed Line";
-			}
-
-			// Parse 2 vertices
-			std::vector<Vertex> vertices;
-			for (int i = 0; i < 2; ++i) {
-				while (it != data.end() && *it != '[') ++it;
-				if (it == data.end()) break;
-				++it; // skip '['
-
-				Vertex vert{};
-				std::string numStr;
-				int coordIndex = 0;
-				while (it != data.end() && *it != ']') {
-					if (std::isdigit(*it) || *it == '.' || *it == '-') {
-						numStr += *it;
-					}
-					else if (*it == ',') {
-						if (!numStr.empty()) {
-							float val = std::stof(numStr);
-							if (coordIndex == 0) vert.position.x = val;
-							else if (coordIndex == 1) vert.position.y = val;
-							numStr.clear();
-							++coordIndex;
-						}
-					}
-					++it;
-				}
-				// last coordinate
-				if (!numStr.empty()) {
-					float val = std::stof(numStr);
-					vert.position.z = val;
-					numStr.clear();
-				}
-				vertices.push_back(vert);
-
-				if (it != data.end()) ++it; // skip ']'
-			}
-			prim.vertices = vertices;
-
-			// Parse optional color
-			parseOptionalColor(prim.color, currentFrame.primitives.size());
-
-			currentFrame.primitives.push_back(prim);
-		}
-		// Check for drawpoint
-		else if (std::distance(it, data.end()) >= 9 && std::equal(it, it + 9, "drawpoint")) {
-			it += 9;
-			Primitive prim;
-			prim.type = "drawpoint";
-
-			// Skip whitespace
-			while (it != data.end() && std::isspace(*it)) ++it;
-
-			// Parse name
-			if (it != data.end() && *it == '"') {
-				++it;
-				std::string name;
-				while (it != data.end() && *it != '"') {
-					name += *it;
-					++it;
-				}
-				if (it != data.end()) ++it;
-				prim.name = name;
-			}
-			else {
-				prim.name = "Unnamed Point";
-			}
-
-			// Parse single vertex
-			while (it != data.end() && *it != '[') ++it;
-			if (it != data.end()) ++it; // skip '['
+	const int selected = g_SelectedPrimitive;
+	if (selected >= 0 && selected < (int)frame->size() && !(g_DiffHideUnchanged && diff->state[selected] == DiffState::Unchanged)) {
+		glDepthFunc(GL_LEQUAL);
+		g_FrameDraw.bind(frame);
+		g_FrameDraw.draw(shaderProgram, selected, kDiffColors[(int)diff->state[selected]], true);
+		glDepthFunc(GL_LESS);
+	}
+	glBindVertexArray(0);
+}
 
-			Vertex vtx{};
-			{
-				std::string numStr;
-				int coordIndex = 0;
-				while (it != data.end() && *it != ']') {
-					if (std::isdigit(*it) || *it == '.' || *it == '-') {
-						numStr += *it;
-					}
-					else if (*it == ',') {
-						if (!numStr.empty()) {
-							float val = std::stof(numStr);
-							if (coordIndex == 0) vtx.position.x = val;
-							else if (coordIndex == 1) vtx.position.y = val;
-							numStr.clear();
-							++coordIndex;
-						}
-					}
-					++it;
-				}
-				// last coordinate
-				if (!numStr.empty()) {
-					float val = std::stof(numStr);
-					vtx.position.z = val;
-					numStr.clear();
-				}
-			}
-			vtx.normal = glm::vec3(0.0f, 0.0f, 1.0f);
-			if (it != data.end()) ++it; // skip ']'
 
-			prim.vertices.push_back(vtx);
+// Loads a capture log from disk. Decompression runs on the CaptureStream
+// thread while the text already decoded is parsed here.
+bool loadCaptureFile(const std::string& path) {
+	CaptureStream stream;
+	std::string error;
+	if (!stream.open(path, error)) {
+		g_LoadStatus = error;
+		return false;
+	}
 
-			// Parse optional color
-			parseOptionalColor(prim.color, currentFrame.primitives.size());
+	const auto t0 = std::chrono::steady_clock::now();
+	releaseFrameIndices();
+	clearFrames();
+	parseCaptureStream(stream, frames);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	currentFrameIndex = 0;
+	rebuildFrameIndices();
+	setSelection(-1);
+	fitView = true;
+
+	std::ostringstream status;
+	status << frames.size() << " frames from " << compressionName(stream.compression()) << " file, "
+		<< stream.decodedBytes() / (1024 * 1024) << " MB in " << seconds << " s";
+	if (!stream.error().empty()) status << " (" << stream.error() << ")";
+	g_LoadStatus = status.str();
+	return stream.error().empty();
+}
 
-			currentFrame.primitives.push_back(prim);
-		}
-		// framestart / frameend or unknown text
-		else {
-			if (it != data.end()) ++it;
-		}
+// Loads a second capture for the right pane of the split view; the current one is kept.
+bool loadCompareFile(const std::string& path) {
+	CaptureStream stream;
+	std::string error;
+	if (!stream.open(path, error)) {
+		g_CompareStatus = error;
+		return false;
 	}
 
-	if (inFrame) {
-		// If there's an unclosed frame, push it at the end (optional)
-		frames.push_back(currentFrame);
-	}
+	closeCompareCapture();
+	g_CompareFrames.setPositionBits(g_PositionBits);
+	g_CompareFrames.setBlockIdBase(kCompareBlockIdBase);
+	g_CompareFrames.setBudget(size_t(g_FrameBudgetMB) << 20);
+	parseCaptureStream(stream, g_CompareFrames);
+	g_CompareOtherCapture = true;
+	g_CompareOffset = 0;
+
+	std::ostringstream status;
+	status << g_CompareFrames.size() << " compare frames from " << path;
+	if (!stream.error().empty()) status << " (" << stream.error() << ")";
+	g_CompareStatus = status.str();
+	return stream.error().empty();
 }
 
 // Fit data into view
 void fitDataIntoView() {
-	if (frames.empty() && overlayPrimitives.empty()) return;
-
-	glm::vec3 minBounds(FLT_MAX);
-	glm::vec3 maxBounds(-FLT_MAX);
-	bool anyVertex = false;
+	profiler::Scope scope("fitDataIntoView");
+	fitBounds(sceneBounds(frames, currentFrameIndex, fitAllFrames, allFramesBounds, overlayPrimitives),
+		camera.target, camera.distance);
+}
 
-	// Include current frame primitives
-	if (!frames.empty()) {
-		const Frame& frame = frames[currentFrameIndex];
-		for (const auto& prim : frame.primitives) {
-			for (const auto& vert : prim.vertices) {
-				glm::vec3 position = vert.position;
-				minBounds = glm::min(minBounds, position);
-				maxBounds = glm::max(maxBounds, position);
-				anyVertex = true;
-			}
-		}
+// Tighten near/far around the bounding sphere of the visible data
+void updateClipPlanes() {
+	AABB bounds = sceneBounds(frames, currentFrameIndex, false, allFramesBounds, overlayPrimitives);
+	if (g_SplitView)
+		if (const FrameStore* store = compareStore()) bounds.merge(store->bounds(compareFrameIndex(*store)));
+	if (g_ShowOnionSkin && frames.size() > 1) {
+		const int range = std::clamp(g_OnionFrames, 1, OnionSkin::kMaxFrames);
+		const int first = std::max(0, currentFrameIndex - range), last = std::min((int)frames.size() - 1, currentFrameIndex + range);
+		for (int f = first; f <= last; ++f) bounds.merge(frames.bounds(f));
 	}
-
-	// Include overlay primitives
-	for (const auto& prim : overlayPrimitives) {
-		if (prim.type == "overlaymesh") {
-			for (const auto& vertex : prim.vertices) {
-				glm::vec3 position = vertex.position;
-				minBounds = glm::min(minBounds, position);
-				maxBounds = glm::max(maxBounds, position);
-				anyVertex = true;
-			}
-		}
-		else {
-			for (const auto& vert : prim.vertices) {
-				glm::vec3 position(vert.position.x, vert.position.y, vert.position.z);
-				minBounds = glm::min(minBounds, position);
-				maxBounds = glm::max(maxBounds, position);
-				anyVertex = true;
-			}
-		}
+	if (g_ShowTrajectory && g_TrackedIdentity.valid) {
+		updateTrajectory();
+		bounds.merge(g_TrajectoryBounds);
 	}
-
-	if (!anyVertex) return;
-	glm::vec3 center = (minBounds + maxBounds) / 2.0f;
-	float radius = glm::length(maxBounds - minBounds) / 2.0f;
-	radius = std::max(radius, 1.0f);
-
-	// Update camera target and distance
-	camera.target = center;
-	camera.distance = radius * 2.0f;
-
-	// Calculate distances from camera position to the near and far points of the bounding sphere
-	float nearPlane = 0.1f;
-	float farPlane = camera.distance + radius * 1.5f;
-
-	nearPlane = std::max(nearPlane, 0.1f);
-
-	//camera.nearPlane = nearPlane;
-	//camera.farPlane = farPlane;
-}
-
-// Möller-Trumbore
-bool rayTriangleIntersect(const glm::vec3& orig, const glm::vec3& dir,
-	const glm::vec3& v0, const glm::vec3& v1,
-	const glm::vec3& v2, float& tOut)
-{
-	const float EPS = 1e-6f;
-	glm::vec3 e1 = v1 - v0;
-	glm::vec3 e2 = v2 - v0;
-	glm::vec3 p = glm::cross(dir, e2);
-	float det = glm::dot(e1, p);
-	if (fabs(det) < EPS) return false;
-	float invDet = 1.0f / det;
-	glm::vec3 t = orig - v0;
-	float u = glm::dot(t, p) * invDet;
-	if (u < 0.f || u > 1.f) return false;
-	glm::vec3 q = glm::cross(t, e1);
-	float v = glm::dot(dir, q) * invDet;
-	if (v < 0.f || u + v > 1.f) return false;
-	float tHit = glm::dot(e2, q) * invDet;
-	if (tHit < EPS) return false;
-	tOut = tHit;
-	return true;
+	clipPlanesFor(bounds, camera.getPosition(), camera.nearPlane, camera.farPlane);
 }
@@ -0,0 +1,205 @@
+// CoreTests.cpp
+// Checks of the GL-free core, run by ctest: frame encoding round trips,
+// persistent layers and capture streams cut across chunks. Prints each
+// failed check and exits non-zero if any failed: scenedebugger_tests
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SceneParser.h"
+#include "FrameCodec.h"
+#include "FrameStore.h"
+#include "CaptureLoader.h"
+
+namespace {
+
+int g_Failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			++g_Failures; \
+		} \
+	} while (0)
+
+std::mt19937 rng(12345);
+float uniform(float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); }
+
+// Every primitive type with awkward coordinates (negative, tiny, large)
+Frame randomFrame(size_t count) {
+	Frame frame;
+	for (size_t i = 0; i < count; ++i) {
+		const PrimType type = PrimType(i % (size_t)PrimType::Count);
+		glm::vec3 p[3];
+		for (glm::vec3& v : p) v = glm::vec3(uniform(-1000, 1000), uniform(-1e-3f, 1e-3f), uniform(0, 5e4f));
+		const uint32_t name = Frame::names().intern("p" + std::to_string(i % 37));
+		frame.add(type, name, p, glm::vec4(uniform(0, 1), uniform(0, 1), uniform(0, 1), 1.0f));
+	}
+	frame.computeBounds();
+	return frame;
+}
+
+bool sameTopology(const Frame& a, const Frame& b) {
+	if (a.size() != b.size()) return false;
+	for (size_t i = 0; i < a.size(); ++i)
+		if (a.type(i) != b.type(i) || a.nameId(i) != b.nameId(i) ||
+			a.byType[(int)a.type(i)].colors[a.slot(i)] != b.byType[(int)b.type(i)].colors[b.slot(i)]) return false;
+	return true;
+}
+
+bool sameBits(const Frame& a, const Frame& b) {
+	if (!sameTopology(a, b)) return false;
+	for (size_t i = 0; i < a.size(); ++i)
+		if (std::memcmp(a.positions(i), b.positions(i), a.vertexCount(i) * sizeof(glm::vec3)) != 0) return false;
+	return true;
+}
+
+// Largest error of b's positions against a's, in steps of `bits` quantization over a's bounds
+float errorInSteps(const Frame& a, const Frame& b, int bits) {
+	const glm::vec3 step = framecodec::quantumOf(a.bounds, bits);
+	// Decoding computes min + q * step in floats, which adds a few ulps of the bounds' magnitude
+	const glm::vec3 slack = 4.0f * FLT_EPSILON * glm::max(glm::abs(a.bounds.min), glm::abs(a.bounds.max));
+	float worst = 0.0f;
+	for (size_t i = 0; i < a.size(); ++i) {
+		for (uint32_t k = 0; k < a.vertexCount(i); ++k) {
+			const glm::vec3 d = glm::abs(a.positions(i)[k] - b.positions(i)[k]);
+			for (int c = 0; c < 3; ++c)
+				if (step[c] > 0.0f) worst = std::max(worst, std::max(0.0f, d[c] - slack[c]) / step[c]);
+		}
+	}
+	return worst;
+}
+
+void testCodecRoundTrip() {
+	const Frame frame = randomFrame(5000);
+	std::vector<uint8_t> encoded, scratch;
+	Frame decoded;
+
+	framecodec::encode(frame, framecodec::kLosslessBits, encoded, scratch);
+	CHECK(framecodec::decode(encoded.data(), encoded.size(), decoded, scratch));
+	CHECK(sameBits(frame, decoded));
+
+	for (int bits : { 8, 12, 16, 24 }) {
+		framecodec::encode(frame, bits, encoded, scratch);
+		CHECK(framecodec::decode(encoded.data(), encoded.size(), decoded, scratch));
+		CHECK(sameTopology(frame, decoded));
+		CHECK(errorInSteps(frame, decoded, bits) <= 0.5f);
+	}
+
+	// A corrupt blob is rejected, not misread
+	framecodec::encode(frame, framecodec::kLosslessBits, encoded, scratch);
+	encoded.resize(encoded.size() / 2);
+	CHECK(!framecodec::decode(encoded.data(), encoded.size(), decoded, scratch));
+
+	// Through a store: frames come back assembled from their blocks
+	FrameStore lossless, quantized;
+	quantized.setPositionBits(16);
+	lossless.append(frame);
+	quantized.append(frame);
+	CHECK(sameBits(frame, *lossless.get(0)));
+	CHECK(sameTopology(frame, *quantized.get(0)));
+	CHECK(errorInSteps(frame, *quantized.get(0), 16) <= 0.5f);
+}
+
+// Names of frame f's primitives, in order
+std::vector<std::string> namesOf(const FrameStore& frames, size_t f) {
+	std::vector<std::string> names;
+	const auto frame = frames.get(f);
+	for (size_t i = 0; i < frame->size(); ++i) names.push_back(frame->name(i));
+	return names;
+}
+
+void testPersistentLayers() {
+	const std::string log =
+		"persist drawbox \"ground\" [0,0,0][10,10,1]\n"
+		"persist drawpoint \"marker\" [5,5,5]\n"
+		"framestart()\n"
+		"drawpoint \"a\" [1,2,3]\n"
+		"frameend()\n"
+		"framestart()\n"
+		"drawline \"b\" [0,0,0][1,1,1]\n"
+		"frameend()\n"
+		"remove \"ground\"\n"
+		"framestart()\n"
+		"drawpoint \"c\" [2,2,2]\n"
+		"frameend()\n"
+		"persist drawpoint \"marker\" [6,6,6]\n"
+		"framestart()\n"
+		"frameend()\n"
+		"remove \"marker\"\n"
+		"framestart()\n"
+		"drawpoint \"d\" [3,3,3]\n"
+		"frameend()\n";
+	FrameStore frames;
+	parseInputData(log, frames);
+	CHECK(frames.size() == 5);
+	if (frames.size() != 5) return;
+
+	using Names = std::vector<std::string>;
+	CHECK(namesOf(frames, 0) == (Names{ "ground", "marker", "a" }));
+	CHECK(namesOf(frames, 1) == (Names{ "ground", "marker", "b" }));
+	CHECK(namesOf(frames, 2) == (Names{ "marker", "c" }));
+	CHECK(namesOf(frames, 3) == (Names{ "marker", "marker" }));
+	CHECK(namesOf(frames, 4) == (Names{ "d" }));
+
+	CHECK(frames.get(0)->type(0) == PrimType::Box);
+	CHECK(frames.get(1)->type(2) == PrimType::Line);
+	CHECK(frames.get(3)->positions(1)[0] == glm::vec3(6.0f));
+	CHECK(frames.bounds(0).max == glm::vec3(10.0f, 10.0f, 5.0f));
+	CHECK(frames.bounds(4).min == glm::vec3(3.0f) && frames.bounds(4).max == glm::vec3(3.0f));
+	for (size_t f = 0; f < frames.size(); ++f) CHECK(frames.primitiveCount(f) == frames.get(f)->size());
+}
+
+// A capture whose first frameend( straddles the first chunk boundary, cut `split` bytes into the marker
+void testChunkBoundary(size_t split) {
+	std::string log = "framestart()\ndrawpoint \"a\" [1,2,3]\n";
+	const std::string filler(99, 'x');
+	while (log.size() + filler.size() + 1 < CaptureStream::kChunkSize - split) log += filler + "\n";
+	log.append(CaptureStream::kChunkSize - split - log.size() - 1, 'x');
+	log += "\n";
+	CHECK(log.size() + split == CaptureStream::kChunkSize);
+	log += "frameend()\nframestart()\ndrawline \"b\" [0,0,0][1,1,1]\nframeend()\n";
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "scenedebugger_tests_capture.txt";
+	{
+		std::ofstream out(path, std::ios::binary);
+		out << log;
+	}
+	CaptureStream stream;
+	std::string error;
+	CHECK(stream.open(path.string(), error));
+	FrameStore streamed, whole;
+	CHECK(parseCaptureStream(stream, streamed));
+	stream.close();
+	std::filesystem::remove(path);
+	parseInputData(log, whole);
+
+	CHECK(streamed.size() == 2 && whole.size() == 2);
+	if (streamed.size() != 2 || whole.size() != 2) return;
+	for (size_t f = 0; f < 2; ++f) CHECK(sameBits(*streamed.get(f), *whole.get(f)));
+	CHECK(namesOf(streamed, 0) == std::vector<std::string>{ "a" });
+	CHECK(namesOf(streamed, 1) == std::vector<std::string>{ "b" });
+}
+
+} // namespace
+
+int main() {
+	testCodecRoundTrip();
+	testPersistentLayers();
+	for (size_t split = 1; split < 9; ++split) testChunkBoundary(split);
+
+	if (g_Failures) {
+		std::printf("%d checks failed\n", g_Failures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,120 @@
+// SceneGen.cpp
+// Writes a synthetic capture (see SceneGenerator.h) to a file or stdout.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "SceneGenerator.h"
+
+static void usage() {
+	std::fprintf(stderr,
+		"usage: scenedebugger_gen [options] [-o file]\n"
+		"  --seed N           random seed (1)\n"
+		"  --frames N         frame count (100)\n"
+		"  --prims N          primitives per frame (1000)\n"
+		"  --mix T,L,P,B      type weights: triangle,line,point,box (1,1,1,1)\n"
+		"  --dist NAME        uniform | clustered | moving (uniform)\n"
+		"  --extent X         scene half size (100)\n"
+		"  --size X           primitive size (1)\n"
+		"  --clusters N       cluster count for --dist clustered (8)\n"
+		"  --names N          distinct primitive names (1000)\n"
+		"  --color F          share of primitives with a color, 0..1 (0.5)\n"
+		"  --noise N          non-command log lines per frame (0)\n"
+		"  --decimals N       coordinate decimals, 0..6 (3)\n"
+		"  --bytes N[K|M|G]   stop after about this much output\n"
+		"  -o FILE            output file, '-' for stdout (default)\n");
+}
+
+static uint64_t parseSize(const char* s) {
+	char* end = nullptr;
+	double v = std::strtod(s, &end);
+	switch (end ? *end : 0) {
+	case 'k': case 'K': v *= 1024.0; break;
+	case 'm': case 'M': v *= 1024.0 * 1024.0; break;
+	case 'g': case 'G': v *= 1024.0 * 1024.0 * 1024.0; break;
+	default: break;
+	}
+	return (uint64_t)v;
+}
+
+int main(int argc, char** argv) {
+	scenegen::Options opt;
+	std::string path = "-";
+	uint64_t maxBytes = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		auto value = [&] { return argv[++i]; };
+		if (!std::strcmp(arg, "--help") || !std::strcmp(arg, "-h")) {
+			usage();
+			return 0;
+		}
+		if (!hasValue) {
+			usage();
+			return 1;
+		}
+		if (!std::strcmp(arg, "--seed")) opt.seed = std::strtoull(value(), nullptr, 10);
+		else if (!std::strcmp(arg, "--frames")) opt.frames = std::strtoull(value(), nullptr, 10);
+		else if (!std::strcmp(arg, "--prims")) opt.primitivesPerFrame = (uint32_t)std::strtoul(value(), nullptr, 10);
+		else if (!std::strcmp(arg, "--mix")) {
+			if (std::sscanf(value(), "%f,%f,%f,%f", &opt.typeMix[0], &opt.typeMix[1], &opt.typeMix[2], &opt.typeMix[3]) != 4) {
+				std::fprintf(stderr, "--mix needs four comma separated weights\n");
+				return 1;
+			}
+		}
+		else if (!std::strcmp(arg, "--dist")) {
+			const char* d = value();
+			if (!std::strcmp(d, "uniform")) opt.distribution = scenegen::Distribution::Uniform;
+			else if (!std::strcmp(d, "clustered")) opt.distribution = scenegen::Distribution::Clustered;
+			else if (!std::strcmp(d, "moving")) opt.distribution = scenegen::Distribution::Moving;
+			else {
+				std::fprintf(stderr, "unknown distribution '%s'\n", d);
+				return 1;
+			}
+		}
+		else if (!std::strcmp(arg, "--extent")) opt.extent = std::strtof(value(), nullptr);
+		else if (!std::strcmp(arg, "--size")) opt.primitiveSize = std::strtof(value(), nullptr);
+		else if (!std::strcmp(arg, "--clusters")) opt.clusters = (uint32_t)std::strtoul(value(), nullptr, 10);
+		else if (!std::strcmp(arg, "--names")) opt.names = (uint32_t)std::strtoul(value(), nullptr, 10);
+		else if (!std::strcmp(arg, "--color")) opt.colorFraction = std::strtof(value(), nullptr);
+		else if (!std::strcmp(arg, "--noise")) opt.noiseLines = (uint32_t)std::strtoul(value(), nullptr, 10);
+		else if (!std::strcmp(arg, "--decimals")) opt.decimals = std::atoi(value());
+		else if (!std::strcmp(arg, "--bytes")) maxBytes = parseSize(value());
+		else if (!std::strcmp(arg, "-o")) path = value();
+		else {
+			std::fprintf(stderr, "unknown option '%s'\n", arg);
+			usage();
+			return 1;
+		}
+	}
+
+	std::FILE* out = path == "-" ? stdout : std::fopen(path.c_str(), "wb");
+	if (!out) {
+		std::fprintf(stderr, "cannot open %s\n", path.c_str());
+		return 1;
+	}
+
+	const auto t0 = std::chrono::steady_clock::now();
+	uint64_t written = 0;
+	bool ok = true;
+	scenegen::Generator gen(opt);
+	gen.run(0, opt.frames, [&](const std::string& text) {
+		if (std::fwrite(text.data(), 1, text.size(), out) != text.size()) {
+			ok = false;
+			return false;
+		}
+		written += text.size();
+		return maxBytes == 0 || written < maxBytes;
+	});
+	if (out != stdout) ok = std::fclose(out) == 0 && ok;
+	else ok = std::fflush(out) == 0 && ok;
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	std::fprintf(stderr, "%s: %.1f MB in %.2f s (%.0f MB/s), %s, seed %llu\n", ok ? "done" : "write failed",
+		written / 1048576.0, seconds, written / 1048576.0 / seconds, scenegen::distributionName(opt.distribution),
+		(unsigned long long)opt.seed);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,371 @@
+// SceneQuery.cpp
+// Answers questions about captures without the GUI: filters and aggregates
+// primitives (see PrimitiveQuery.h) and prints CSV or JSON.
+//
+//   scenedebugger_query big.txt.gz --where 'type == box && name == "X" && contains(1,2,3)' --first
+//   scenedebugger_query big.txt --select 'count, max(size)'
+//   scenedebugger_query big.txt --where degenerate --matching
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "SceneParser.h"
+#include "PrimitiveQuery.h"
+#include "ThreadPool.h"
+
+static void usage() {
+	std::fprintf(stderr,
+		"usage: scenedebugger_query [options] capture...\n"
+		"  --where EXPR       primitive filter (all primitives)\n"
+		"  --select LIST      count, sum(e), min(e), max(e), avg(e), comma separated (count)\n"
+		"  --group KEY        frame | name | type | none (frame)\n"
+		"  --matching         only frames with a matching primitive (--group frame)\n"
+		"  --first            only the first frame with a matching primitive, then stop\n"
+		"  --json             JSON instead of CSV\n"
+		"  --batch N[K|M|G]   text parsed per batch (64M)\n"
+		"fields: type name frame index vertices x y z minx miny minz maxx maxy maxz\n"
+		"        size area length r g b a degenerate\n"
+		"types:  triangle line point box\n"
+		"ops:    || && ! == != < <= > >= ~ (glob) + - * /   also: and or not\n"
+		"funcs:  contains(x,y,z[,eps]) overlaps(x0,y0,z0,x1,y1,z1) dist(x,y,z)\n"
+		"        abs(e) sqrt(e) min(a,b) max(a,b)\n");
+}
+
+static uint64_t parseSize(const char* s) {
+	char* end = nullptr;
+	double v = std::strtod(s, &end);
+	switch (end ? *end : 0) {
+	case 'k': case 'K': v *= 1024.0; break;
+	case 'm': case 'M': v *= 1024.0 * 1024.0; break;
+	case 'g': case 'G': v *= 1024.0 * 1024.0 * 1024.0; break;
+	default: break;
+	}
+	return (uint64_t)v;
+}
+
+namespace {
+
+using query::Query;
+using Row = Query::Row;
+
+// CSV or JSON rows, written as they are produced
+class Output {
+public:
+	Output(const Query& q, bool json, bool withCapture) : q(q), json(json), withCapture(withCapture) {
+		static const char* keys[] = { "frame", "name", "type", nullptr };
+		key = keys[(int)q.grouping()];
+		if (json) {
+			std::printf("[");
+			return;
+		}
+		std::vector<std::string> header;
+		if (withCapture) header.push_back("capture");
+		if (key) header.push_back(key);
+		for (const auto& a : q.columns()) header.push_back(a.label);
+		for (size_t k = 0; k < header.size(); ++k) std::printf("%s%s", k ? "," : "", csv(header[k]).c_str());
+		std::printf("\n");
+	}
+
+	void row(const std::string& capture, const Row& r) {
+		std::string keyText;
+		if (q.grouping() == query::Group::Frame) keyText = std::to_string(r.key);
+		else if (q.grouping() == query::Group::Name) keyText = Frame::names().name((uint32_t)r.key);
+		else if (q.grouping() == query::Group::Type) keyText = primTypeName(PrimType(r.key)) + 4;
+
+		const bool keyIsNumber = q.grouping() == query::Group::Frame;
+		if (json) {
+			std::printf("%s\n{", rows++ ? "," : "");
+			const char* sep = "";
+			if (withCapture) {
+				std::printf("\"capture\":\"%s\"", escaped(capture).c_str());
+				sep = ",";
+			}
+			if (key) {
+				std::printf(keyIsNumber ? "%s\"%s\":%s" : "%s\"%s\":\"%s\"", sep, key, escaped(keyText).c_str());
+				sep = ",";
+			}
+			for (size_t k = 0; k < r.values.size(); ++k) {
+				std::printf("%s\"%s\":%s", sep, escaped(q.columns()[k].label).c_str(), number(r, k).c_str());
+				sep = ",";
+			}
+			std::printf("}");
+			return;
+		}
+		const char* sep = "";
+		if (withCapture) {
+			std::printf("%s", csv(capture).c_str());
+			sep = ",";
+		}
+		if (key) {
+			std::printf("%s%s", sep, csv(keyText).c_str());
+			sep = ",";
+		}
+		for (size_t k = 0; k < r.values.size(); ++k) {
+			const std::string v = number(r, k);
+			std::printf("%s%s", sep, v == "null" ? "" : v.c_str());
+			sep = ",";
+		}
+		std::printf("\n");
+	}
+
+	void finish() {
+		if (json) std::printf("%s]\n", rows ? "\n" : "");
+		std::fflush(stdout);
+	}
+
+private:
+	std::string number(const Row& r, size_t k) const {
+		double v;
+		if (!r.values[k].value(q.columns()[k].kind, v) || !std::isfinite(v)) return "null";
+		char buf[32];
+		std::snprintf(buf, sizeof(buf), "%.9g", v);
+		return buf;
+	}
+
+	static std::string csv(const std::string& s) {
+		if (s.find_first_of(",\"\n") == std::string::npos) return s;
+		std::string out = "\"";
+		for (char c : s) out += c == '"' ? std::string("\"\"") : std::string(1, c);
+		return out + "\"";
+	}
+
+	static std::string escaped(const std::string& s) {
+		std::string out;
+		for (char c : s) {
+			if (c == '"' || c == '\\') out += '\\';
+			if ((unsigned char)c >= 0x20) out += c;
+		}
+		return out;
+	}
+
+	const Query& q;
+	bool json, withCapture;
+	const char* key = nullptr;
+	size_t rows = 0;
+};
+
+// Streams one capture in batches of whole frames, so memory stays at about
+// one batch of text plus its frames whatever the capture size. A batch is
+// cut into one part per worker at frameend() markers; parts are parsed in
+// parallel, then all frames of the batch are evaluated in parallel. Batches with persist/remove commands depend on
+// the retained set and are parsed on one thread.
+class CaptureScanner {
+public:
+	CaptureScanner(const Query& q, size_t batchBytes) : q(q), batchBytes(std::max<size_t>(batchBytes, 1 << 16)) {}
+
+	// sink(rows) receives the rows of each frame in order and returns false to stop.
+	template <class Sink>
+	bool scan(CaptureStream& stream, Sink&& sink) {
+		ParseState state;
+		std::string pending, chunk;
+		bool more = true;
+		while (more) {
+			more = stream.next(chunk);
+			if (more) {
+				pending += chunk;
+				if (pending.size() < batchBytes) continue;
+			}
+			size_t cut = more ? pending.rfind("frameend(") : pending.size();
+			if (cut == std::string::npos) continue;   // a frame larger than the batch: keep reading
+			if (more) cut += 9;
+			if (!batch(std::string_view(pending).substr(0, cut), state, !more, sink)) {
+				stream.close();
+				return true;
+			}
+			pending.erase(0, cut);
+		}
+		return stream.error().empty();
+	}
+
+	uint64_t framesScanned() const { return frameCount; }
+
+private:
+	template <class Sink>
+	bool batch(std::string_view text, ParseState& state, bool last, Sink& sink) {
+		ThreadPool& pool = ThreadPool::shared();
+		const bool sequential = state.inFrame || text.find("persist") != std::string_view::npos ||
+			text.find("remove") != std::string_view::npos;
+
+		// Part boundaries just after a frameend( marker
+		std::vector<std::string_view> parts;
+		const size_t lanes = sequential ? 1 : std::max<size_t>(1, pool.size());
+		size_t begin = 0;
+		for (size_t p = 1; p < lanes && begin < text.size(); ++p) {
+			size_t cut = text.find("frameend(", std::max(begin, text.size() * p / lanes));
+			if (cut == std::string_view::npos) break;
+			cut += 9;
+			parts.push_back(text.substr(begin, cut - begin));
+			begin = cut;
+		}
+		parts.push_back(text.substr(begin));
+
+		// Frames are kept as parsed (retained set first), without the FrameStore's
+		// quantization; each part starts from the retained set in force, which
+		// does not change within a parallel batch.
+		partFrames.resize(parts.size());
+		auto parsePart = [&](size_t p, ParseState& partState) {
+			std::vector<Frame>& out = partFrames[p];
+			out.clear();
+			parseInputData(parts[p], partState, [&](const Frame& retained, bool, const Frame& frame) {
+				out.emplace_back();
+				if (!retained.empty()) out.back().append(retained);
+				out.back().append(frame);
+			}, last && p + 1 == parts.size());
+		};
+		if (sequential) {
+			parsePart(0, state);
+		}
+		else {
+			pool.parallelFor(parts.size(), 1, [&](size_t b, size_t e) {
+				for (size_t p = b; p < e; ++p) {
+					ParseState partState;
+					partState.retained = state.retained;
+					parsePart(p, partState);
+				}
+			});
+		}
+
+		// Global frame numbers, then evaluation of every frame in the batch
+		std::vector<const Frame*> index;
+		for (const auto& frames : partFrames)
+			for (const Frame& frame : frames) index.push_back(&frame);
+		results.resize(index.size());
+		pool.parallelFor(index.size(), 4, [&](size_t b, size_t e) {
+			for (size_t k = b; k < e; ++k) {
+				results[k].clear();
+				q.evaluate(*index[k], frameCount + k, results[k]);
+			}
+		});
+
+		bool go = true;
+		for (size_t k = 0; k < index.size() && go; ++k) go = sink(results[k]);
+		frameCount += index.size();
+		return go;
+	}
+
+	const Query& q;
+	size_t batchBytes;
+	uint64_t frameCount = 0;
+	std::vector<std::vector<Frame>> partFrames;
+	std::vector<std::vector<Row>> results;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::vector<std::string> captures;
+	std::string where, select = "count";
+	query::Group group = query::Group::Frame;
+	bool json = false, matching = false, firstOnly = false;
+	size_t batchBytes = size_t(64) << 20;
+
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		auto value = [&] { return argv[++i]; };
+		if (!std::strcmp(arg, "--help") || !std::strcmp(arg, "-h")) {
+			usage();
+			return 0;
+		}
+		if (!std::strcmp(arg, "--json")) json = true;
+		else if (!std::strcmp(arg, "--matching")) matching = true;
+		else if (!std::strcmp(arg, "--first")) firstOnly = matching = true;
+		else if (arg[0] != '-') captures.push_back(arg);
+		else if (!hasValue) {
+			usage();
+			return 1;
+		}
+		else if (!std::strcmp(arg, "--where")) where = value();
+		else if (!std::strcmp(arg, "--select")) select = value();
+		else if (!std::strcmp(arg, "--batch")) batchBytes = (size_t)parseSize(value());
+		else if (!std::strcmp(arg, "--group")) {
+			const char* g = value();
+			if (!std::strcmp(g, "frame")) group = query::Group::Frame;
+			else if (!std::strcmp(g, "name")) group = query::Group::Name;
+			else if (!std::strcmp(g, "type")) group = query::Group::Type;
+			else if (!std::strcmp(g, "none")) group = query::Group::None;
+			else {
+				std::fprintf(stderr, "unknown group '%s'\n", g);
+				return 1;
+			}
+		}
+		else {
+			std::fprintf(stderr, "unknown option '%s'\n", arg);
+			usage();
+			return 1;
+		}
+	}
+	if (captures.empty()) {
+		usage();
+		return 1;
+	}
+	if ((matching || firstOnly) && group != query::Group::Frame) {
+		std::fprintf(stderr, "--matching and --first need --group frame\n");
+		return 1;
+	}
+
+	Query q;
+	std::string error;
+	if (!q.compile(where, select, group, error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	Output out(q, json, captures.size() > 1);
+	bool ok = true, found = false;
+	for (const std::string& path : captures) {
+		CaptureStream stream;
+		if (!stream.open(path, error)) {
+			std::fprintf(stderr, "%s\n", error.c_str());
+			ok = false;
+			continue;
+		}
+		const auto t0 = std::chrono::steady_clock::now();
+		CaptureScanner scanner(q, batchBytes);
+		std::map<uint64_t, Row> merged;   // --group name/type/none
+		ok = scanner.scan(stream, [&](const std::vector<Row>& rows) {
+			for (const Row& r : rows) {
+				if (group != query::Group::Frame) {
+					auto it = merged.find(r.key);
+					if (it == merged.end()) merged.emplace(r.key, r);
+					else it->second.merge(r);
+					continue;
+				}
+				if (matching && r.matches == 0) continue;
+				out.row(path, r);
+				found = true;
+				if (firstOnly) return false;
+			}
+			return true;
+		}) && ok;
+		if (!stream.error().empty()) std::fprintf(stderr, "%s: %s\n", path.c_str(), stream.error().c_str());
+
+		// Names sort by text: their ids depend on the order parts were parsed in
+		std::vector<const Row*> rows;
+		for (const auto& kv : merged) rows.push_back(&kv.second);
+		if (group == query::Group::Name)
+			std::sort(rows.begin(), rows.end(), [](const Row* a, const Row* b) {
+				return Frame::names().name((uint32_t)a->key) < Frame::names().name((uint32_t)b->key);
+			});
+		if (group == query::Group::None && rows.empty()) {
+			merged.emplace(0, q.emptyRow(0));
+			rows.push_back(&merged.begin()->second);
+		}
+		for (const Row* r : rows) out.row(path, *r);
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		std::fprintf(stderr, "%s: %llu frames, %.1f MB in %.2f s (%.0f MB/s)\n", path.c_str(),
+			(unsigned long long)scanner.framesScanned(), stream.decodedBytes() / 1048576.0, seconds,
+			stream.decodedBytes() / 1048576.0 / seconds);
+		if (firstOnly && found) break;
+	}
+	out.finish();
+	return ok ? 0 : 1;
+}
@@ -1,6 +1,7 @@
 #version 330 core
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec4 aColor;     // per-vertex color (point clouds)
 
 uniform mat4 projection;
 uniform mat4 view;
@@ -8,10 +9,12 @@ uniform mat4 model;
 
 out vec3 FragPos;
 out vec3 Normal;
+out vec4 VertexColor;
 
 void main() {
 	FragPos = vec3(model * vec4(aPos, 1.0));
 	Normal = mat3(transpose(inverse(model))) * aNormal;
+	VertexColor = aColor;
 
 	gl_Position = projection * view * vec4(FragPos, 1.0);
 }